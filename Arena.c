@@ -0,0 +1,47 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  A bump allocator. An arena takes one block from the system up front and hands out pieces of it
+    by moving a pointer, so allocating is a few instructions, everything in it is released at once in O(1)
+    and the game loop never has to call into the system allocator.
+***************************************************************************************/
+
+#include <stdlib.h>
+
+#include "Errors.h"
+#include "Arena.h"
+#include "Platform.h"
+
+Errors CreateArena(Arena_t* arena, size_t size)
+{
+    arena->used = 0;
+    arena->size = size;
+    arena->memory = (char*)AllocateAligned(CACHE_LINE_SIZE, size);
+
+    return arena->memory ? ERR_OK : ERR_ALLOCATION_FAILED;
+}
+
+void* ArenaAllocate(Arena_t* arena, size_t size, size_t alignment)
+{
+    size_t start = (arena->used + alignment - 1) & ~(alignment - 1);
+
+    if (start + size > arena->size)
+    {
+        return NULL;
+    }
+    arena->used = start + size;
+
+    return arena->memory + start;
+}
+
+void ResetArena(Arena_t* arena)
+{
+    arena->used = 0;
+}
+
+void DestroyArena(Arena_t* arena)
+{
+    FreeAligned(arena->memory);
+    arena->memory = NULL;
+    arena->size = arena->used = 0;
+}
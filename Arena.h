@@ -0,0 +1,53 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  A bump allocator. An arena takes one block from the system up front and hands out pieces of it
+    by moving a pointer, so allocating is a few instructions, everything in it is released at once in O(1)
+    and the game loop never has to call into the system allocator.
+***************************************************************************************/
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+
+typedef struct Arena
+{
+    char* memory;
+    size_t size;
+    size_t used;
+} Arena_t;
+
+
+/**
+ * @brief Takes the block of an arena from the system, aligned on a cache line.
+ *
+ * @param arena: the arena to create.
+ * @param size: the number of bytes the arena can hand out.
+ *
+ * @return ERR_OK on success, ERR_ALLOCATION_FAILED if the block could not be allocated.
+ */
+Errors CreateArena(Arena_t* arena, size_t size);
+
+/**
+ * @brief Hands out a piece of the arena.
+ *
+ * @param arena: the arena.
+ * @param size: the number of bytes.
+ * @param alignment: a power of two the piece must start on, at most a cache line.
+ *
+ * @return the piece, or NULL if the arena is full.
+ */
+void* ArenaAllocate(Arena_t* arena, size_t size, size_t alignment);
+
+/**
+ * @brief Takes back every piece of the arena at once, the block itself is kept for reuse.
+ */
+void ResetArena(Arena_t* arena);
+
+/**
+ * @brief Returns the block of an arena to the system.
+ */
+void DestroyArena(Arena_t* arena);
+
+#endif /*__ARENA_H__*/
@@ -0,0 +1,608 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  This file contains the headless batch mode of the game, used to push large puzzle files through the solver.
+    The input file is memory mapped and parsed in place by "ParseNextPuzzle", which accepts both one puzzle per 81 character line
+    and the SDK layout of 9 lines of 9 characters ('.' or '0' for an empty slot, blanks and '|', '-', '+' between them, '#' starts a comment line).
+    Lines of any other text, such as a "Grid 01" title, are skipped, and a puzzle with missing slots is dropped and counted instead of
+    running into the next one.
+    The puzzles are cut into blocks that a pool of worker threads solves with the Solver.c engine, each worker owning a deque of blocks
+    and stealing from the others when its own deque runs dry, since hard puzzles take far longer than easy ones.
+    Finished blocks wait in a reorder buffer so the solutions are written as 81 character lines to a buffered output stream in input order
+    (a puzzle without a solution is written back unchanged).
+    At the end the number of puzzles and the puzzles per second are reported; "RunBatchScaling" repeats the run with 1, 2, 4... workers.
+***************************************************************************************/
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Errors.h"
+#include "Batch.h"
+#include "Solver.h"
+#include "Platform.h"
+#include "Ui.h"
+
+#define BATCH_LINE_SIZE (SUDOKU_CELLS + 1)
+#define BATCH_WRITER_SIZE (1 << 16)
+#define BATCH_BLOCK_PUZZLES 32
+#define BATCH_BLOCKS_PER_WORKER 16
+
+typedef enum
+{
+    BLOCK_FREE = 0,
+    BLOCK_QUEUED,
+    BLOCK_DONE
+} BlockState;
+
+typedef struct BatchBlock
+{
+    signed char boards[BATCH_BLOCK_PUZZLES][SUDOKU_SIZE][SUDOKU_SIZE];
+    char lines[BATCH_BLOCK_PUZZLES * BATCH_LINE_SIZE];
+    size_t count;
+    size_t unsolved;
+    BlockState state;
+} BatchBlock_t;
+
+/* Blocks waiting for one worker, stored as a ring of block sequence numbers.
+   The owner takes the oldest block from the front, thieves take the newest from the back. */
+typedef struct WorkDeque
+{
+    Lock_t* lock;
+    size_t* items;
+    size_t first;
+    size_t count;
+} WorkDeque_t;
+
+typedef struct BatchWorker
+{
+    struct BatchPool* pool;
+    Thread_t* thread;
+    WorkDeque_t deque;
+    SolutionIterator_t* iterator;   /* per thread solver state */
+    size_t steals;
+} BatchWorker_t;
+
+typedef struct BatchPool
+{
+    BatchBlock_t* blocks;           /* reorder buffer, block n lives in blocks[n % ringSize] */
+    size_t ringSize;
+    BatchWorker_t* workers;
+    int numWorkers;
+    Lock_t* lock;                   /* protects the block states, 'pending' and 'finished' */
+    Condition_t* workAvailable;
+    Condition_t* blockDone;
+    size_t pending;                 /* blocks pushed to a deque and not yet claimed by a worker */
+    int finished;
+} BatchPool_t;
+
+typedef struct BatchStats
+{
+    size_t puzzles;
+    size_t unsolved;
+    size_t steals;
+    size_t malformed;                   /* puzzles dropped because slots were missing */
+    unsigned long long elapsedNs;
+} BatchStats_t;
+
+struct BatchWriter
+{
+    FILE* stream;                   /* NULL discards the output */
+    size_t used;
+    char buffer[BATCH_WRITER_SIZE];
+};
+
+
+static void FlushBatchWriter(BatchWriter_t* writer)
+{
+    if (writer->used && writer->stream)
+    {
+        fwrite(writer->buffer, 1, writer->used, writer->stream);
+    }
+    writer->used = 0;
+}
+
+static void WriteBatchLines(BatchWriter_t* writer, const char* lines, size_t count)
+{
+    size_t size = count * BATCH_LINE_SIZE;
+
+    if (writer->used + size > BATCH_WRITER_SIZE)
+    {
+        FlushBatchWriter(writer);
+    }
+    memcpy(writer->buffer + writer->used, lines, size);
+    writer->used += size;
+}
+
+static void SolveBlock(BatchBlock_t* block, SolutionIterator_t* iterator)
+{
+    block->unsolved = 0;
+    for (size_t i = 0; i < block->count; i++)
+    {
+        InitSolutionIterator(iterator, block->boards[i]);
+        if (!NextSolution(iterator, block->boards[i]))
+        {
+            // A puzzle without a solution is echoed unchanged, its '.' slots mark it in the output
+            ++block->unsolved;
+        }
+        FormatBoardLine(block->boards[i], block->lines + i * BATCH_LINE_SIZE);
+    }
+}
+
+static int PopFront(WorkDeque_t* deque, size_t capacity, size_t* item)
+{
+    int found = 0;
+
+    AcquireLock(deque->lock);
+    if (deque->count)
+    {
+        *item = deque->items[deque->first];
+        deque->first = (deque->first + 1) % capacity;
+        --deque->count;
+        found = 1;
+    }
+    ReleaseLock(deque->lock);
+
+    return found;
+}
+
+static int PopBack(WorkDeque_t* deque, size_t capacity, size_t* item)
+{
+    int found = 0;
+
+    AcquireLock(deque->lock);
+    if (deque->count)
+    {
+        --deque->count;
+        *item = deque->items[(deque->first + deque->count) % capacity];
+        found = 1;
+    }
+    ReleaseLock(deque->lock);
+
+    return found;
+}
+
+static void PushBack(WorkDeque_t* deque, size_t capacity, size_t item)
+{
+    AcquireLock(deque->lock);
+    deque->items[(deque->first + deque->count) % capacity] = item;
+    ++deque->count;
+    ReleaseLock(deque->lock);
+}
+
+/**
+ * @brief Takes the next block for a worker: its own oldest block, otherwise the newest block of another worker.
+ */
+static int TakeBlock(BatchWorker_t* worker, size_t* sequence)
+{
+    BatchPool_t* pool = worker->pool;
+    int index = (int)(worker - pool->workers);
+
+    if (PopFront(&worker->deque, pool->ringSize, sequence))
+    {
+        return 1;
+    }
+    for (int i = 1; i < pool->numWorkers; i++)
+    {
+        if (PopBack(&pool->workers[(index + i) % pool->numWorkers].deque, pool->ringSize, sequence))
+        {
+            ++worker->steals;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void BatchWorkerLoop(void* arg)
+{
+    BatchWorker_t* worker = (BatchWorker_t*)arg;
+    BatchPool_t* pool = worker->pool;
+    BatchBlock_t* block = NULL;
+    size_t sequence = 0;
+
+    while (1)
+    {
+        AcquireLock(pool->lock);
+        while (!pool->pending && !pool->finished)
+        {
+            WaitCondition(pool->workAvailable, pool->lock);
+        }
+        if (!pool->pending)
+        {
+            ReleaseLock(pool->lock);
+            return;
+        }
+        // Claim one block, it is guaranteed to sit in one of the deques
+        --pool->pending;
+        ReleaseLock(pool->lock);
+
+        // The claimed block can be between a pop and a push for a moment, the thread that holds it is let run
+        while (!TakeBlock(worker, &sequence))
+        {
+            YieldThread();
+        }
+
+        block = &pool->blocks[sequence % pool->ringSize];
+        SolveBlock(block, worker->iterator);
+
+        AcquireLock(pool->lock);
+        block->state = BLOCK_DONE;
+        SignalCondition(pool->blockDone);
+        ReleaseLock(pool->lock);
+    }
+}
+
+static void DestroyBatchPool(BatchPool_t* pool)
+{
+    if (!pool)
+    {
+        return;
+    }
+
+    if (pool->workers)
+    {
+        AcquireLock(pool->lock);
+        pool->finished = 1;
+        BroadcastCondition(pool->workAvailable);
+        ReleaseLock(pool->lock);
+
+        for (int i = 0; i < pool->numWorkers; i++)
+        {
+            JoinThread(pool->workers[i].thread);
+            DestroyLock(pool->workers[i].deque.lock);
+            free(pool->workers[i].deque.items);
+            DestroySolutionIterator(pool->workers[i].iterator);
+        }
+        free(pool->workers);
+    }
+    DestroyCondition(pool->blockDone);
+    DestroyCondition(pool->workAvailable);
+    DestroyLock(pool->lock);
+    free(pool->blocks);
+    free(pool);
+}
+
+static BatchPool_t* CreateBatchPool(int numWorkers)
+{
+    BatchPool_t* pool = NULL;
+    BatchWorker_t* worker = NULL;
+
+    pool = (BatchPool_t*)AllocateZeroed(1, sizeof(BatchPool_t));
+    if (!pool)
+    {
+        return NULL;
+    }
+
+    pool->numWorkers = numWorkers;
+    pool->ringSize = (size_t)numWorkers * BATCH_BLOCKS_PER_WORKER;
+    pool->blocks = (BatchBlock_t*)AllocateZeroed(pool->ringSize, sizeof(BatchBlock_t));
+    pool->lock = CreateLock();
+    pool->workAvailable = CreateCondition();
+    pool->blockDone = CreateCondition();
+    if (!pool->blocks || !pool->lock || !pool->workAvailable || !pool->blockDone)
+    {
+        DestroyBatchPool(pool);
+        return NULL;
+    }
+
+    pool->workers = (BatchWorker_t*)AllocateZeroed(numWorkers, sizeof(BatchWorker_t));
+    if (!pool->workers)
+    {
+        DestroyBatchPool(pool);
+        return NULL;
+    }
+    for (int i = 0; i < numWorkers; i++)
+    {
+        worker = &pool->workers[i];
+        worker->pool = pool;
+        worker->deque.lock = CreateLock();
+        worker->deque.items = (size_t*)Allocate(pool->ringSize * sizeof(size_t));
+        worker->iterator = (SolutionIterator_t*)AllocateAligned(CACHE_LINE_SIZE, sizeof(SolutionIterator_t));
+        if (!worker->deque.lock || !worker->deque.items || !worker->iterator)
+        {
+            pool->numWorkers = i + 1;
+            DestroyBatchPool(pool);
+            return NULL;
+        }
+    }
+    for (int i = 0; i < numWorkers; i++)
+    {
+        pool->workers[i].thread = StartThread(BatchWorkerLoop, &pool->workers[i]);
+        if (!pool->workers[i].thread)
+        {
+            pool->numWorkers = i;
+            DestroyBatchPool(pool);
+            return NULL;
+        }
+    }
+
+    return pool;
+}
+
+/**
+ * @brief Streams every puzzle of a mapped file through a pool of workers and writes the solutions in input order.
+ *  The main thread parses blocks into the reorder buffer while it has free slots, and writes finished blocks in sequence.
+ */
+static Errors SolveMappedFile(const MappedFile_t* input, FILE* stream, int numWorkers, BatchStats_t* stats)
+{
+    BatchPool_t* pool = NULL;
+    BatchWriter_t* writer = NULL;
+    BatchBlock_t* block = NULL;
+    const char* cursor = input->data, * end = input->data + input->size, * next = NULL;
+    size_t nextToParse = 0, nextToWrite = 0;
+    int inputDone = 0;
+    unsigned long long start = 0;
+
+    pool = CreateBatchPool(numWorkers);
+    writer = (BatchWriter_t*)Allocate(sizeof(BatchWriter_t));
+    if (!pool || !writer)
+    {
+        DestroyBatchPool(pool);
+        free(writer);
+        return ERR_ALLOCATION_FAILED;
+    }
+    writer->stream = stream;
+    writer->used = 0;
+
+    stats->puzzles = stats->unsolved = stats->steals = stats->malformed = 0;
+    start = GetTimeNs();
+    while (1)
+    {
+        // Fill the free slots of the reorder buffer and hand the blocks out round robin
+        while (!inputDone && nextToParse - nextToWrite < pool->ringSize)
+        {
+            block = &pool->blocks[nextToParse % pool->ringSize];
+            block->count = 0;
+            while (block->count < BATCH_BLOCK_PUZZLES &&
+                (next = ParseNextPuzzle(cursor, end, block->boards[block->count], &stats->malformed)) != NULL)
+            {
+                cursor = next;
+                ++block->count;
+            }
+            if (block->count < BATCH_BLOCK_PUZZLES)
+            {
+                inputDone = 1;
+            }
+            if (!block->count)
+            {
+                break;
+            }
+
+            block->state = BLOCK_QUEUED;
+            PushBack(&pool->workers[nextToParse % numWorkers].deque, pool->ringSize, nextToParse);
+            AcquireLock(pool->lock);
+            ++pool->pending;
+            SignalCondition(pool->workAvailable);
+            ReleaseLock(pool->lock);
+            ++nextToParse;
+        }
+
+        if (nextToWrite == nextToParse)
+        {
+            break;
+        }
+
+        // Write the oldest block as soon as it is solved, later blocks wait their turn in the buffer
+        block = &pool->blocks[nextToWrite % pool->ringSize];
+        AcquireLock(pool->lock);
+        while (block->state != BLOCK_DONE)
+        {
+            WaitCondition(pool->blockDone, pool->lock);
+        }
+        block->state = BLOCK_FREE;
+        ReleaseLock(pool->lock);
+
+        WriteBatchLines(writer, block->lines, block->count);
+        stats->puzzles += block->count;
+        stats->unsolved += block->unsolved;
+        ++nextToWrite;
+    }
+    FlushBatchWriter(writer);
+    stats->elapsedNs = GetTimeNs() - start;
+
+    for (int i = 0; i < numWorkers; i++)
+    {
+        stats->steals += pool->workers[i].steals;
+    }
+
+    DestroyBatchPool(pool);
+    free(writer);
+
+    return ERR_OK;
+}
+
+Errors RunBatchSolve(const char* inputPath, const char* outputPath, int numWorkers)
+{
+    MappedFile_t input;
+    BatchStats_t stats;
+    FILE* stream = NULL;
+    Errors eErr = ERR_OK;
+    int toStdout = !outputPath || strcmp(outputPath, "-") == 0;
+
+    if (numWorkers <= 0)
+    {
+        numWorkers = GetProcessorCount();
+    }
+
+    if (MapFile(inputPath, &input) != ERR_OK)
+    {
+        return ERR_GENERAL;
+    }
+    stream = toStdout ? stdout : fopen(outputPath, "wb");
+    if (!stream)
+    {
+        UnmapFile(&input);
+        return ERR_GENERAL;
+    }
+
+    eErr = SolveMappedFile(&input, stream, numWorkers, &stats);
+    if (eErr == ERR_OK)
+    {
+        PrintBatchSummary(stats.puzzles, stats.unsolved, stats.malformed, stats.elapsedNs, numWorkers, stats.steals);
+    }
+
+    if (!toStdout)
+    {
+        fclose(stream);
+    }
+    UnmapFile(&input);
+
+    return eErr;
+}
+
+Errors RunBatchScaling(const char* inputPath, int maxWorkers)
+{
+    MappedFile_t input;
+    BatchStats_t stats;
+    double baseline = 0, rate = 0;
+    Errors eErr = ERR_OK;
+
+    if (maxWorkers <= 0)
+    {
+        maxWorkers = GetProcessorCount();
+    }
+
+    if (MapFile(inputPath, &input) != ERR_OK)
+    {
+        return ERR_GENERAL;
+    }
+
+    // 1, 2, 4, ... workers and finally maxWorkers itself, the solutions are discarded
+    for (int workers = 1; eErr == ERR_OK; workers = workers * 2 < maxWorkers ? workers * 2 : maxWorkers)
+    {
+        eErr = SolveMappedFile(&input, NULL, workers, &stats);
+        if (eErr != ERR_OK)
+        {
+            break;
+        }
+        rate = stats.elapsedNs ? stats.puzzles * 1e9 / stats.elapsedNs : 0;
+        if (workers == 1)
+        {
+            baseline = rate;
+        }
+        PrintBatchScaling(workers, rate, baseline > 0 ? rate / baseline : 0, stats.steals);
+        if (workers == maxWorkers)
+        {
+            break;
+        }
+    }
+
+    UnmapFile(&input);
+
+    return eErr;
+}
+
+/**
+ * @brief Returns whether a character may sit between the slots of a grid line: blanks and the box drawing of the SDK layouts.
+ */
+static int IsGridSeparator(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '|' || c == '-' || c == '+' || c == '=' || c == '*' || c == ',';
+}
+
+const char* ParseNextPuzzle(const char* cursor, const char* end, signed char board[][SUDOKU_SIZE], size_t* malformed)
+{
+    signed char* cells = &board[0][0];
+    const char* line = NULL;
+    size_t rejected = 0;
+    int count = 0, start = 0, text = 0;
+    char c = 0;
+
+    while (cursor < end)
+    {
+        // Comment lines of the SDK layout
+        if (*cursor == '#')
+        {
+            while (cursor < end && *cursor != '\n')
+            {
+                ++cursor;
+            }
+            // The last line may have no line end, the cursor never goes past 'end'
+            cursor += cursor < end;
+            continue;
+        }
+
+        line = cursor;
+        start = count;
+        text = 0;
+        while (cursor < end && *cursor != '\n')
+        {
+            c = *cursor++;
+            if (c >= '1' && c <= '9')
+            {
+                cells[count++] = c - '0';
+            }
+            else if (c == '.' || c == '0')
+            {
+                cells[count++] = -1;
+            }
+            else if (!IsGridSeparator(c))
+            {
+                // A title such as "Grid 01", its digits are not slots
+                text = 1;
+                break;
+            }
+
+            if (count == SUDOKU_CELLS)
+            {
+                // Whatever follows the 81st slot on the same line (a rating, a solution...) is ignored
+                while (cursor < end && *cursor != '\n')
+                {
+                    ++cursor;
+                }
+                if (malformed)
+                {
+                    *malformed += rejected;
+                }
+                return cursor < end ? cursor + 1 : end;
+            }
+            if (start > 0 && count - start > SUDOKU_SIZE)
+            {
+                // More than a row after a partial grid: the grid was cut short and this line starts a puzzle of its own
+                ++rejected;
+                count = start = 0;
+                cursor = line;
+            }
+        }
+        while (cursor < end && *cursor != '\n')
+        {
+            ++cursor;
+        }
+        cursor += cursor < end;
+
+        if (text)
+        {
+            // A title inside a grid leaves the grid short
+            rejected += start > 0;
+            count = 0;
+        }
+        else if (count != start && count - start != SUDOKU_SIZE)
+        {
+            // A line is blank, a row of 9 slots or a whole puzzle: a shorter one-line puzzle or a broken row is dropped
+            ++rejected;
+            count = 0;
+        }
+    }
+
+    // A puzzle the buffer ends in the middle of
+    rejected += count > 0;
+    if (malformed)
+    {
+        *malformed += rejected;
+    }
+
+    return NULL;
+}
+
+void FormatBoardLine(signed char board[][SUDOKU_SIZE], char* line)
+{
+    const signed char* cells = &board[0][0];
+
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        line[i] = cells[i] == -1 ? '.' : (char)('0' + cells[i]);
+    }
+    line[SUDOKU_CELLS] = '\n';
+}
@@ -0,0 +1,68 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  This file contains the headless batch mode of the game, used to push large puzzle files through the solver.
+    The input file is memory mapped and parsed in place by "ParseNextPuzzle", which accepts both one puzzle per 81 character line
+    and the SDK layout of 9 lines of 9 characters ('.' or '0' for an empty slot, blanks and '|', '-', '+' between them, '#' starts a comment line).
+    The puzzles are cut into blocks that a pool of worker threads solves with the Solver.c engine, each worker owning a deque of blocks
+    and stealing from the others when its own deque runs dry, since hard puzzles take far longer than easy ones.
+    Finished blocks wait in a reorder buffer so the solutions are written as 81 character lines to a buffered output stream in input order
+    (a puzzle without a solution is written back unchanged).
+    At the end the number of puzzles and the puzzles per second are reported; "RunBatchScaling" repeats the run with 1, 2, 4... workers.
+***************************************************************************************/
+
+#ifndef __BATCH_H__
+#define __BATCH_H__
+
+#include "Solver.h"
+
+typedef struct BatchWriter BatchWriter_t;
+
+
+/**
+ * @brief Solves every puzzle of a file and writes the solutions in the same order.
+ *
+ * @param inputPath: path of the puzzle file.
+ * @param outputPath: path of the solutions file, NULL or "-" for the standard output.
+ * @param numWorkers: number of solver threads, 0 for one per processor.
+ *
+ * @return ERR_OK on success, ERR_GENERAL if a file cannot be opened, ERR_ALLOCATION_FAILED if the worker pool cannot be created.
+ */
+Errors RunBatchSolve(const char* inputPath, const char* outputPath, int numWorkers);
+
+/**
+ * @brief Solves a puzzle file again and again with 1, 2, 4... up to maxWorkers threads, discarding the solutions,
+ *  and reports the puzzles per second and the speedup over one thread for every run.
+ *
+ * @param inputPath: path of the puzzle file.
+ * @param maxWorkers: the largest number of threads to measure, 0 for one per processor.
+ *
+ * @return ERR_OK on success, ERR_GENERAL if the file cannot be opened, ERR_ALLOCATION_FAILED if a worker pool cannot be created.
+ */
+Errors RunBatchScaling(const char* inputPath, int maxWorkers);
+
+/**
+ * @brief Parses the next puzzle of a text buffer.
+ *
+ * @param cursor: where to start reading.
+ * @param end: the end of the buffer.
+ * @param board: receives the puzzle, -1 for an empty slot.
+ * @param malformed: the puzzles dropped on the way because slots were missing are added to it, may be NULL.
+ *  A one-line puzzle shorter than 81 slots, a row that is not 9 slots, a grid cut short by a title line
+ *  and a puzzle the buffer ends in are all dropped.
+ *
+ * @return the position right after the puzzle, or NULL if the buffer holds no further complete puzzle.
+ */
+const char* ParseNextPuzzle(const char* cursor, const char* end, signed char board[][SUDOKU_SIZE], size_t* malformed);
+
+/**
+ * @brief Formats a board as an 81 character line followed by a new line ('.' for an empty slot).
+ *
+ * @param board: the board to format.
+ * @param line: receives the 82 characters, it is not null terminated.
+ */
+void FormatBoardLine(signed char board[][SUDOKU_SIZE], char* line);
+
+
+
+#endif /*__BATCH_H__*/
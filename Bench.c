@@ -0,0 +1,572 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  The benchmark suite. A benchmark is a function that performs call number 'op' of what it measures.
+    The calls are timed in batches, a batch is grown until it takes BENCH_SAMPLE_NS so the clock is not what is
+    measured. The percentiles are those of the mean time per call of BENCH_SAMPLES batches, which shows how steady the
+    measure is, not how slow a single call can be: one slow call is averaged over its whole batch. The allocations per call
+    are counted with GetAllocationCount, which every allocation of the program goes through.
+    The calls that change a board work on a copy of the prepared board, so they include copying its 432 bytes.
+***************************************************************************************/
+
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Errors.h"
+#include "Bench.h"
+#include "Solver.h"
+#include "Board.h"
+#include "Batch.h"
+#include "Kernel.h"
+#include "Players.h"
+#include "Leaderboard.h"
+#include "Arena.h"
+#include "Random.h"
+#include "Platform.h"
+#include "Bits.h"
+#include "Ui.h"
+#include "TimerWheel.h"
+
+#define BENCH_SAMPLES 64
+#define BENCH_SAMPLE_NS 200000ull
+#define BENCH_MAX_BATCH (1u << 20)
+#define BENCH_RANK_PLAYERS 10000
+#define BENCH_TOURNAMENT_PLAYERS 20000
+#define BENCH_TOURNAMENT_BOARDS 64
+#define BENCH_TOURNAMENTS 8
+#define BENCH_TIMERS 100000
+#define BENCH_TIMER_SPAN_MS 30000
+
+/* Puzzles that only need singles, generated with no guesses allowed */
+static const char* g_easyCorpus[] =
+{
+    "8..4.9..6...81....2...3..85..4387.........51.9.8..54.3152....3.........4.6..2....",
+    "...7.91..13......77....5.9....19.23..........8....6.15..6..8.5.98.6234......41..6",
+    ".7.....2...4.....8.5.214...9..467....1..2...........3..8.3.12461....6..343.5....9",
+    "...24........8....6.217.4.5...42.58...456..1..2.........38.....87.9.4.61..6....3.",
+    "38.57..2.1......48......1..82.6.7...9..1.586....3.4...61..5.9...528.9.........28.",
+    ".3..7...14..8.....2.6.9...79....876..8..1.2.474....9....7.......9.1..8.31..235.7.",
+    "..8.....7..4.9..81.....8.4...56.78.........3....2.517414...6....5.3..4..7..8.93..",
+    "..56842.3...7.5...7.3.2......7...64.......59...1.57.....9.....484......553...9..2",
+};
+
+/* Puzzles the solver needs 2 to 5 guesses for, like the boards of the game */
+static const char* g_mediumCorpus[] =
+{
+    "8..4.9..6...81....2...3..85..4387.........5..9....54.3152..............4.6..2....",
+    "...7.9...13......77....5.9.....9.23..........8....6.15..6....5.98.62.4......41..6",
+    ".7.....2...4.....8.5.214...9..467....1..............3..8.3.12.6.....6..343.5....9",
+    ".3..7...14..8.....2.6.9...79....876..8..1.2.4.4.........7.......9.1..8.3...2.5.7.",
+    "..385.....4..2..5......6......6.1.8419.4...3..7.9....5.1...8.....4.....138.5...6.",
+    ".642.3.......9......98............6553..4.1.992.65..3.....6.9..158....4..........",
+    "3.5........8..7.5..9...8..4.2.......43..9...6..9..4...1.....7...73...58..5..3.1..",
+    ".2...9.6.....5...34..8..7.2...694.7.......3..8.....6.5.5..6.......1.2....13..8...",
+};
+
+/* Well known hard puzzles (Inkala's, Easter Monster, AI Escargot and one of Norvig's) and generated ones
+   that need 25 guesses or more */
+static const char* g_hardCorpus[] =
+{
+    "800000000003600000070090200050007000000045700000100030001000068008500010090000400",
+    "1.......2.9.4...5...6...7...5.9.3.......7.......85..4.7.....6...3...9.8...2.....1",
+    "1....7.9..3..2...8..96..5....53..9...1..8...26....4...3......1..4......7..7...3..",
+    "4.....8.5.3..........7......2.....6.....8.4......1.......6.3.7.5..2.....1.4......",
+    ".1.2........5.76.9.......5...8.4...1...7.....74...39..13.......4....2...2...98.63",
+    "27.......1..9.4.6...65......3..4....65..1.3.4..2....1.9.......7...79...3...62....",
+    "..54....8.8.39..5.1......7.......13.6.....4...5............6.2...2..7..9..9.5..4.",
+    ".....6..9.4.3...........7..8...1...3..1....5..6.254...7....53..2....16..51..7....",
+};
+
+/* Puzzles with the fewest clues a unique sudoku can have */
+static const char* g_seventeenCorpus[] =
+{
+    "000000010400000000020000000000050407008000300001090000300400200050100000000806000",
+    "000000010400000000020000000000050604008000300001090000300400200050100000000807000",
+    "000000012000035000000600070700000300000400800100000000000120000080000040050000600",
+    "000000012003600000000007000410020000000500300700000600280000040000300500000000000",
+    "000000012008030000000000040120500000000004700060000000507000300000620000000100000",
+    "000000012040050000000009000070600400000100000000000050000087500601000300200000000",
+    "000000012050400000000000030700600400001000000000080000920000800000510700000003000",
+    "000000013000030080070000000000206000030000900000010000600500204000400700100000000",
+};
+
+typedef struct BenchCorpus
+{
+    const char* name;
+    const char** puzzles;
+    size_t count;
+} BenchCorpus_t;
+
+/* A prepared board and the move UpdatingPossibleDigits is timed with */
+typedef struct BenchPuzzle
+{
+    Candidates_t possibilities;
+    signed char board[SUDOKU_SIZE][SUDOKU_SIZE];
+    unsigned char cell;                 /* the most constrained empty slot */
+    short digit;                        /* its lowest candidate */
+} BenchPuzzle_t;
+
+typedef struct Bench
+{
+    FILE* output;
+    const char* filter;
+    unsigned long long seed;
+    const char* corpus;                 /* the corpus the benchmarks below run on */
+    BenchPuzzle_t* puzzles;
+    size_t count;
+    unsigned int* emptySlots;           /* puzzle * SUDOKU_CELLS + slot of every empty slot of the corpus */
+    size_t emptyCount;
+    BenchPuzzle_t scratch;
+    Random_t random;
+    Player_t** players;
+    Player_t** order;
+    size_t added;                       /* players added to the leaderboard since it was last emptied */
+    Arena_t arena;
+    Leaderboard_t leaderboard;
+    TimerWheel_t* wheel;
+    Timer_t* timers;
+    unsigned long long clock;           /* the tick the wheel was last advanced to */
+    unsigned long long sink;            /* results are added here so the compiler cannot drop the calls */
+    double samples[BENCH_SAMPLES];
+} Bench_t;
+
+typedef void (*BenchOp_t)(Bench_t* bench, size_t op);
+
+static int CompareSamples(const void* a, const void* b)
+{
+    double first = *(const double*)a, second = *(const double*)b;
+
+    return (first > second) - (first < second);
+}
+
+static double Percentile(const double* sorted, size_t count, double fraction)
+{
+    return sorted[(size_t)(fraction * (count - 1) + 0.5)];
+}
+
+static int IsSelected(const Bench_t* bench, const char* name, const char* corpus)
+{
+    return !bench->filter || strstr(name, bench->filter) || strstr(corpus, bench->filter);
+}
+
+/**
+ * @brief Reports the samples of a benchmark, sorting them, on the standard error stream and as a CSV line.
+ */
+static void ReportBenchmark(Bench_t* bench, const char* name, const char* corpus, size_t samples, size_t ops,
+    unsigned long long elapsedNs, unsigned long long allocations)
+{
+    double nsPerOp = (double)elapsedNs / ops;
+    double allocationsPerOp = (double)allocations / ops;
+    double p50, p90, p99;
+
+    qsort(bench->samples, samples, sizeof(double), CompareSamples);
+    p50 = Percentile(bench->samples, samples, 0.5);
+    p90 = Percentile(bench->samples, samples, 0.9);
+    p99 = Percentile(bench->samples, samples, 0.99);
+
+    PrintBenchResult(name, corpus, nsPerOp, p50, p90, p99, allocationsPerOp);
+    fprintf(bench->output, "%s,%s,%zu,%.1f,%.1f,%.1f,%.1f,%.3f\n", name, corpus, ops, nsPerOp, p50, p90, p99, allocationsPerOp);
+}
+
+/**
+ * @brief Times a benchmark: the batch size is doubled until a batch takes BENCH_SAMPLE_NS, then BENCH_SAMPLES batches are timed.
+ */
+static void RunBenchmark(Bench_t* bench, const char* name, BenchOp_t op)
+{
+    size_t batch = 1, ops = 0;
+    unsigned long long start = 0, elapsed = 0, total = 0, allocations = 0;
+
+    if (!IsSelected(bench, name, bench->corpus))
+    {
+        return;
+    }
+
+    // The calibration batches also warm the caches and the branch predictors
+    while (batch < BENCH_MAX_BATCH)
+    {
+        start = GetTimeNs();
+        for (size_t i = 0; i < batch; i++)
+        {
+            op(bench, i);
+        }
+        if (GetTimeNs() - start >= BENCH_SAMPLE_NS)
+        {
+            break;
+        }
+        batch *= 2;
+    }
+
+    allocations = GetAllocationCount();
+    for (size_t sample = 0; sample < BENCH_SAMPLES; sample++)
+    {
+        start = GetTimeNs();
+        for (size_t i = 0; i < batch; i++)
+        {
+            op(bench, ops + i);
+        }
+        elapsed = GetTimeNs() - start;
+        bench->samples[sample] = (double)elapsed / batch;
+        total += elapsed;
+        ops += batch;
+    }
+
+    ReportBenchmark(bench, name, bench->corpus, BENCH_SAMPLES, ops, total, GetAllocationCount() - allocations);
+}
+
+static void BenchCreateSudokuBoard(Bench_t* bench, size_t op)
+{
+    CreateSudokuBoard(bench->scratch.board, &bench->random);
+    bench->sink += (unsigned char)bench->scratch.board[op % SUDOKU_SIZE][0];
+}
+
+static void BenchPossibleDigits(Bench_t* bench, size_t op)
+{
+    Candidates_t* possibilities = PossibleDigits(bench->puzzles[op % bench->count].board);
+
+    if (possibilities)
+    {
+        bench->sink += possibilities->filled;
+        DestroyPossibleDigits(possibilities);
+    }
+}
+
+static void BenchCheckPossibleValuesForSlot(Bench_t* bench, size_t op)
+{
+    unsigned int slot = bench->emptySlots[op % bench->emptyCount];
+    unsigned int cell = slot % SUDOKU_CELLS;
+
+    bench->sink += CheckPossibleValuesForSlot(bench->puzzles[slot / SUDOKU_CELLS].board, cell / SUDOKU_SIZE, cell % SUDOKU_SIZE);
+}
+
+static void BenchOneStage(Bench_t* bench, size_t op)
+{
+    int x = 0, y = 0;
+
+    bench->scratch = bench->puzzles[op % bench->count];
+    bench->sink += OneStage(bench->scratch.board, &bench->scratch.possibilities, &x, &y) + x;
+}
+
+static void BenchUpdatingPossibleDigits(Bench_t* bench, size_t op)
+{
+    BenchPuzzle_t* scratch = &bench->scratch;
+
+    *scratch = bench->puzzles[op % bench->count];
+    scratch->board[scratch->cell / SUDOKU_SIZE][scratch->cell % SUDOKU_SIZE] = (signed char)scratch->digit;
+    UpdatingPossibleDigits(scratch->board, &scratch->possibilities, scratch->cell / SUDOKU_SIZE, scratch->cell % SUDOKU_SIZE);
+    bench->sink += scratch->possibilities.filled;
+}
+
+static void BenchSolveBoard(Bench_t* bench, size_t op)
+{
+    memcpy(bench->scratch.board, bench->puzzles[op % bench->count].board, sizeof(bench->scratch.board));
+    bench->sink += SolveBoard(bench->scratch.board);
+}
+
+static void BenchRankPlayers(Bench_t* bench, size_t op)
+{
+    memcpy(bench->order, bench->players, BENCH_RANK_PLAYERS * sizeof(Player_t*));
+    bench->sink += RankPlayers(bench->order, BENCH_RANK_PLAYERS) + op;
+}
+
+static void BenchAddToLeaderboard(Bench_t* bench, size_t op)
+{
+    LeaderboardScore_t score;
+
+    // The leaderboard is emptied once every player is on it, which takes no allocation either
+    if (bench->added == BENCH_RANK_PLAYERS)
+    {
+        ResetArena(&bench->arena);
+        CreateLeaderboard(&bench->leaderboard, &bench->arena, BENCH_RANK_PLAYERS);
+        bench->added = 0;
+    }
+    score.round = (unsigned int)(op % 97);
+    score.moves = (unsigned int)(op % 61);
+    AddToLeaderboard(&bench->leaderboard, bench->players[bench->added++], &score);
+    bench->sink += bench->leaderboard.count;
+}
+
+static void BenchScheduleTimer(Bench_t* bench, size_t op)
+{
+    // A move arrived, the player's deadline moves to the end of the next move time
+    ScheduleTimer(bench->wheel, &bench->timers[op % BENCH_TIMERS], bench->clock + 1 + (op * 7919) % BENCH_TIMER_SPAN_MS);
+    bench->sink += bench->wheel->count;
+}
+
+static void RescheduleTimer(Timer_t* timer, void* context)
+{
+    Bench_t* bench = (Bench_t*)context;
+
+    ScheduleTimer(bench->wheel, timer, bench->clock + 1 + RandomBelow(&bench->random, BENCH_TIMER_SPAN_MS));
+}
+
+static void BenchAdvanceTimerWheel(Bench_t* bench, size_t op)
+{
+    // One millisecond of a server whose players all hold a deadline, every player that runs out of time gets a new one
+    bench->sink += AdvanceTimerWheel(bench->wheel, ++bench->clock, RescheduleTimer, bench) + op;
+}
+
+/**
+ * @brief Parses a corpus and prepares the candidate block, the empty slots and a move of every puzzle.
+ */
+static Errors LoadCorpus(Bench_t* bench, const BenchCorpus_t* corpus)
+{
+    BenchPuzzle_t* puzzle = NULL;
+    int cell = 0;
+
+    bench->corpus = corpus->name;
+    bench->count = corpus->count;
+    bench->emptyCount = 0;
+    bench->puzzles = (BenchPuzzle_t*)AllocateAligned(CACHE_LINE_SIZE, corpus->count * sizeof(BenchPuzzle_t));
+    bench->emptySlots = (unsigned int*)Allocate(corpus->count * SUDOKU_CELLS * sizeof(unsigned int));
+    if (!bench->puzzles || !bench->emptySlots)
+    {
+        return ERR_ALLOCATION_FAILED;
+    }
+
+    for (size_t i = 0; i < corpus->count; i++)
+    {
+        puzzle = &bench->puzzles[i];
+        ParseNextPuzzle(corpus->puzzles[i], corpus->puzzles[i] + SUDOKU_CELLS, puzzle->board, NULL);
+        InitPossibleDigits(&puzzle->possibilities, puzzle->board);
+        cell = MostConstrainedSlot(&puzzle->possibilities);
+        puzzle->cell = (unsigned char)cell;
+        puzzle->digit = LowestDigit(puzzle->possibilities.cell[cell]);
+        for (int slot = 0; slot < SUDOKU_CELLS; slot++)
+        {
+            if (puzzle->board[slot / SUDOKU_SIZE][slot % SUDOKU_SIZE] == -1)
+            {
+                bench->emptySlots[bench->emptyCount++] = (unsigned int)(i * SUDOKU_CELLS + slot);
+            }
+        }
+    }
+
+    return ERR_OK;
+}
+
+static void UnloadCorpus(Bench_t* bench)
+{
+    FreeAligned(bench->puzzles);
+    free(bench->emptySlots);
+    bench->puzzles = NULL;
+    bench->emptySlots = NULL;
+}
+
+static Errors RunCorpusBenchmarks(Bench_t* bench)
+{
+    const BenchCorpus_t corpora[] =
+    {
+        { "easy", g_easyCorpus, sizeof(g_easyCorpus) / sizeof(g_easyCorpus[0]) },
+        { "medium", g_mediumCorpus, sizeof(g_mediumCorpus) / sizeof(g_mediumCorpus[0]) },
+        { "hard", g_hardCorpus, sizeof(g_hardCorpus) / sizeof(g_hardCorpus[0]) },
+        { "17-clue", g_seventeenCorpus, sizeof(g_seventeenCorpus) / sizeof(g_seventeenCorpus[0]) },
+    };
+    Errors eErr = ERR_OK;
+
+    for (size_t i = 0; i < sizeof(corpora) / sizeof(corpora[0]) && eErr == ERR_OK; i++)
+    {
+        eErr = LoadCorpus(bench, &corpora[i]);
+        if (eErr == ERR_OK)
+        {
+            RunBenchmark(bench, "PossibleDigits", BenchPossibleDigits);
+            RunBenchmark(bench, "CheckPossibleValuesForSlot", BenchCheckPossibleValuesForSlot);
+            RunBenchmark(bench, "OneStage", BenchOneStage);
+            RunBenchmark(bench, "UpdatingPossibleDigits", BenchUpdatingPossibleDigits);
+            RunBenchmark(bench, "SolveBoard", BenchSolveBoard);
+        }
+        UnloadCorpus(bench);
+    }
+
+    return eErr;
+}
+
+/**
+ * @brief Times RankPlayers and AddToLeaderboard on the players of a tournament, in a shuffled order.
+ */
+static Errors RunPlayerBenchmarks(Bench_t* bench)
+{
+    ActivePlayerslistManeger_t* tournament = NULL;
+    Player_t* player = NULL;
+    size_t other = 0;
+    Errors eErr;
+
+    bench->corpus = "10000 players";
+    if (!IsSelected(bench, "RankPlayers", bench->corpus) && !IsSelected(bench, "AddToLeaderboard", bench->corpus))
+    {
+        return ERR_OK;
+    }
+    eErr = CreateTournament(&tournament, BENCH_RANK_PLAYERS, BOT_FIRST, BENCH_TOURNAMENT_BOARDS, bench->seed);
+    if (eErr != ERR_OK)
+    {
+        return eErr;
+    }
+    bench->players = CreateArrayActivePlayers(GetActivePlayers(tournament), BENCH_RANK_PLAYERS);
+    bench->order = (Player_t**)Allocate(BENCH_RANK_PLAYERS * sizeof(Player_t*));
+    if (!bench->players || !bench->order ||
+        CreateArena(&bench->arena, LeaderboardArenaSize(BENCH_RANK_PLAYERS)) != ERR_OK ||
+        CreateLeaderboard(&bench->leaderboard, &bench->arena, BENCH_RANK_PLAYERS) != ERR_OK)
+    {
+        eErr = ERR_ALLOCATION_FAILED;
+    }
+
+    if (eErr == ERR_OK)
+    {
+        // The players are created in name order, which would flatter the ranking
+        for (size_t i = BENCH_RANK_PLAYERS - 1; i > 0; i--)
+        {
+            other = RandomBelow(&bench->random, (unsigned int)(i + 1));
+            player = bench->players[i];
+            bench->players[i] = bench->players[other];
+            bench->players[other] = player;
+        }
+        bench->added = 0;
+        RunBenchmark(bench, "RankPlayers", BenchRankPlayers);
+        RunBenchmark(bench, "AddToLeaderboard", BenchAddToLeaderboard);
+    }
+
+    DestroyArena(&bench->arena);
+    free(bench->order);
+    free(bench->players);
+    DestroyTournament(tournament);
+
+    return eErr;
+}
+
+/**
+ * @brief Times the timer wheel with the deadlines of BENCH_TIMERS players spread over BENCH_TIMER_SPAN_MS.
+ */
+static Errors RunTimerBenchmarks(Bench_t* bench)
+{
+    bench->corpus = "100000 timers";
+    if (!IsSelected(bench, "ScheduleTimer", bench->corpus) && !IsSelected(bench, "AdvanceTimerWheel", bench->corpus))
+    {
+        return ERR_OK;
+    }
+    bench->wheel = (TimerWheel_t*)Allocate(sizeof(TimerWheel_t));
+    bench->timers = (Timer_t*)Allocate(BENCH_TIMERS * sizeof(Timer_t));
+    if (!bench->wheel || !bench->timers)
+    {
+        free(bench->wheel);
+        free(bench->timers);
+        return ERR_ALLOCATION_FAILED;
+    }
+
+    bench->clock = 0;
+    InitTimerWheel(bench->wheel, 1);
+    for (size_t i = 0; i < BENCH_TIMERS; i++)
+    {
+        InitTimer(&bench->timers[i], NULL);
+        ScheduleTimer(bench->wheel, &bench->timers[i], 1 + RandomBelow(&bench->random, BENCH_TIMER_SPAN_MS));
+    }
+    RunBenchmark(bench, "ScheduleTimer", BenchScheduleTimer);
+    RunBenchmark(bench, "AdvanceTimerWheel", BenchAdvanceTimerWheel);
+
+    free(bench->wheel);
+    free(bench->timers);
+
+    return ERR_OK;
+}
+
+/**
+ * @brief Times whole tournaments of bots, from ranking the players to the last round. A sample is one tournament.
+ */
+static Errors RunTournamentBenchmark(Bench_t* bench, const char* name, BotStrategy strategy)
+{
+    ActivePlayerslistManeger_t* tournament = NULL;
+    TournamentStats_t stats;
+    unsigned long long total = 0, allocations = 0, before = 0;
+    Errors eErr = ERR_OK;
+
+    bench->corpus = "20000 players";
+    if (!IsSelected(bench, name, bench->corpus))
+    {
+        return ERR_OK;
+    }
+
+    for (size_t sample = 0; sample < BENCH_TOURNAMENTS && eErr == ERR_OK; sample++)
+    {
+        // The same seed every time, so every sample plays exactly the same moves
+        eErr = CreateTournament(&tournament, BENCH_TOURNAMENT_PLAYERS, strategy, BENCH_TOURNAMENT_BOARDS, bench->seed);
+        if (eErr != ERR_OK)
+        {
+            break;
+        }
+        before = GetAllocationCount();
+        eErr = PlayTournament(tournament, &stats);
+        allocations += GetAllocationCount() - before;
+        bench->samples[sample] = (double)stats.elapsedNs;
+        total += stats.elapsedNs;
+        DestroyTournament(tournament);
+    }
+
+    if (eErr == ERR_OK)
+    {
+        ReportBenchmark(bench, name, bench->corpus, BENCH_TOURNAMENTS, BENCH_TOURNAMENTS, total, allocations);
+    }
+
+    return eErr;
+}
+
+Errors RunBenchmarks(const char* outputPath, const char* filter, unsigned long long seed)
+{
+    Bench_t* bench = NULL;
+    Errors eErr = ERR_OK;
+
+    // The bench holds a few candidate blocks, it is aligned like every other one
+    bench = (Bench_t*)AllocateAligned(CACHE_LINE_SIZE, sizeof(Bench_t));
+    if (!bench)
+    {
+        return ERR_ALLOCATION_FAILED;
+    }
+    memset(bench, 0, sizeof(Bench_t));
+    bench->output = outputPath ? fopen(outputPath, "w") : stdout;
+    if (!bench->output)
+    {
+        FreeAligned(bench);
+        return ERR_GENERAL;
+    }
+    bench->filter = filter;
+    bench->seed = seed;
+    SeedRandom(&bench->random, seed, 0);
+
+    PrintBenchHeader(GetBoardKernelName(), seed);
+    fprintf(bench->output, "benchmark,corpus,ops,ns_per_op,batch_p50_ns,batch_p90_ns,batch_p99_ns,allocations_per_op\n");
+
+    bench->corpus = "generated";
+    RunBenchmark(bench, "CreateSudokuBoard", BenchCreateSudokuBoard);
+    eErr = RunCorpusBenchmarks(bench);
+    if (eErr == ERR_OK)
+    {
+        eErr = RunPlayerBenchmarks(bench);
+    }
+    if (eErr == ERR_OK)
+    {
+        eErr = RunTimerBenchmarks(bench);
+    }
+    if (eErr == ERR_OK)
+    {
+        eErr = RunTournamentBenchmark(bench, "Tournament/first", BOT_FIRST);
+    }
+    if (eErr == ERR_OK)
+    {
+        eErr = RunTournamentBenchmark(bench, "Tournament/random", BOT_RANDOM);
+    }
+    if (eErr == ERR_OK)
+    {
+        eErr = RunTournamentBenchmark(bench, "Tournament/lookahead", BOT_LOOKAHEAD);
+    }
+
+    // Keeps the results of the calls alive without printing anything
+    if (bench->sink == 1)
+    {
+        fflush(bench->output);
+    }
+    if (bench->output != stdout)
+    {
+        fclose(bench->output);
+    }
+    FreeAligned(bench);
+
+    return eErr;
+}
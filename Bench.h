@@ -0,0 +1,26 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  The benchmark suite. Micro benchmarks time the generator, the candidate engine, the solver, the ranking,
+    the leaderboard and the timer wheel one call at a time on the puzzle corpora bundled in Bench.c (easy, medium, hard and 17 clue),
+    and macro benchmarks time whole tournaments of bots. Everything runs on fixed seeds, so two builds are measured on
+    the same work and their results can be compared line by line.
+***************************************************************************************/
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+/**
+ * @brief Runs the benchmarks and writes one CSV line per benchmark: the name, the corpus, the number of calls,
+ *  the mean time of a call in nanoseconds, the median, 90th and 99th percentile of the mean time of a call over the
+ *  timed batches (a tournament benchmark times one tournament a batch) and the allocations per call.
+ *
+ * @param outputPath: the CSV file, NULL for the standard output.
+ * @param filter: only the benchmarks whose name or corpus contains this text are run, NULL for all of them.
+ * @param seed: the seed of the generator and of the tournaments.
+ *
+ * @return ERR_OK, ERR_GENERAL if the output file cannot be opened or ERR_ALLOCATION_FAILED.
+ */
+Errors RunBenchmarks(const char* outputPath, const char* filter, unsigned long long seed);
+
+#endif /*__BENCH_H__*/
@@ -0,0 +1,102 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  Small bit helpers shared by the candidate engine and the solver.
+    Candidate sets are stored as 9-bit masks where bit (d - 1) stands for digit d,
+    so counting candidates and picking the lowest one map to single instructions on
+    the compilers we build with.
+***************************************************************************************/
+
+#ifndef __BITS_H__
+#define __BITS_H__
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#define ALL_DIGITS_MASK 0x1FF
+
+#define DIGIT_TO_BIT(digit) ((unsigned short)(1u << ((digit) - 1)))
+
+/**
+ * @brief Returns the number of set bits in a mask of up to 16 bits.
+ *  Without a hardware population count instruction a few shifts and adds beat the compiler's library call.
+ */
+static inline int CountBits(unsigned int mask)
+{
+#if defined(__GNUC__) && defined(__POPCNT__)
+    return __builtin_popcount(mask);
+#elif defined(_MSC_VER) && defined(__AVX__)
+    return (int)__popcnt(mask);
+#else
+    mask = mask - ((mask >> 1) & 0x5555);
+    mask = (mask & 0x3333) + ((mask >> 2) & 0x3333);
+    mask = (mask + (mask >> 4)) & 0x0F0F;
+    return (int)((mask + (mask >> 8)) & 0x1F);
+#endif
+}
+
+/**
+ * @brief Returns the index of the lowest set bit of a non zero mask.
+ */
+static inline int LowestBitIndex(unsigned int mask)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(mask);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (int)index;
+#else
+    int index = 0;
+    while (!(mask & 1u))
+    {
+        mask >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+/**
+ * @brief Returns the index of the highest set bit of a non zero 64-bit value.
+ */
+static inline int HighestBitIndex(unsigned long long value)
+{
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(value);
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return (int)index;
+#else
+    int index = 0;
+    while (value >>= 1)
+    {
+        ++index;
+    }
+    return index;
+#endif
+}
+
+/**
+ * @brief Returns the digit (1..9) represented by the lowest set bit of a candidate mask.
+ */
+static inline short LowestDigit(unsigned int mask)
+{
+    return (short)(LowestBitIndex(mask) + 1);
+}
+
+/**
+ * @brief Returns the digit represented by the n-th (0 based) set bit of a candidate mask.
+ */
+static inline short NthDigit(unsigned int mask, int n)
+{
+    while (n-- > 0)
+    {
+        mask &= mask - 1;
+    }
+    return LowestDigit(mask);
+}
+
+#endif /*__BITS_H__*/
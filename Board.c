@@ -2,188 +2,156 @@
     Author: Mordechai Ben Shimon
     Creation date :  21/01/23
     Description : This file contains functions that generate the initial board of a Sudoku game randomly.
-    The main function CreateSudokuBoard initializes all the cells on the board to -1, and creates a random board by using a linked list with all possible squares on the board.
-    The function generates a random number, N, between 8 and 21 and performs this operation N times.
-    It also generates a random number, K, between 1 and the size of the list (initially 81, but decreases as cells are removed).
-    The function reaches cell K in the list and takes the slot position (X, Y) from it.
-    Delete the cell from the list and places a random number in the cell that respects the possible value for this cell in the Sudoku game.
-    The function uses random number generation to select a valid value for the particular slot by creating an array of valid values for that slot,
-    then it picks an index from it and the value at that index is placed in the board. 
+    The main function CreateSudokuBoard asks "GenerateUniquePuzzle" for a puzzle of 22 to 28 clues within 100 ms.
+    The generator seeds an empty board with "CreateRandomBoard", completes it into a full grid with the solver,
+    then removes clues in a random order and keeps each removal only while the puzzle still has a single solution.
+    CreateRandomBoard shuffles the 81 slot positions of a fixed array with Fisher-Yates, generates a random number, N, between 8 and 21
+    and places a random digit in each of the first N slots of the shuffled array that respects the possible values for this slot in the Sudoku game.
+    If a slot is left without any possible value the seed is thrown away and drawn again.
+    All the random numbers come from the Random_t stream passed in, so the same stream always gives the same board.
 ***************************************************************************************/
 
 #include <stdio.h>
-#include <time.h>
 #include <stdlib.h>
+#include <string.h>
 
 
 #include "Errors.h"
 #include "Board.h"
 #include "Solver.h"
+#include "Bits.h"
+#include "Platform.h"
+#include "Metrics.h"
 
-struct SlotLocation 
-{
-    int x;
-    int y;
-    SlotLocation_t* next;
-    SlotLocation_t* prev;
-};
-
-struct SlotLocationlistManeger
-{
-    SlotLocation_t* head;
-    SlotLocation_t* tail;
-};
+#define GAME_MIN_CLUES 22
+#define GAME_MAX_CLUES 28
+#define GAME_BUDGET_NS 100000000ull
 
-struct Array
+Errors CreateSudokuBoard(signed char board[][SUDOKU_SIZE], Random_t* random)
 {
-    short* arr;
-    unsigned short size;
-};
+    GeneratorOptions_t options = { GAME_MIN_CLUES, GAME_MAX_CLUES, 0, (size_t)-1, GAME_BUDGET_NS };
+    Errors eErr;
+    METRIC_START(start);
 
+    eErr = GenerateUniquePuzzle(board, &options, random);
+    METRIC_STOP(METRIC_GENERATE_NS, start);
 
-Errors CreateSudokuBoard(short board[][SUDOKU_SIZE])
-{
-    SlotLocationlistManeger_t maneger = { NULL };
-
-    if (CreateSoltLocationLinkedList(&maneger, board) != ERR_OK)
-    {
-        return ERR_GENERAL;
-    }
-    if (CreateRandomBoard(&maneger, board) != ERR_OK)
-    {
-        return ERR_ALLOCATION_FAILED;
-    }
-
-    DestroySlotLocationList(maneger.head);
-
-    return ERR_OK;
+    // Running out of time still leaves a fair board, only with more clues than asked for
+    return eErr == ERR_NOT_FINISH ? ERR_OK : eErr;
 }
 
-Errors CreateSoltLocationLinkedList(SlotLocationlistManeger_t* maneger, short board[][SUDOKU_SIZE])
+Errors GenerateUniquePuzzle(signed char board[][SUDOKU_SIZE], const GeneratorOptions_t* options, Random_t* random)
 {
-    SlotLocation_t* item = NULL;
+    SolutionIterator_t iterator;
+    signed char grid[SUDOKU_SIZE][SUDOKU_SIZE], puzzle[SUDOKU_SIZE][SUDOKU_SIZE];
+    int order[SUDOKU_CELLS];
+    int clues = 0, target = 0, bestClues = SUDOKU_CELLS + 1, found = 0;
+    unsigned long long start = GetTimeNs();
 
-    for (size_t x = 0; x < SUDOKU_SIZE; x++)
+    while (1)
     {
-        for (size_t y = 0; y < SUDOKU_SIZE; y++)
+        // A few random digits that respect their peers are completed by the solver into a random full grid
+        if (CreateRandomBoard(grid, random) != ERR_OK)
+        {
+            continue;
+        }
+        InitSolutionIterator(&iterator, grid);
+        if (NextSolution(&iterator, grid))
         {
-            board[x][y] = -1;
-            item = CreateNewItem(x, y);
-            if (!item)
+            memcpy(puzzle, grid, sizeof(puzzle));
+            ShuffleSlots(order, random);
+            clues = SUDOKU_CELLS;
+            target = options->minClues + RandomBelow(random, options->maxClues - options->minClues + 1);
+
+            for (int i = 0; i < SUDOKU_CELLS && clues > target; i++)
             {
-                DestroySlotLocationList(maneger->head);
-                return ERR_ALLOCATION_FAILED;
+                int x = order[i] / SUDOKU_SIZE, y = order[i] % SUDOKU_SIZE;
+                short digit = puzzle[x][y];
+
+                // The clue can go if no solution puts another digit in its slot
+                puzzle[x][y] = -1;
+                InitSolutionIterator(&iterator, puzzle);
+                ExcludeSolutionDigit(&iterator, x, y, digit);
+                if (NextSolution(&iterator, NULL))
+                {
+                    puzzle[x][y] = digit;
+                }
+                else
+                {
+                    --clues;
+                }
             }
-            if (AddToEndSlotLocationList(maneger, item) != ERR_OK)
+
+            InitSolutionIterator(&iterator, puzzle);
+            NextSolution(&iterator, NULL);
+            if (clues <= options->maxClues &&
+                iterator.guesses >= options->minGuesses && iterator.guesses <= options->maxGuesses)
             {
-                DestroySlotLocationList(maneger->head);
-                return ERR_NOT_INITIALIZED;
+                memcpy(board, puzzle, sizeof(puzzle));
+                return ERR_OK;
+            }
+            if (clues < bestClues)
+            {
+                memcpy(board, puzzle, sizeof(puzzle));
+                bestClues = clues;
+                found = 1;
             }
         }
-    }
 
-    return ERR_OK;
-}
-
-SlotLocation_t* CreateNewItem(int x, int y)
-{
-    SlotLocation_t* item = NULL;
-
-    item = (SlotLocation_t*)malloc(sizeof(SlotLocation_t));
-    if (!item)
-    {
-        return NULL;
+        if (found && options->budgetNs && GetTimeNs() - start > options->budgetNs)
+        {
+            return ERR_NOT_FINISH;
+        }
     }
-    item->x = x;
-    item->y = y;
-    item->next = NULL;
-    item->prev = NULL;
-
-    return item;
 }
 
-Errors AddToEndSlotLocationList(SlotLocationlistManeger_t* maneger, SlotLocation_t* item)
+void ShuffleSlots(int order[], Random_t* random)
 {
-    if (! maneger || !item)
-    {
-        return ERR_NOT_INITIALIZED;
-    }
-    if (!maneger->head)
+    int j = 0, temp = 0;
+
+    for (int i = 0; i < SUDOKU_CELLS; i++)
     {
-        maneger->head = item;
-        maneger->tail = item;
+        order[i] = i;
     }
-    else
+    for (int i = SUDOKU_CELLS - 1; i > 0; i--)
     {
-        maneger->tail->next = item;
-        maneger->tail = item;
+        j = RandomBelow(random, i + 1);
+        temp = order[i];
+        order[i] = order[j];
+        order[j] = temp;
     }
-
-    return ERR_OK;
 }
 
-Errors CreateRandomBoard(SlotLocationlistManeger_t* maneger, short board[][SUDOKU_SIZE])
+Errors CreateRandomBoard(signed char board[][SUDOKU_SIZE], Random_t* random)
 {
-    int n = 0, k = 0, index = 0, sizeList = 81;
-    SlotLocation_t* curr = NULL, *prev = NULL;
-    Array_t* possibleValue = NULL;
+    int n = 0, x = 0, y = 0;
+    int order[SUDOKU_CELLS];
+    unsigned short possibleValue = 0;
+    Candidates_t possibilities;
 
-    srand(time(NULL));
+    for (int cell = 0; cell < SUDOKU_CELLS; cell++)
+    {
+        board[cell / SUDOKU_SIZE][cell % SUDOKU_SIZE] = -1;
+    }
+
+    // The candidates of every slot are computed once for the empty board and then kept up to date per digit
+    InitPossibleDigits(&possibilities, board);
+    ShuffleSlots(order, random);
 
-    n = (rand() % 13) + 8;
-    for (size_t i = 0; i < n; i++)
+    n = RandomBelow(random, 14) + 8;
+    for (int i = 0; i < n; i++)
     {
-        curr = maneger->head;
-        prev = NULL;
-        k = rand() % (sizeList - 1) + 1;
-        for (size_t j = 1; j < k; j++)
-        {
-            prev = curr;
-            curr = curr->next;
-        }
-        possibleValue =  CheckPossibleValuesForSlot(board, curr->x, curr->y);
+        x = order[i] / SUDOKU_SIZE;
+        y = order[i] % SUDOKU_SIZE;
+        possibleValue = possibilities.cell[order[i]];
         if (!possibleValue)
         {
-            return ERR_ALLOCATION_FAILED;
-        }
-
-        index = rand() % possibleValue->size;
-        board[curr->x][curr->y] = possibleValue->arr[index];
-        if (!prev)
-        {
-            maneger->head = curr->next;
-            maneger->head->prev = NULL;
-        }
-        else
-        {
-            prev->next = curr->next;
-            if (curr->next)
-            {
-                curr->next->prev = prev;
-            }
+            return ERR_NOT_FINISH;
         }
 
-        --sizeList;
-        free(curr);
-        free(possibleValue);
+        board[x][y] = NthDigit(possibleValue, RandomBelow(random, CountBits(possibleValue)));
+        UpdatingPossibleDigits(board, &possibilities, x, y);
     }
 
     return ERR_OK;
 }
-
-void DestroySlotLocationList(SlotLocation_t* head)
-{
-    SlotLocation_t* curr = NULL;
-
-    if (!head)
-    {
-        return;
-    }
-    while (head->next)
-    {
-        curr = head;
-        head = head->next;
-        free(curr);
-    }
-    free(head);
-}
\ No newline at end of file
@@ -2,64 +2,72 @@
     Author: Mordechai Ben Shimon
     Creation date :  21/01/23
     Description : This file contains functions that generate the initial board of a Sudoku game randomly.
-    The main function CreateSudokuBoard initializes all the cells on the board to -1, and creates a random board by using a linked list with all possible squares on the board.
-    The function generates a random number, N, between 8 and 21 and performs this operation N times.
-    It also generates a random number, K, between 1 and the size of the list (initially 81, but decreases as cells are removed).
-    The function reaches cell K in the list and takes the slot position (X, Y) from it.
-    Delete the cell from the list and places a random number in the cell that respects the possible value for this cell in the Sudoku game.
-    The function uses random number generation to select a valid value for the particular slot by creating an array of valid values for that slot,
-    then it picks an index from it and the value at that index is placed in the board.
+    The main function CreateSudokuBoard asks "GenerateUniquePuzzle" for a puzzle of 22 to 28 clues within 100 ms.
+    The generator seeds an empty board with "CreateRandomBoard", completes it into a full grid with the solver,
+    then removes clues in a random order and keeps each removal only while the puzzle still has a single solution.
+    CreateRandomBoard shuffles the 81 slot positions of a fixed array with Fisher-Yates, generates a random number, N, between 8 and 21
+    and places a random digit in each of the first N slots of the shuffled array that respects the possible values for this slot in the Sudoku game.
+    If a slot is left without any possible value the seed is thrown away and drawn again.
+    All the random numbers come from the Random_t stream passed in, so the same stream always gives the same board.
 ***************************************************************************************/
 
 #ifndef __BOARD_H__
 #define __BOARD_H__
 
-#define SUDOKU_SIZE 9
+#include <stddef.h>
 
-typedef struct SlotLocation SlotLocation_t;
-
-typedef struct SlotLocationlistManeger SlotLocationlistManeger_t;
+#include "Random.h"
+#include "Solver.h"
 
+typedef struct GeneratorOptions
+{
+    int minClues;                       /* the fewest filled slots a puzzle may keep */
+    int maxClues;                       /* the most filled slots a puzzle may keep */
+    size_t minGuesses;                  /* the solver must guess at least this many digits... */
+    size_t maxGuesses;                  /* ...and at most this many, to solve the puzzle */
+    unsigned long long budgetNs;        /* time allowed for one puzzle, 0 for no limit */
+} GeneratorOptions_t;
 
 /**
- * @brief generates a random Sudoku board and stores it in a 2D array. It returns an error code indicating success or failure.
+ * @brief generates a random Sudoku board that has exactly one solution and stores it in a 2D array. It returns an error code indicating success or failure.
  *
  * @param board: The Sudoku board that will be filled with values
+ * @param random: the random stream of the player
  *
  * @return An error code indicating the success or failure of the operation
  */
-Errors CreateSudokuBoard(short board[][SUDOKU_SIZE]);
-
-Errors CreateSoltLocationLinkedList(SlotLocationlistManeger_t* maneger, short board[][SUDOKU_SIZE]);
-
-SlotLocation_t* CreateNewItem(int x, int y);
+Errors CreateSudokuBoard(signed char board[][SUDOKU_SIZE], Random_t* random);
 
 /**
- * @brief Adds an item to the end of a slot location linked list
-
- * @param maneger: The slot location list manager
- * @param item: The item to add to the linked list
+ * @brief Generates a puzzle with exactly one solution. A random full grid is drawn and its clues are removed
+ *  in a random order, each removal is kept only if the solver proves the puzzle is still unique.
+ *  Grids are drawn again until the clue count and the number of solver guesses fall in the ranges of the options.
  *
- * @return An error code indicating the success or failure of the operation
+ * @param board: receives the puzzle, empty slots are -1.
+ * @param options: the clue count and difficulty ranges and the time budget.
+ * @param random: the random stream the grids and the removal order are drawn from.
+ *
+ * @return ERR_OK when the puzzle matches the options, ERR_NOT_FINISH when the budget ran out first (the board
+ *  then holds the closest unique puzzle found).
  */
-Errors AddToEndSlotLocationList(SlotLocationlistManeger_t* maneger, SlotLocation_t* item);
+Errors GenerateUniquePuzzle(signed char board[][SUDOKU_SIZE], const GeneratorOptions_t* options, Random_t* random);
 
 /**
- * @brief is a function that randomly places a set of values on a sudoku board by selecting available slots and filling them with possible values.
- * 
- * @param maneger:  a pointer to a SlotLocationlistManeger_t struct containing a linked list of available slots
- * @param board: a 2D array of short integers representing the sudoku board
- * 
- * @return an Errors enum value indicating success or failure
+ * @brief Shuffles the numbers 0..80 (slot x * 9 + y) into a random order with Fisher-Yates.
+ *
+ * @param order: receives the 81 slot numbers.
+ * @param random: the random stream.
  */
-Errors CreateRandomBoard(SlotLocationlistManeger_t* maneger, short board[][SUDOKU_SIZE]);
-
-void DestroySlotLocationList(SlotLocation_t* head);
-
-
-
-
-
+void ShuffleSlots(int order[], Random_t* random);
 
+/**
+ * @brief clears the board and places between 8 and 21 random digits on it, each respecting the digits already placed in its row, column and box.
+ *
+ * @param board: a 2D array of signed chars representing the sudoku board
+ * @param random: the random stream
+ *
+ * @return ERR_OK, or ERR_NOT_FINISH if a chosen slot was left without any possible value and the board must be drawn again
+ */
+Errors CreateRandomBoard(signed char board[][SUDOKU_SIZE], Random_t* random);
 
 #endif /*__BOARD_H__*/
\ No newline at end of file
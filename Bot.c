@@ -0,0 +1,87 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  Automated players. The lookahead bot tries a candidate on a copy of the game:
+    the copy is 432 bytes and the forced fills of the next "BeginTurn" are what would expose a contradiction,
+    so a look costs about as much as one turn of a player.
+***************************************************************************************/
+
+#include <string.h>
+
+#include "Errors.h"
+#include "Bot.h"
+#include "Bits.h"
+
+BotStrategy GetBotStrategy(const char* name)
+{
+    if (strcmp(name, "random") == 0)
+    {
+        return BOT_RANDOM;
+    }
+    if (strcmp(name, "first") == 0)
+    {
+        return BOT_FIRST;
+    }
+    if (strcmp(name, "lookahead") == 0)
+    {
+        return BOT_LOOKAHEAD;
+    }
+
+    return BOT_HUMAN;
+}
+
+/**
+ * @brief Returns the candidates of a prompt that do not make the board illegal once the forced slots are filled.
+ */
+static unsigned short SafeCandidates(const GameState_t* game, const TurnPrompt_t* prompt)
+{
+    GameState_t copy;
+    TurnPrompt_t next;
+    unsigned short safe = 0;
+    Errors eErr;
+
+    for (unsigned short candidates = prompt->candidates; candidates; candidates &= candidates - 1)
+    {
+        copy = *game;
+        eErr = SubmitMove(&copy, LowestDigit(candidates));
+        if (eErr == ERR_OK)
+        {
+            eErr = BeginTurn(&copy, &next);
+        }
+        if (eErr != ERR_FINISH_FAILURE)
+        {
+            safe |= candidates & (unsigned short)-candidates;
+        }
+    }
+
+    return safe;
+}
+
+short ChooseBotMove(BotStrategy strategy, const GameState_t* game, const TurnPrompt_t* prompt, Random_t* random)
+{
+    unsigned short candidates = prompt->candidates;
+    unsigned short safe = 0;
+
+    if (!candidates)
+    {
+        return 1;
+    }
+
+    switch (strategy)
+    {
+    case BOT_FIRST:
+        return LowestDigit(candidates);
+    case BOT_LOOKAHEAD:
+        // When every candidate fails the bot still has to play one
+        safe = SafeCandidates(game, prompt);
+        if (safe)
+        {
+            candidates = safe;
+        }
+        break;
+    default:
+        break;
+    }
+
+    return NthDigit(candidates, (int)RandomBelow(random, (unsigned int)CountBits(candidates)));
+}
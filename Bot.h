@@ -0,0 +1,41 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  Automated players. A bot answers the prompt of "BeginTurn" with a digit of its own instead of
+    reading one from the console, so whole games can be played without anyone at the keyboard.
+    A random bot picks any candidate of the slot, a first candidate bot picks the lowest one and a lookahead bot
+    plays every candidate on a copy of the game and only picks one that does not lead straight to an illegal board.
+***************************************************************************************/
+
+#ifndef __BOT_H__
+#define __BOT_H__
+
+#include "Game.h"
+#include "Random.h"
+
+typedef enum
+{
+    BOT_HUMAN,                          /* not a bot, the moves are read from the console */
+    BOT_RANDOM,
+    BOT_FIRST,
+    BOT_LOOKAHEAD
+} BotStrategy;
+
+/**
+ * @brief Returns the strategy with the given name ("random", "first" or "lookahead"), BOT_HUMAN for any other name.
+ */
+BotStrategy GetBotStrategy(const char* name);
+
+/**
+ * @brief Picks the digit a bot plays for a prompt.
+ *
+ * @param strategy: the strategy of the bot, not BOT_HUMAN.
+ * @param game: the game the prompt belongs to, it is not changed.
+ * @param prompt: the prompt "BeginTurn" returned.
+ * @param random: the random stream of the bot.
+ *
+ * @return the digit, 1 to 9.
+ */
+short ChooseBotMove(BotStrategy strategy, const GameState_t* game, const TurnPrompt_t* prompt, Random_t* random);
+
+#endif /*__BOT_H__*/
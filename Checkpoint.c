@@ -0,0 +1,358 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  The binary checkpoint of a tournament: packing the boards and the candidates of the player records,
+    checking a mapped checkpoint, and the writer. The writer has two buffers: the game copies a checkpoint into the one
+    the thread is not writing and hands it over under the lock, the thread seals it with its checksum and replaces
+    the checkpoint file with it, so the game holds the lock only to swap the buffers.
+***************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "Errors.h"
+#include "Checkpoint.h"
+#include "Platform.h"
+
+#define FNV_OFFSET_BASIS 0xCBF29CE484222325ull
+#define FNV_PRIME 0x100000001B3ull
+#define CANDIDATE_BITS 9
+#define CANDIDATE_MASK ((1u << CANDIDATE_BITS) - 1)
+#define CANDIDATE_GROUP 8                   /* masks packed into CANDIDATE_BITS bytes at a time */
+
+struct CheckpointWriter
+{
+    const char* path;
+    char* buffers[2];
+    Thread_t* thread;
+    Lock_t* lock;                       /* protects everything below */
+    Condition_t* pendingReady;
+    size_t sizes[2];
+    size_t kept[2];                     /* the winners each buffer holds */
+    int filling;                        /* the buffer BeginCheckpoint handed out */
+    int pending;                        /* the buffer waiting for the thread, -1 if none is */
+    int writing;                        /* the buffer the thread is writing, -1 if none is */
+    int stopping;
+    CheckpointStats_t stats;
+};
+
+size_t CheckpointSize(size_t winners, size_t live)
+{
+    return sizeof(CheckpointHeader_t) + winners * sizeof(CheckpointWinner_t) + live * sizeof(CheckpointPlayer_t);
+}
+
+void PackCheckpointBoard(CheckpointPlayer_t* record, signed char board[][SUDOKU_SIZE])
+{
+    const signed char* cells = &board[0][0];
+    int low = 0, high = 0;
+
+    // An empty slot is -1, and -1 masked with its own sign is 0: no branch per slot
+    for (int i = 0; i + 1 < SUDOKU_CELLS; i += 2)
+    {
+        low = cells[i] & ~(cells[i] >> 7);
+        high = cells[i + 1] & ~(cells[i + 1] >> 7);
+        record->board[i / 2] = (unsigned char)(low | high << 4);
+    }
+    record->board[SUDOKU_CELLS / 2] = (unsigned char)(cells[SUDOKU_CELLS - 1] & ~(cells[SUDOKU_CELLS - 1] >> 7));
+}
+
+void UnpackCheckpointBoard(const CheckpointPlayer_t* record, signed char board[][SUDOKU_SIZE])
+{
+    signed char* cells = &board[0][0];
+    unsigned char digit = 0;
+
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        digit = (record->board[i / 2] >> (4 * (i & 1))) & 0xF;
+        cells[i] = digit ? (signed char)digit : -1;
+    }
+}
+
+void PackCheckpointCandidates(CheckpointPlayer_t* record, const unsigned short* candidates)
+{
+    unsigned char* bytes = record->candidates;
+    unsigned long long bits = 0;
+    int i = 0;
+
+    // 8 masks are 72 bits, exactly 9 bytes: the first 7 and the low bit of the 8th fill a word, the 8th gives the last byte
+    for (; i + CANDIDATE_GROUP <= SUDOKU_CELLS; i += CANDIDATE_GROUP, bytes += CANDIDATE_BITS)
+    {
+        bits = 0;
+        for (int k = 0; k < CANDIDATE_GROUP - 1; k++)
+        {
+            bits |= (unsigned long long)(candidates[i + k] & CANDIDATE_MASK) << (CANDIDATE_BITS * k);
+        }
+        bits |= (unsigned long long)(candidates[i + CANDIDATE_GROUP - 1] & 1) << 63;
+        for (int k = 0; k < 8; k++)
+        {
+            bytes[k] = (unsigned char)(bits >> (8 * k));
+        }
+        bytes[8] = (unsigned char)((candidates[i + CANDIDATE_GROUP - 1] & CANDIDATE_MASK) >> 1);
+    }
+    // The last slot of the board
+    bytes[0] = (unsigned char)candidates[i];
+    bytes[1] = (unsigned char)((candidates[i] & CANDIDATE_MASK) >> 8);
+}
+
+void UnpackCheckpointCandidates(const CheckpointPlayer_t* record, unsigned short* candidates)
+{
+    const unsigned char* bytes = record->candidates;
+    unsigned long long bits = 0;
+    int i = 0;
+
+    for (; i + CANDIDATE_GROUP <= SUDOKU_CELLS; i += CANDIDATE_GROUP, bytes += CANDIDATE_BITS)
+    {
+        bits = 0;
+        for (int k = 0; k < 8; k++)
+        {
+            bits |= (unsigned long long)bytes[k] << (8 * k);
+        }
+        for (int k = 0; k < CANDIDATE_GROUP - 1; k++)
+        {
+            candidates[i + k] = (unsigned short)((bits >> (CANDIDATE_BITS * k)) & CANDIDATE_MASK);
+        }
+        candidates[i + CANDIDATE_GROUP - 1] = (unsigned short)(bits >> 63 | (unsigned int)bytes[8] << 1);
+    }
+    candidates[i] = (unsigned short)((bytes[0] | bytes[1] << 8) & CANDIDATE_MASK);
+}
+
+Errors CheckCheckpointRecord(const CheckpointPlayer_t* record)
+{
+    // The last byte of the board holds one slot, its high nibble is unused
+    if (record->board[CHECKPOINT_BOARD_BYTES - 1] > SUDOKU_SIZE || record->cell >= SUDOKU_CELLS || record->prompted > 1 ||
+        record->moves > SUDOKU_CELLS)
+    {
+        return ERR_ILLEGAL;
+    }
+    for (int i = 0; i < CHECKPOINT_BOARD_BYTES - 1; i++)
+    {
+        if ((record->board[i] & 0xF) > SUDOKU_SIZE || (record->board[i] >> 4) > SUDOKU_SIZE)
+        {
+            return ERR_ILLEGAL;
+        }
+    }
+
+    return ERR_OK;
+}
+
+/**
+ * @brief Goes on with the FNV-1a hash of a block, taken 8 bytes at a time so a large checkpoint is hashed at memory speed.
+ */
+static unsigned long long Checksum(unsigned long long hash, const char* data, size_t size)
+{
+    unsigned long long word = 0;
+    size_t i = 0;
+
+    for (; i + sizeof(word) <= size; i += sizeof(word))
+    {
+        memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * FNV_PRIME;
+    }
+    for (; i < size; i++)
+    {
+        hash = (hash ^ (unsigned char)data[i]) * FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Returns the checksum of a whole checkpoint, its header included with the checksum taken as 0.
+ */
+static unsigned long long ChecksumCheckpoint(const char* checkpoint, size_t size)
+{
+    CheckpointHeader_t header;
+
+    memcpy(&header, checkpoint, sizeof(header));
+    header.checksum = 0;
+
+    return Checksum(Checksum(FNV_OFFSET_BASIS, (const char*)&header, sizeof(header)), checkpoint + sizeof(header), size - sizeof(header));
+}
+
+/**
+ * @brief Fills in the parts of the header the game leaves to the thread.
+ */
+static void SealCheckpoint(char* checkpoint, size_t size)
+{
+    CheckpointHeader_t* header = (CheckpointHeader_t*)checkpoint;
+
+    memcpy(header->magic, CHECKPOINT_MAGIC, sizeof(header->magic));
+    header->version = CHECKPOINT_VERSION;
+    header->byteOrder = CHECKPOINT_BYTE_ORDER;
+    header->checksum = ChecksumCheckpoint(checkpoint, size);
+}
+
+const CheckpointHeader_t* OpenCheckpoint(const char* path, MappedFile_t* file)
+{
+    const CheckpointHeader_t* header = NULL;
+
+    if (MapFile(path, file) != ERR_OK)
+    {
+        return NULL;
+    }
+    header = (const CheckpointHeader_t*)file->data;
+
+    // The counts are checked one at a time so a damaged header cannot overflow the expected size
+    if (file->size < sizeof(CheckpointHeader_t) || memcmp(header->magic, CHECKPOINT_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != CHECKPOINT_VERSION || header->byteOrder != CHECKPOINT_BYTE_ORDER ||
+        header->live > header->created || header->winners > header->created - header->live ||
+        file->size != CheckpointSize((size_t)header->winners, (size_t)header->live) ||
+        header->checksum != ChecksumCheckpoint(file->data, file->size))
+    {
+        UnmapFile(file);
+        return NULL;
+    }
+
+    return header;
+}
+
+/**
+ * @brief The thread of a writer: writes every checkpoint handed to it until the writer stops and nothing is pending.
+ */
+static void CheckpointWriterLoop(void* arg)
+{
+    CheckpointWriter_t* writer = (CheckpointWriter_t*)arg;
+    unsigned long long start = 0;
+    int buffer = 0;
+    Errors eErr;
+
+    AcquireLock(writer->lock);
+    while (1)
+    {
+        while (writer->pending < 0 && !writer->stopping)
+        {
+            WaitCondition(writer->pendingReady, writer->lock);
+        }
+        if (writer->pending < 0)
+        {
+            break;
+        }
+        buffer = writer->writing = writer->pending;
+        writer->pending = -1;
+        ReleaseLock(writer->lock);
+
+        start = GetTimeNs();
+        SealCheckpoint(writer->buffers[buffer], writer->sizes[buffer]);
+        eErr = ReplaceFileContents(writer->path, writer->buffers[buffer], writer->sizes[buffer]);
+
+        AcquireLock(writer->lock);
+        writer->writing = -1;
+        writer->stats.writeNs += GetTimeNs() - start;
+        if (eErr == ERR_OK)
+        {
+            ++writer->stats.written;
+            writer->stats.lastSize = writer->sizes[buffer];
+        }
+        else
+        {
+            ++writer->stats.failed;
+        }
+    }
+    ReleaseLock(writer->lock);
+}
+
+CheckpointWriter_t* CreateCheckpointWriter(const char* path, size_t capacity)
+{
+    CheckpointWriter_t* writer = NULL;
+
+    writer = (CheckpointWriter_t*)AllocateZeroed(1, sizeof(CheckpointWriter_t));
+    if (!writer)
+    {
+        return NULL;
+    }
+    writer->path = path;
+    writer->pending = writer->writing = -1;
+    writer->buffers[0] = (char*)AllocateAligned(CACHE_LINE_SIZE, capacity);
+    writer->buffers[1] = (char*)AllocateAligned(CACHE_LINE_SIZE, capacity);
+    writer->lock = CreateLock();
+    writer->pendingReady = CreateCondition();
+    if (writer->buffers[0] && writer->buffers[1] && writer->lock && writer->pendingReady)
+    {
+        // Touched now, so the first checkpoints do not stop the game on a page fault for every page they copy
+        memset(writer->buffers[0], 0, capacity);
+        memset(writer->buffers[1], 0, capacity);
+        writer->thread = StartThread(CheckpointWriterLoop, writer);
+    }
+    if (!writer->thread)
+    {
+        DestroyCheckpointWriter(writer);
+        return NULL;
+    }
+
+    return writer;
+}
+
+void* BeginCheckpoint(CheckpointWriter_t* writer, size_t* kept)
+{
+    AcquireLock(writer->lock);
+    if (writer->writing >= 0)
+    {
+        writer->filling = 1 - writer->writing;
+    }
+    else
+    {
+        writer->filling = writer->pending == 0 ? 1 : 0;
+    }
+    // The thread is busy with the other buffer, what waits in this one is older than what is about to be copied
+    if (writer->pending == writer->filling)
+    {
+        writer->pending = -1;
+        ++writer->stats.dropped;
+    }
+    *kept = writer->kept[writer->filling];
+    ReleaseLock(writer->lock);
+
+    return writer->buffers[writer->filling];
+}
+
+void CommitCheckpoint(CheckpointWriter_t* writer, size_t size, size_t kept, unsigned long long copyNs)
+{
+    AcquireLock(writer->lock);
+    if (writer->pending >= 0)
+    {
+        ++writer->stats.dropped;
+    }
+    writer->sizes[writer->filling] = size;
+    writer->kept[writer->filling] = kept;
+    writer->pending = writer->filling;
+    writer->stats.copyNs += copyNs;
+    SignalCondition(writer->pendingReady);
+    ReleaseLock(writer->lock);
+}
+
+void StopCheckpointWriter(CheckpointWriter_t* writer, CheckpointStats_t* stats)
+{
+    if (writer->thread)
+    {
+        AcquireLock(writer->lock);
+        writer->stopping = 1;
+        SignalCondition(writer->pendingReady);
+        ReleaseLock(writer->lock);
+        JoinThread(writer->thread);
+        writer->thread = NULL;
+    }
+    if (stats)
+    {
+        *stats = writer->stats;
+    }
+}
+
+void DestroyCheckpointWriter(CheckpointWriter_t* writer)
+{
+    if (!writer)
+    {
+        return;
+    }
+    StopCheckpointWriter(writer, NULL);
+    if (writer->pendingReady)
+    {
+        DestroyCondition(writer->pendingReady);
+    }
+    if (writer->lock)
+    {
+        DestroyLock(writer->lock);
+    }
+    FreeAligned(writer->buffers[0]);
+    FreeAligned(writer->buffers[1]);
+    free(writer);
+}
@@ -0,0 +1,155 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  The binary checkpoint of a tournament, so a tournament that was stopped goes on from its last checkpoint
+    instead of being dealt again. A checkpoint is one block laid out in the order it is written: the header, the winners
+    in finishing order with their scores, then the players still playing in the order they play every round.
+    Every player is a record of the same size with the board at 4 bits a slot and the candidates at 9 bits a slot,
+    so a record is found by its index in the mapped file and unpacked in place, nothing is parsed.
+    The numbers are stored in the byte order of the machine, which the header records.
+    A checkpoint writer owns a thread that writes the checkpoints to the disk, the game only copies its state into a
+    buffer of the writer between two rounds and never waits for the disk. A winner's record never changes and the
+    winners only grow, so a buffer keeps the winners it already holds and a checkpoint only copies the new ones.
+***************************************************************************************/
+
+#ifndef __CHECKPOINT_H__
+#define __CHECKPOINT_H__
+
+#include <stddef.h>
+
+#include "Platform.h"
+#include "Solver.h"
+
+#define CHECKPOINT_MAGIC "SUDOKUCP"         /* the first 8 bytes of a checkpoint, the terminator is not stored */
+#define CHECKPOINT_VERSION 3
+#define CHECKPOINT_BYTE_ORDER 0x01020304u
+#define CHECKPOINT_BOARD_BYTES ((SUDOKU_SIZE * SUDOKU_SIZE * 4 + 7) / 8)
+#define CHECKPOINT_CANDIDATE_BYTES ((SUDOKU_SIZE * SUDOKU_SIZE * SUDOKU_SIZE + 7) / 8)
+
+typedef struct CheckpointHeader
+{
+    char magic[8];
+    unsigned int version;
+    unsigned int byteOrder;             /* CHECKPOINT_BYTE_ORDER as the machine that wrote the checkpoint stores it */
+    unsigned int strategy;              /* the BotStrategy of the players */
+    unsigned int round;                 /* the last round played, the next one is round + 1 */
+    unsigned long long created;         /* players the tournament started with */
+    unsigned long long winners;         /* records of the winners */
+    unsigned long long live;            /* records of the players still playing */
+    unsigned long long moves;           /* moves submitted so far */
+    unsigned long long random[4];       /* the state of the stream the bots draw from */
+    unsigned long long checksum;        /* FNV-1a of the whole checkpoint, this field taken as 0 */
+} CheckpointHeader_t;
+
+typedef struct CheckpointPlayer
+{
+    unsigned int index;                 /* the place of the player in the order they were created, which names a bot */
+    unsigned int dirty;                 /* the units the next propagation looks at */
+    unsigned char board[CHECKPOINT_BOARD_BYTES];            /* two slots a byte, the digit or 0 for an empty slot */
+    unsigned char candidates[CHECKPOINT_CANDIDATE_BYTES];   /* 9 bits a slot, bit (d - 1) for digit d */
+    unsigned char moves;
+    unsigned char cell;
+    unsigned char prompted;
+    unsigned char conflicts;
+    unsigned char reserved[3];
+} CheckpointPlayer_t;
+
+typedef struct CheckpointWinner
+{
+    CheckpointPlayer_t player;
+    unsigned int round;                 /* the score of the winner, as LeaderboardScore_t */
+    unsigned int moves;
+} CheckpointWinner_t;
+
+typedef struct CheckpointWriter CheckpointWriter_t;
+
+typedef struct CheckpointStats
+{
+    size_t written;                     /* checkpoints on the disk */
+    size_t dropped;                     /* checkpoints replaced by a newer one before the thread got to them */
+    size_t failed;                      /* checkpoints that could not be written */
+    size_t lastSize;                    /* the bytes of the last checkpoint written */
+    unsigned long long copyNs;          /* the time the game spent copying its state, the only part it waits for */
+    unsigned long long writeNs;         /* the time the thread spent writing */
+} CheckpointStats_t;
+
+
+/**
+ * @brief Returns the size of a checkpoint of 'winners' winners and 'live' players still playing.
+ */
+size_t CheckpointSize(size_t winners, size_t live);
+
+/**
+ * @brief Packs a board into a record, empty slots are -1 on the board.
+ */
+void PackCheckpointBoard(CheckpointPlayer_t* record, signed char board[][SUDOKU_SIZE]);
+
+void UnpackCheckpointBoard(const CheckpointPlayer_t* record, signed char board[][SUDOKU_SIZE]);
+
+/**
+ * @brief Packs the candidate masks of the 81 slots into a record.
+ */
+void PackCheckpointCandidates(CheckpointPlayer_t* record, const unsigned short* candidates);
+
+void UnpackCheckpointCandidates(const CheckpointPlayer_t* record, unsigned short* candidates);
+
+/**
+ * @brief Checks the fields of a record the checksum cannot vouch for: every slot of the board is empty or a digit,
+ *  the slot of the prompt is on the board and the move count fits it. The index is left to the caller.
+ *
+ * @return ERR_OK, or ERR_ILLEGAL if the record cannot be taken back.
+ */
+Errors CheckCheckpointRecord(const CheckpointPlayer_t* record);
+
+/**
+ * @brief Maps a checkpoint and checks it against its header.
+ *
+ * @param path: the checkpoint file.
+ * @param file: receives the mapping, to be released with UnmapFile.
+ *
+ * @return the header, the records follow it. NULL if the file cannot be mapped, is not a checkpoint of this version
+ *  and byte order, is cut short or does not match its checksum, the file is then unmapped.
+ */
+const CheckpointHeader_t* OpenCheckpoint(const char* path, MappedFile_t* file);
+
+/**
+ * @brief Creates a checkpoint writer and starts its thread.
+ *
+ * @param path: the file every checkpoint replaces.
+ * @param capacity: the size of the largest checkpoint, both buffers of the writer are allocated now.
+ *
+ * @return the writer, or NULL if it could not be created.
+ */
+CheckpointWriter_t* CreateCheckpointWriter(const char* path, size_t capacity);
+
+/**
+ * @brief Returns the buffer the next checkpoint is copied into, it is never the one the thread is writing.
+ *  A checkpoint that is still waiting for the thread is dropped for the new one.
+ *
+ * @param writer: the writer.
+ * @param kept: receives the winners at the start of the buffer that are still there from the last checkpoint copied into it.
+ */
+void* BeginCheckpoint(CheckpointWriter_t* writer, size_t* kept);
+
+/**
+ * @brief Hands the checkpoint copied into the buffer of BeginCheckpoint to the thread, which fills in the magic,
+ *  the version, the byte order and the checksum of the header before writing it.
+ *
+ * @param writer: the writer.
+ * @param size: the bytes of the checkpoint.
+ * @param kept: the winners the buffer holds, the next checkpoint copied into it keeps them.
+ * @param copyNs: how long the copy took.
+ */
+void CommitCheckpoint(CheckpointWriter_t* writer, size_t size, size_t kept, unsigned long long copyNs);
+
+/**
+ * @brief Writes the checkpoint that is still waiting, stops the thread and returns the results of the writer.
+ */
+void StopCheckpointWriter(CheckpointWriter_t* writer, CheckpointStats_t* stats);
+
+/**
+ * @brief Stops the writer if it was not stopped and frees it.
+ */
+void DestroyCheckpointWriter(CheckpointWriter_t* writer);
+
+#endif /*__CHECKPOINT_H__*/
@@ -12,21 +12,22 @@ const char* ErrDescription[] =
 {
     /* General Errors - Description */
 
+    "OK",
     "Finish success",
     "Finish failure",
     "Not finish",
-     "OK",
     "General Error",
     "Initialization error",
     "Allocation error",
-    "Wrong index"
+    "Wrong index",
+    "Illegal"
 };
 
 void HandleErr(Errors errNum, char* msg)
 {
     if (errNum)
     {
-        printf("ErrNum=%d, ErrDescription=%s, msg=%s\n",
+        fprintf(stderr, "ErrNum=%d, ErrDescription=%s, msg=%s\n",
             errNum, ErrDescription[errNum], msg);
     }
 
@@ -0,0 +1,67 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  The game of one player as a resumable state machine. The state between two calls is the
+    board, its candidate block, the slot of the pending prompt and the moves submitted so far, so a turn can be suspended for as long as
+    the driver needs to get the digit without any thread waiting for it.
+***************************************************************************************/
+
+#include <stdlib.h>
+
+#include "Errors.h"
+#include "Game.h"
+
+void InitGameState(GameState_t* game)
+{
+    InitPossibleDigits(&game->possibilities, game->board);
+    game->moves = 0;
+    game->cell = 0;
+    game->prompted = 0;
+}
+
+Errors BeginTurn(GameState_t* game, TurnPrompt_t* prompt)
+{
+    Errors eErr;
+    int x = 0, y = 0;
+
+    if (!game->prompted)
+    {
+        eErr = OneStage(game->board, &game->possibilities, &x, &y);
+        if (eErr != ERR_NOT_FINISH)
+        {
+            return eErr;
+        }
+        game->cell = (unsigned char)CELL_OF(x, y);
+        game->prompted = 1;
+    }
+
+    prompt->x = game->cell / SUDOKU_SIZE;
+    prompt->y = game->cell % SUDOKU_SIZE;
+    prompt->candidates = game->possibilities.cell[game->cell];
+
+    return ERR_NOT_FINISH;
+}
+
+Errors SubmitMove(GameState_t* game, short digit)
+{
+    Errors eErr;
+
+    if (!game->prompted)
+    {
+        return ERR_NOT_INITIALIZED;
+    }
+
+    eErr = PlaceNumber(game->board, &game->possibilities, game->cell / SUDOKU_SIZE, game->cell % SUDOKU_SIZE, digit);
+    if (eErr != ERR_WRONG_INDEX)
+    {
+        game->prompted = 0;
+        ++game->moves;
+    }
+
+    return eErr;
+}
+
+unsigned int GetGameMoves(const GameState_t* game)
+{
+    return game->moves;
+}
@@ -0,0 +1,66 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  The game of one player as a resumable state machine, with no input or output of its own.
+    "BeginTurn" fills the slots that have a single option and either ends the game or returns a prompt:
+    the slot with the fewest options and its candidates. "SubmitMove" answers the pending prompt with a digit.
+    Between the two calls nothing waits, so one driver can interleave any number of games and take the digits
+    from any source: the console, a socket or a bot.
+***************************************************************************************/
+
+#ifndef __GAME_H__
+#define __GAME_H__
+
+#include "Solver.h"
+
+/* The state of one game, the candidate block first so it starts on the line the game is aligned on.
+   It takes 432 bytes, so with a pointer or two next to it it still fits 7 cache lines */
+typedef struct GameState
+{
+    Candidates_t possibilities;
+    signed char board[SUDOKU_SIZE][SUDOKU_SIZE];
+    unsigned char moves;                /* digits the player submitted, the forced fills of BeginTurn not included */
+    unsigned char cell;                 /* the slot of the pending prompt, CELL_OF(x, y) */
+    unsigned char prompted;             /* a prompt is waiting for SubmitMove */
+} GameState_t;
+
+typedef struct TurnPrompt
+{
+    int x;
+    int y;
+    unsigned short candidates;          /* candidate mask of the slot, bit (d - 1) for digit d */
+} TurnPrompt_t;
+
+
+/**
+ * @brief Starts a game on the board already written to game->board.
+ */
+void InitGameState(GameState_t* game);
+
+/**
+ * @brief Plays the forced part of a turn and asks for a move. Calling it again before SubmitMove returns the same prompt.
+ *
+ * @param game: the game.
+ * @param prompt: receives the slot and its candidates when a move is needed.
+ *
+ * @return ERR_NOT_FINISH with a prompt, ERR_FINISH_SUCCESS if the board is solved or ERR_FINISH_FAILURE if it is illegal.
+ */
+Errors BeginTurn(GameState_t* game, TurnPrompt_t* prompt);
+
+/**
+ * @brief Answers the pending prompt of a game.
+ *
+ * @param game: the game.
+ * @param digit: the digit for the slot of the prompt, it does not have to be one of the candidates.
+ *
+ * @return ERR_OK when the game goes on with the next BeginTurn, ERR_FINISH_SUCCESS or ERR_FINISH_FAILURE when it ended,
+ *         ERR_WRONG_INDEX if the digit is not between 1 and 9 (the prompt stays) or ERR_NOT_INITIALIZED without a prompt.
+ */
+Errors SubmitMove(GameState_t* game, short digit);
+
+/**
+ * @brief Returns the number of digits the player submitted so far, the slots BeginTurn filled on its own are not counted.
+ */
+unsigned int GetGameMoves(const GameState_t* game);
+
+#endif /*__GAME_H__*/
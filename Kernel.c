@@ -0,0 +1,340 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  This file contains the whole board candidate kernel.
+    The "ComputeBoardMasks" function computes the occupancy masks of the 9 rows, 9 columns and 9 squares of a board
+    and the candidate masks of its 81 slots at once, instead of scanning the peers of every slot one by one.
+    On x86 processors the kernel runs on AVX2 when the processor supports it (checked once at start up, before any thread
+    is started, so the threads only ever read the kernel) and on SSE2 otherwise,
+    other processors use the portable scalar version.
+    Every version loads the first 8 slots of a row as one vector and handles the 9th slot with scalar code.
+***************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "Errors.h"
+#include "Solver.h"
+#include "Kernel.h"
+#include "Bits.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define KERNEL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(KERNEL_X86) && (defined(__GNUC__) || defined(__clang__))
+#define KERNEL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define KERNEL_TARGET(isa)
+#endif
+
+typedef void (*BoardKernel_t)(signed char board[][SUDOKU_SIZE], Candidates_t* possibilities);
+
+/**
+ * @brief Counts the digits placed more than once in some unit, from the full slots counter and the unit masks.
+ */
+static unsigned char CountConflicts(const Candidates_t* possibilities)
+{
+    int rowDigits = 0, colDigits = 0, boxDigits = 0;
+
+    for (int i = 0; i < SUDOKU_SIZE; i++)
+    {
+        rowDigits += CountBits(possibilities->row[i]);
+        colDigits += CountBits(possibilities->col[i]);
+        boxDigits += CountBits(possibilities->box[i]);
+    }
+
+    return (unsigned char)(3 * possibilities->filled - rowDigits - colDigits - boxDigits);
+}
+
+static void ComputeBoardMasksScalar(signed char board[][SUDOKU_SIZE], Candidates_t* possibilities)
+{
+    unsigned short bit = 0;
+    int box = 0;
+
+    possibilities->filled = 0;
+    for (int i = 0; i < SUDOKU_SIZE; i++)
+    {
+        possibilities->row[i] = possibilities->col[i] = possibilities->box[i] = 0;
+    }
+
+    for (int x = 0; x < SUDOKU_SIZE; x++)
+    {
+        for (int y = 0; y < SUDOKU_SIZE; y++)
+        {
+            if (board[x][y] == -1)
+            {
+                continue;
+            }
+            bit = DIGIT_TO_BIT(board[x][y]);
+            box = BOX_OF(x, y);
+            possibilities->row[x] |= bit;
+            possibilities->col[y] |= bit;
+            possibilities->box[box] |= bit;
+            ++possibilities->filled;
+        }
+    }
+
+    for (int x = 0; x < SUDOKU_SIZE; x++)
+    {
+        for (int y = 0; y < SUDOKU_SIZE; y++)
+        {
+            possibilities->cell[CELL_OF(x, y)] = board[x][y] != -1 ? 0 :
+                ~(possibilities->row[x] | possibilities->col[y] | possibilities->box[BOX_OF(x, y)]) & ALL_DIGITS_MASK;
+        }
+    }
+}
+
+#ifdef KERNEL_X86
+
+/**
+ * @brief Returns the bit of the 9th slot of a row, 0 when it is empty.
+ */
+static inline unsigned short LastSlotBit(const signed char* row)
+{
+    return row[SUDOKU_SIZE - 1] > 0 ? DIGIT_TO_BIT(row[SUDOKU_SIZE - 1]) : 0;
+}
+
+/**
+ * @brief Finishes the masks common to both vector kernels once the 8 wide column bits and the 9th slot bits are known.
+ */
+static void StoreUnitMasks(Candidates_t* possibilities, const unsigned short* colLanes, const unsigned short* bandLanes,
+    const unsigned short* lastBits)
+{
+    unsigned short lastCol = 0;
+
+    for (int y = 0; y < SUDOKU_SIZE - 1; y++)
+    {
+        possibilities->col[y] = colLanes[y];
+    }
+    for (int x = 0; x < SUDOKU_SIZE; x++)
+    {
+        lastCol |= lastBits[x];
+    }
+    possibilities->col[SUDOKU_SIZE - 1] = lastCol;
+
+    for (int band = 0; band < 3; band++)
+    {
+        const unsigned short* lanes = bandLanes + band * 8;
+
+        possibilities->box[band * 3] = lanes[0] | lanes[1] | lanes[2];
+        possibilities->box[band * 3 + 1] = lanes[3] | lanes[4] | lanes[5];
+        possibilities->box[band * 3 + 2] = lanes[6] | lanes[7] |
+            lastBits[band * 3] | lastBits[band * 3 + 1] | lastBits[band * 3 + 2];
+    }
+}
+
+KERNEL_TARGET("sse2")
+static inline unsigned short HorizontalOr16(__m128i lanes)
+{
+    lanes = _mm_or_si128(lanes, _mm_shuffle_epi32(lanes, _MM_SHUFFLE(1, 0, 3, 2)));
+    lanes = _mm_or_si128(lanes, _mm_shuffle_epi32(lanes, _MM_SHUFFLE(2, 3, 0, 1)));
+    lanes = _mm_or_si128(lanes, _mm_srli_epi32(lanes, 16));
+
+    return (unsigned short)_mm_cvtsi128_si32(lanes);
+}
+
+KERNEL_TARGET("sse2")
+static void ComputeBoardMasksSse2(signed char board[][SUDOKU_SIZE], Candidates_t* possibilities)
+{
+    const signed char* cells = &board[0][0];
+    __m128i bits[SUDOKU_SIZE], colBits = _mm_setzero_si128(), bandBits[3];
+    __m128i zero = _mm_setzero_si128(), allDigits = _mm_set1_epi16(ALL_DIGITS_MASK), value, occupied, candidates;
+    __m128i filledLanes = _mm_setzero_si128(), exponentBias = _mm_set1_epi32(126), low, high;
+    unsigned short lastBits[SUDOKU_SIZE], colLanes[8], bandLanes[3 * 8];
+    const unsigned short* box = NULL;
+    int filled = 0;
+
+    // Digit d becomes the float 2^(d - 1) by writing d - 1 into the exponent field, -1 becomes 0.25 and truncates to 0
+    for (int x = 0; x < SUDOKU_SIZE; x++)
+    {
+        value = _mm_loadl_epi64((const __m128i*)(cells + x * SUDOKU_SIZE));
+        value = _mm_srai_epi16(_mm_unpacklo_epi8(value, value), 8);
+        low = _mm_srai_epi32(_mm_unpacklo_epi16(value, value), 16);
+        high = _mm_srai_epi32(_mm_unpackhi_epi16(value, value), 16);
+        low = _mm_cvttps_epi32(_mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(low, exponentBias), 23)));
+        high = _mm_cvttps_epi32(_mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(high, exponentBias), 23)));
+        bits[x] = _mm_packs_epi32(low, high);
+        lastBits[x] = LastSlotBit(cells + x * SUDOKU_SIZE);
+        colBits = _mm_or_si128(colBits, bits[x]);
+        possibilities->row[x] = HorizontalOr16(bits[x]) | lastBits[x];
+        filledLanes = _mm_sub_epi16(filledLanes, _mm_cmpgt_epi16(bits[x], zero));
+        filled += lastBits[x] != 0;
+    }
+    for (int band = 0; band < 3; band++)
+    {
+        bandBits[band] = _mm_or_si128(_mm_or_si128(bits[band * 3], bits[band * 3 + 1]), bits[band * 3 + 2]);
+        _mm_storeu_si128((__m128i*)(bandLanes + band * 8), bandBits[band]);
+    }
+    _mm_storeu_si128((__m128i*)colLanes, colBits);
+    StoreUnitMasks(possibilities, colLanes, bandLanes, lastBits);
+    filledLanes = _mm_add_epi16(filledLanes, _mm_srli_si128(filledLanes, 8));
+    filledLanes = _mm_add_epi16(filledLanes, _mm_srli_si128(filledLanes, 4));
+    filledLanes = _mm_add_epi16(filledLanes, _mm_srli_si128(filledLanes, 2));
+    possibilities->filled = (unsigned char)(filled + (_mm_cvtsi128_si32(filledLanes) & 0xFFFF));
+
+    // Candidates of a slot = digits missing from its row, column and square, only for empty slots
+    for (int x = 0; x < SUDOKU_SIZE; x++)
+    {
+        box = possibilities->box + (x / 3) * 3;
+        occupied = _mm_or_si128(_mm_or_si128(_mm_set1_epi16((short)possibilities->row[x]), colBits),
+            _mm_setr_epi16((short)box[0], (short)box[0], (short)box[0], (short)box[1], (short)box[1], (short)box[1],
+                (short)box[2], (short)box[2]));
+        candidates = _mm_and_si128(_mm_andnot_si128(occupied, allDigits), _mm_cmpeq_epi16(bits[x], zero));
+        _mm_storeu_si128((__m128i*)(possibilities->cell + x * SUDOKU_SIZE), candidates);
+        possibilities->cell[CELL_OF(x, SUDOKU_SIZE - 1)] = lastBits[x] ? 0 :
+            ~(possibilities->row[x] | possibilities->col[SUDOKU_SIZE - 1] | box[2]) & ALL_DIGITS_MASK;
+    }
+}
+
+KERNEL_TARGET("avx2")
+static void ComputeBoardMasksAvx2(signed char board[][SUDOKU_SIZE], Candidates_t* possibilities)
+{
+    const signed char* cells = &board[0][0];
+    __m256i bits[SUDOKU_SIZE], colBits = _mm256_setzero_si256(), boxBits[3], filledLanes = _mm256_setzero_si256();
+    __m256i zero = _mm256_setzero_si256(), one = _mm256_set1_epi32(1), allDigits = _mm256_set1_epi32(ALL_DIGITS_MASK);
+    __m256i band, candidates;
+    __m128i half;
+    unsigned short lastBits[SUDOKU_SIZE], lastCol = 0, lastBox = 0;
+    int filled = 0;
+
+    // Digit d becomes (1 << d) >> 1 in every 32 bit lane, -1 shifts everything out so empty slots become 0
+    for (int x = 0; x < SUDOKU_SIZE; x++)
+    {
+        bits[x] = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)(cells + x * SUDOKU_SIZE)));
+        bits[x] = _mm256_srli_epi32(_mm256_sllv_epi32(one, bits[x]), 1);
+        lastBits[x] = LastSlotBit(cells + x * SUDOKU_SIZE);
+        lastCol |= lastBits[x];
+        filled += lastBits[x] != 0;
+        colBits = _mm256_or_si256(colBits, bits[x]);
+        filledLanes = _mm256_sub_epi32(filledLanes, _mm256_cmpgt_epi32(bits[x], zero));
+
+        half = _mm_or_si128(_mm256_castsi256_si128(bits[x]), _mm256_extracti128_si256(bits[x], 1));
+        half = _mm_or_si128(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+        half = _mm_or_si128(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+        possibilities->row[x] = (unsigned short)_mm_cvtsi128_si32(half) | lastBits[x];
+    }
+
+    // Spread the square masks of every band over the lanes of its columns: [b0 b0 b0 b1 b1 b1 b2 b2]
+    for (int i = 0; i < 3; i++)
+    {
+        band = _mm256_or_si256(_mm256_or_si256(bits[i * 3], bits[i * 3 + 1]), bits[i * 3 + 2]);
+        lastBox = lastBits[i * 3] | lastBits[i * 3 + 1] | lastBits[i * 3 + 2];
+        boxBits[i] = _mm256_or_si256(
+            _mm256_or_si256(_mm256_permutevar8x32_epi32(band, _mm256_setr_epi32(0, 0, 0, 3, 3, 3, 6, 6)),
+                _mm256_permutevar8x32_epi32(band, _mm256_setr_epi32(1, 1, 1, 4, 4, 4, 7, 7))),
+            _mm256_or_si256(_mm256_permutevar8x32_epi32(band, _mm256_setr_epi32(2, 2, 2, 5, 5, 5, 6, 6)),
+                _mm256_setr_epi32(0, 0, 0, 0, 0, 0, lastBox, lastBox)));
+        half = _mm_packus_epi32(_mm256_castsi256_si128(boxBits[i]), _mm256_extracti128_si256(boxBits[i], 1));
+        possibilities->box[i * 3] = (unsigned short)_mm_extract_epi16(half, 0);
+        possibilities->box[i * 3 + 1] = (unsigned short)_mm_extract_epi16(half, 3);
+        possibilities->box[i * 3 + 2] = (unsigned short)_mm_extract_epi16(half, 6);
+    }
+
+    half = _mm_packus_epi32(_mm256_castsi256_si128(colBits), _mm256_extracti128_si256(colBits, 1));
+    _mm_storeu_si128((__m128i*)possibilities->col, half);
+    possibilities->col[SUDOKU_SIZE - 1] = lastCol;
+
+    half = _mm_add_epi32(_mm256_castsi256_si128(filledLanes), _mm256_extracti128_si256(filledLanes, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    possibilities->filled = (unsigned char)(filled + _mm_cvtsi128_si32(half));
+
+    // Candidates of a slot = digits missing from its row, column and square, only for empty slots
+    for (int x = 0; x < SUDOKU_SIZE; x++)
+    {
+        candidates = _mm256_or_si256(_mm256_or_si256(_mm256_set1_epi32(possibilities->row[x]), colBits), boxBits[x / 3]);
+        candidates = _mm256_and_si256(_mm256_andnot_si256(candidates, allDigits), _mm256_cmpeq_epi32(bits[x], zero));
+        half = _mm_packus_epi32(_mm256_castsi256_si128(candidates), _mm256_extracti128_si256(candidates, 1));
+        _mm_storeu_si128((__m128i*)(possibilities->cell + x * SUDOKU_SIZE), half);
+        possibilities->cell[CELL_OF(x, SUDOKU_SIZE - 1)] = lastBits[x] ? 0 :
+            ~(possibilities->row[x] | lastCol | possibilities->box[(x / 3) * 3 + 2]) & ALL_DIGITS_MASK;
+    }
+}
+
+static int HasAvx2(void)
+{
+#if defined(_MSC_VER)
+    int info[4];
+
+    __cpuid(info, 0);
+    if (info[0] < 7)
+    {
+        return 0;
+    }
+    __cpuid(info, 1);
+    // OSXSAVE and AVX, then the operating system must save the YMM registers
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6)
+    {
+        return 0;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+// The portable kernel until InitBoardKernel picks the best one, so a board computed before that is still right
+static BoardKernel_t g_boardKernel = ComputeBoardMasksScalar;
+static const char* g_boardKernelName = "scalar";
+
+void InitBoardKernel(void)
+{
+#ifdef KERNEL_X86
+    if (HasAvx2())
+    {
+        g_boardKernelName = "avx2";
+        g_boardKernel = ComputeBoardMasksAvx2;
+    }
+    else
+    {
+        g_boardKernelName = "sse2";
+        g_boardKernel = ComputeBoardMasksSse2;
+    }
+#endif
+}
+
+void ComputeBoardMasks(signed char board[][SUDOKU_SIZE], Candidates_t* possibilities)
+{
+    g_boardKernel(board, possibilities);
+    possibilities->conflicts = CountConflicts(possibilities);
+}
+
+const char* GetBoardKernelName(void)
+{
+    return g_boardKernelName;
+}
+
+Errors SetBoardKernel(const char* name)
+{
+    if (strcmp(name, "scalar") == 0)
+    {
+        g_boardKernelName = "scalar";
+        g_boardKernel = ComputeBoardMasksScalar;
+        return ERR_OK;
+    }
+#ifdef KERNEL_X86
+    if (strcmp(name, "sse2") == 0)
+    {
+        g_boardKernelName = "sse2";
+        g_boardKernel = ComputeBoardMasksSse2;
+        return ERR_OK;
+    }
+    if (strcmp(name, "avx2") == 0 && HasAvx2())
+    {
+        g_boardKernelName = "avx2";
+        g_boardKernel = ComputeBoardMasksAvx2;
+        return ERR_OK;
+    }
+#endif
+
+    return ERR_GENERAL;
+}
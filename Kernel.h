@@ -0,0 +1,49 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  This file contains the whole board candidate kernel.
+    The "ComputeBoardMasks" function computes the occupancy masks of the 9 rows, 9 columns and 9 squares of a board
+    and the candidate masks of its 81 slots at once, instead of scanning the peers of every slot one by one.
+    On x86 processors the kernel runs on AVX2 when the processor supports it (checked once at run time) and on SSE2 otherwise,
+    other processors use the portable scalar version.
+***************************************************************************************/
+
+#ifndef __KERNEL_H__
+#define __KERNEL_H__
+
+#include "Solver.h"
+
+
+/**
+ * @brief Picks the best kernel for this processor. Called once at start up, before any thread is started:
+ *  the kernel is a plain global the threads only read.
+ */
+void InitBoardKernel(void);
+
+/**
+ * @brief Fills a candidate block from a board: row, column and square masks, slot candidates, full slots counter,
+ *  and a conflicts counter that is not zero when some unit holds the same digit twice.
+ *
+ * @param board: a 2D array of signed chars representing the sudoku board (-1 for an empty slot).
+ * @param possibilities: the candidate block to fill.
+ */
+void ComputeBoardMasks(signed char board[][SUDOKU_SIZE], Candidates_t* possibilities);
+
+/**
+ * @brief Returns the name of the kernel in use ("avx2", "sse2" or "scalar").
+ */
+const char* GetBoardKernelName(void);
+
+/**
+ * @brief Forces a kernel by name, used to compare the kernels with each other. Like InitBoardKernel,
+ *  only while no other thread is running.
+ *
+ * @param name: "avx2", "sse2" or "scalar".
+ *
+ * @return ERR_OK, or ERR_GENERAL if the kernel is unknown or not supported by this processor.
+ */
+Errors SetBoardKernel(const char* name);
+
+
+
+#endif /*__KERNEL_H__*/
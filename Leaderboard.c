@@ -0,0 +1,219 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  The winners of a game, in finishing order and in an order-statistic treap by score.
+    An entry is inserted as a leaf and rotated up while its random priority beats its parent's, which keeps
+    the expected depth logarithmic; every rotation and insertion keeps the subtree sizes the rank queries use.
+***************************************************************************************/
+
+#include <stdlib.h>
+
+#include "Errors.h"
+#include "Leaderboard.h"
+#include "Metrics.h"
+
+/* The shape of the treap never changes an answer, a fixed seed also gives every run the same tree */
+#define LEADERBOARD_SEED 0x5EED1EADull
+
+#define SUBTREE_SIZE(entry) ((entry) ? (entry)->size : 0)
+
+size_t LeaderboardArenaSize(size_t capacity)
+{
+    return SlabArenaSize(sizeof(LeaderboardEntry_t), capacity, sizeof(void*));
+}
+
+Errors CreateLeaderboard(Leaderboard_t* leaderboard, Arena_t* arena, size_t capacity)
+{
+    leaderboard->root = NULL;
+    leaderboard->first = NULL;
+    leaderboard->last = NULL;
+    leaderboard->count = 0;
+    SeedRandom(&leaderboard->random, LEADERBOARD_SEED, 0);
+
+    return CreateSlab(&leaderboard->entries, arena, sizeof(LeaderboardEntry_t), capacity, sizeof(void*));
+}
+
+/**
+ * @brief Returns a negative number when entry 'a' ranks before entry 'b'.
+ */
+static int CompareEntries(const LeaderboardEntry_t* a, const LeaderboardEntry_t* b)
+{
+    if (a->score.round != b->score.round)
+    {
+        return a->score.round < b->score.round ? -1 : 1;
+    }
+    if (a->score.moves != b->score.moves)
+    {
+        return a->score.moves < b->score.moves ? -1 : 1;
+    }
+
+    return a->order < b->order ? -1 : 1;
+}
+
+/**
+ * @brief Rotates an entry above its parent, the order of the entries does not change.
+ */
+static void RotateUp(Leaderboard_t* leaderboard, LeaderboardEntry_t* entry)
+{
+    LeaderboardEntry_t* parent = entry->parent, * grandParent = parent->parent;
+
+    if (parent->left == entry)
+    {
+        parent->left = entry->right;
+        if (entry->right)
+        {
+            entry->right->parent = parent;
+        }
+        entry->right = parent;
+    }
+    else
+    {
+        parent->right = entry->left;
+        if (entry->left)
+        {
+            entry->left->parent = parent;
+        }
+        entry->left = parent;
+    }
+    parent->parent = entry;
+    entry->parent = grandParent;
+
+    if (!grandParent)
+    {
+        leaderboard->root = entry;
+    }
+    else if (grandParent->left == parent)
+    {
+        grandParent->left = entry;
+    }
+    else
+    {
+        grandParent->right = entry;
+    }
+
+    parent->size = 1 + SUBTREE_SIZE(parent->left) + SUBTREE_SIZE(parent->right);
+    entry->size = 1 + SUBTREE_SIZE(entry->left) + SUBTREE_SIZE(entry->right);
+}
+
+LeaderboardEntry_t* AddToLeaderboard(Leaderboard_t* leaderboard, struct Player* player, const LeaderboardScore_t* score)
+{
+    LeaderboardEntry_t* entry = NULL, * curr = NULL, ** link = &leaderboard->root;
+    METRIC_START(start);
+
+    entry = (LeaderboardEntry_t*)SlabAllocate(&leaderboard->entries);
+    if (!entry)
+    {
+        return NULL;
+    }
+    entry->player = player;
+    entry->score = *score;
+    entry->order = ++leaderboard->count;
+    entry->next = NULL;
+    entry->left = NULL;
+    entry->right = NULL;
+    entry->size = 1;
+    entry->priority = NextRandom(&leaderboard->random);
+
+    // The finishing order
+    if (leaderboard->last)
+    {
+        leaderboard->last->next = entry;
+    }
+    else
+    {
+        leaderboard->first = entry;
+    }
+    leaderboard->last = entry;
+
+    // The index: down to a leaf, counting the new entry in every subtree on the way
+    while (*link)
+    {
+        curr = *link;
+        ++curr->size;
+        link = CompareEntries(entry, curr) < 0 ? &curr->left : &curr->right;
+    }
+    entry->parent = curr;
+    *link = entry;
+
+    while (entry->parent && entry->priority > entry->parent->priority)
+    {
+        RotateUp(leaderboard, entry);
+    }
+    METRIC_STOP(METRIC_LEADERBOARD_NS, start);
+
+    return entry;
+}
+
+size_t GetLeaderboardRank(const LeaderboardEntry_t* entry)
+{
+    size_t rank = SUBTREE_SIZE(entry->left) + 1;
+
+    for (; entry->parent; entry = entry->parent)
+    {
+        if (entry->parent->right == entry)
+        {
+            rank += SUBTREE_SIZE(entry->parent->left) + 1;
+        }
+    }
+
+    return rank;
+}
+
+LeaderboardEntry_t* GetLeaderboardEntryAt(const Leaderboard_t* leaderboard, size_t rank)
+{
+    LeaderboardEntry_t* curr = leaderboard->root;
+    size_t before = 0;
+
+    while (curr)
+    {
+        before = SUBTREE_SIZE(curr->left);
+        if (rank <= before)
+        {
+            curr = curr->left;
+        }
+        else if (rank == before + 1)
+        {
+            return curr;
+        }
+        else
+        {
+            rank -= before + 1;
+            curr = curr->right;
+        }
+    }
+
+    return NULL;
+}
+
+LeaderboardEntry_t* GetNextByRank(const LeaderboardEntry_t* entry)
+{
+    if (entry->right)
+    {
+        entry = entry->right;
+        while (entry->left)
+        {
+            entry = entry->left;
+        }
+        return (LeaderboardEntry_t*)entry;
+    }
+
+    while (entry->parent && entry->parent->right == entry)
+    {
+        entry = entry->parent;
+    }
+
+    return entry->parent;
+}
+
+size_t GetLeaderboardPage(const Leaderboard_t* leaderboard, size_t firstRank, size_t count, LeaderboardEntry_t** page)
+{
+    LeaderboardEntry_t* entry = GetLeaderboardEntryAt(leaderboard, firstRank);
+    size_t copied = 0;
+
+    for (; entry && copied < count; entry = GetNextByRank(entry))
+    {
+        page[copied++] = entry;
+    }
+
+    return copied;
+}
@@ -0,0 +1,106 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  The winners of a game. Every winner is appended to the finishing order in O(1) and is also
+    kept in an order-statistic index by score: a treap whose nodes know the size of their subtree, so the rank
+    of a winner, the winner at a rank and a page of the leaderboard are answered in O(log n) while the game
+    is still running. The entries are carved from an arena, so adding a winner never calls the system allocator.
+***************************************************************************************/
+
+#ifndef __LEADERBOARD_H__
+#define __LEADERBOARD_H__
+
+#include <stddef.h>
+
+#include "Arena.h"
+#include "Slab.h"
+#include "Random.h"
+
+/* Lower is better, compared field by field in this order */
+typedef struct LeaderboardScore
+{
+    unsigned int round;                 /* the pass over the players the game was finished in */
+    unsigned int moves;                 /* digits the player submitted, the forced fills not included */
+} LeaderboardScore_t;
+
+typedef struct LeaderboardEntry LeaderboardEntry_t;
+
+struct LeaderboardEntry
+{
+    struct Player* player;
+    LeaderboardScore_t score;
+    size_t order;                       /* 1 based place in the finishing order, breaks ties between equal scores */
+    LeaderboardEntry_t* next;           /* the next winner in finishing order */
+    LeaderboardEntry_t* left;
+    LeaderboardEntry_t* right;
+    LeaderboardEntry_t* parent;
+    size_t size;                        /* entries in the subtree of this entry, itself included */
+    unsigned long long priority;        /* heap order of the treap, a parent's priority is never below its children's */
+};
+
+typedef struct Leaderboard
+{
+    Slab_t entries;
+    LeaderboardEntry_t* root;
+    LeaderboardEntry_t* first;          /* the finishing order, first to last */
+    LeaderboardEntry_t* last;
+    size_t count;
+    Random_t random;                    /* draws the priorities */
+} Leaderboard_t;
+
+
+/**
+ * @brief Returns the arena room a leaderboard of 'capacity' winners needs.
+ */
+size_t LeaderboardArenaSize(size_t capacity);
+
+/**
+ * @brief Creates an empty leaderboard.
+ *
+ * @param leaderboard: the leaderboard to create.
+ * @param arena: the arena the entries are taken from.
+ * @param capacity: the most winners the leaderboard will hold.
+ *
+ * @return ERR_OK on success, ERR_ALLOCATION_FAILED if the arena is too small.
+ */
+Errors CreateLeaderboard(Leaderboard_t* leaderboard, Arena_t* arena, size_t capacity);
+
+/**
+ * @brief Appends a winner to the finishing order and inserts it into the index by score.
+ *
+ * @param leaderboard: the leaderboard.
+ * @param player: the winner.
+ * @param score: the score of the winner.
+ *
+ * @return the winner's entry, or NULL if the leaderboard is full.
+ */
+LeaderboardEntry_t* AddToLeaderboard(Leaderboard_t* leaderboard, struct Player* player, const LeaderboardScore_t* score);
+
+/**
+ * @brief Returns the 1 based rank of an entry by score.
+ */
+size_t GetLeaderboardRank(const LeaderboardEntry_t* entry);
+
+/**
+ * @brief Returns the entry at a 1 based rank by score, or NULL if there is no such rank.
+ */
+LeaderboardEntry_t* GetLeaderboardEntryAt(const Leaderboard_t* leaderboard, size_t rank);
+
+/**
+ * @brief Returns the entry ranked right after an entry, or NULL after the last one.
+ */
+LeaderboardEntry_t* GetNextByRank(const LeaderboardEntry_t* entry);
+
+/**
+ * @brief Copies a page of the leaderboard, the top K is the page that starts at rank 1.
+ *
+ * @param leaderboard: the leaderboard.
+ * @param firstRank: the 1 based rank the page starts at.
+ * @param count: the size of the page.
+ * @param page: receives the entries of the page in rank order.
+ *
+ * @return the number of entries copied, fewer than 'count' at the end of the leaderboard.
+ */
+size_t GetLeaderboardPage(const Leaderboard_t* leaderboard, size_t firstRank, size_t count, LeaderboardEntry_t** page);
+
+#endif /*__LEADERBOARD_H__*/
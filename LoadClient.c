@@ -0,0 +1,361 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  A load generator for the game server. A bot keeps one connection and one line buffer,
+    a TURN line is answered at once with a MOVE and a WIN or LOSE line ends the game; the time from a
+    message to the server's answer is summed so the report can show the average turn time.
+    With a think time a bot holds its MOVE on a timer of the client's timer wheel for a random part of that time,
+    so one thread plays any number of slow players.
+***************************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Errors.h"
+#include "LoadClient.h"
+#include "Net.h"
+#include "Random.h"
+#include "Platform.h"
+#include "Ui.h"
+#include "TimerWheel.h"
+
+#define LOAD_EVENTS 256
+#define LOAD_LINE_SIZE 256
+#define LOAD_OUTPUT_SIZE 64
+#define LOAD_MOVE_SIZE 16
+#define NS_PER_MS 1000000ull
+
+typedef struct Bot
+{
+    Socket_t socket;
+    int watching;
+    size_t inputUsed;
+    size_t outputUsed;
+    size_t outputSent;
+    unsigned long long sentAt;          /* when the last message was queued, to time the answer */
+    Random_t random;
+    Timer_t thinking;                   /* when the bot sends the move it holds */
+    char input[LOAD_LINE_SIZE];
+    char output[LOAD_OUTPUT_SIZE];
+    char move[LOAD_MOVE_SIZE];          /* the MOVE line held while the bot thinks */
+} Bot_t;
+
+typedef struct LoadClient
+{
+    const char* address;
+    EventLoop_t* loop;
+    Bot_t* bots;
+    size_t started;                     /* games a bot connected for */
+    size_t games;                       /* games that ended */
+    size_t target;
+    size_t wins;
+    size_t failures;                    /* connections that ended without a result */
+    unsigned long long moves;
+    unsigned long long waitNs;          /* the time the bots waited for answers */
+    unsigned long long answers;
+    TimerWheel_t timers;                /* the thinking bots, in milliseconds */
+    unsigned long long nowMs;           /* the clock, read once for every wake up of the event loop */
+    unsigned int thinkMs;               /* the longest a bot thinks about a move */
+} LoadClient_t;
+
+static void QueueLine(Bot_t* bot, const char* line)
+{
+    size_t length = strlen(line);
+
+    if (bot->outputUsed + length <= LOAD_OUTPUT_SIZE)
+    {
+        memcpy(bot->output + bot->outputUsed, line, length);
+        bot->outputUsed += length;
+    }
+    bot->sentAt = GetTimeNs();
+}
+
+/**
+ * @brief Connects a bot for its next game, a bot whose games are all started stays idle.
+ */
+static Errors ConnectBot(LoadClient_t* client, Bot_t* bot, size_t index)
+{
+    char line[32];
+
+    bot->socket = INVALID_SOCKET_HANDLE;
+    if (client->started == client->target)
+    {
+        return ERR_OK;
+    }
+    if (ConnectTo(client->address, &bot->socket) != ERR_OK)
+    {
+        return ERR_GENERAL;
+    }
+    ++client->started;
+    bot->inputUsed = bot->outputUsed = bot->outputSent = 0;
+    sprintf(line, "NAME bot%zu\n", index);
+    QueueLine(bot, line);
+
+    // The NAME line goes out once the connection is writable
+    bot->watching = NET_EVENT_READ | NET_EVENT_WRITE;
+    return WatchSocket(client->loop, bot->socket, bot->watching, bot);
+}
+
+/**
+ * @brief Ends the connection of a bot and connects it again for the next game.
+ */
+static void DisconnectBot(LoadClient_t* client, Bot_t* bot)
+{
+    CancelTimer(&client->timers, &bot->thinking);
+    UnwatchSocket(client->loop, bot->socket);
+    CloseSocket(bot->socket);
+    if (ConnectBot(client, bot, (size_t)(bot - client->bots)) != ERR_OK)
+    {
+        ++client->failures;
+        ++client->games;
+    }
+}
+
+/**
+ * @brief Answers one line from the server.
+ *
+ * @return ERR_OK while the game goes on, ERR_FINISH_SUCCESS once it ended.
+ */
+static Errors HandleServerLine(LoadClient_t* client, Bot_t* bot, const char* line)
+{
+    char move[LOAD_MOVE_SIZE];
+    const char* digits = NULL;
+    size_t count = 0;
+
+    if (strncmp(line, "TURN ", 5) == 0)
+    {
+        client->waitNs += GetTimeNs() - bot->sentAt;
+        ++client->answers;
+        // TURN <row> <col> <digits>
+        digits = strrchr(line, ' ') + 1;
+        count = strlen(digits);
+        sprintf(move, "MOVE %c\n", count ? digits[RandomBelow(&bot->random, (unsigned int)count)] : '1');
+        ++client->moves;
+        if (client->thinkMs)
+        {
+            // A TURN that follows a TIMEOUT moves the timer of the move the server already played
+            strcpy(bot->move, move);
+            ScheduleTimer(&client->timers, &bot->thinking, client->nowMs + RandomBelow(&bot->random, client->thinkMs + 1));
+            return ERR_OK;
+        }
+        QueueLine(bot, move);
+    }
+    else if (strncmp(line, "WIN", 3) == 0 || strncmp(line, "LOSE", 4) == 0)
+    {
+        client->waitNs += GetTimeNs() - bot->sentAt;
+        ++client->answers;
+        client->wins += line[0] == 'W';
+        ++client->games;
+        return ERR_FINISH_SUCCESS;
+    }
+
+    return ERR_OK;
+}
+
+/**
+ * @brief Sends what is queued for a bot and watches its socket for what it waits for.
+ */
+static Errors FlushBot(LoadClient_t* client, Bot_t* bot)
+{
+    long sent = 0;
+    int watching = NET_EVENT_READ;
+
+    while (bot->outputSent < bot->outputUsed)
+    {
+        sent = SendSome(bot->socket, bot->output + bot->outputSent, bot->outputUsed - bot->outputSent);
+        if (sent == NET_WOULD_BLOCK)
+        {
+            break;
+        }
+        if (sent < 0)
+        {
+            return ERR_GENERAL;
+        }
+        bot->outputSent += (size_t)sent;
+    }
+    if (bot->outputSent == bot->outputUsed)
+    {
+        bot->outputSent = bot->outputUsed = 0;
+    }
+    else
+    {
+        watching |= NET_EVENT_WRITE;
+    }
+
+    if (watching != bot->watching)
+    {
+        bot->watching = watching;
+        return WatchSocket(client->loop, bot->socket, watching, bot);
+    }
+
+    return ERR_OK;
+}
+
+/**
+ * @brief Reads the lines waiting for a bot and answers them.
+ *
+ * @return ERR_OK while the game goes on, ERR_FINISH_SUCCESS once it ended or ERR_GENERAL if the connection failed.
+ */
+static Errors ReadBot(LoadClient_t* client, Bot_t* bot)
+{
+    long received = 0;
+    char* line = NULL, * end = NULL;
+    size_t consumed = 0;
+
+    while (1)
+    {
+        received = ReceiveSome(bot->socket, bot->input + bot->inputUsed, LOAD_LINE_SIZE - bot->inputUsed);
+        if (received == NET_WOULD_BLOCK)
+        {
+            break;
+        }
+        if (received <= 0)
+        {
+            return ERR_GENERAL;
+        }
+        bot->inputUsed += (size_t)received;
+
+        consumed = 0;
+        line = bot->input;
+        while ((end = (char*)memchr(line, '\n', bot->inputUsed - consumed)) != NULL)
+        {
+            *end = '\0';
+            if (HandleServerLine(client, bot, line) == ERR_FINISH_SUCCESS)
+            {
+                return ERR_FINISH_SUCCESS;
+            }
+            consumed += (size_t)(end - line) + 1;
+            line = end + 1;
+        }
+        if (consumed == 0 && bot->inputUsed == LOAD_LINE_SIZE)
+        {
+            return ERR_GENERAL;
+        }
+        memmove(bot->input, bot->input + consumed, bot->inputUsed - consumed);
+        bot->inputUsed -= consumed;
+    }
+
+    return FlushBot(client, bot);
+}
+
+/**
+ * @brief Called by the timer wheel when a bot is done thinking, sends the move it held.
+ */
+static void SendHeldMove(Timer_t* timer, void* context)
+{
+    LoadClient_t* client = (LoadClient_t*)context;
+    Bot_t* bot = (Bot_t*)timer->data;
+
+    QueueLine(bot, bot->move);
+    if (FlushBot(client, bot) != ERR_OK)
+    {
+        ++client->failures;
+        ++client->games;
+        DisconnectBot(client, bot);
+    }
+}
+
+Errors RunLoadClient(const char* address, size_t clients, size_t games, unsigned int thinkMs, unsigned long long seed)
+{
+    LoadClient_t client = { NULL };
+    NetEvent_t events[LOAD_EVENTS];
+    Bot_t* bot = NULL;
+    unsigned long long start = 0;
+    int count = 0;
+    Errors eErr = ERR_OK;
+
+    if (clients == 0 || games == 0)
+    {
+        return ERR_OK;
+    }
+    if (clients > games)
+    {
+        clients = games;
+    }
+    if (StartNetworking() != ERR_OK)
+    {
+        return ERR_GENERAL;
+    }
+    client.address = address;
+    client.target = games;
+    client.thinkMs = thinkMs;
+    client.nowMs = GetTimeNs() / NS_PER_MS;
+    InitTimerWheel(&client.timers, client.nowMs);
+    client.loop = CreateEventLoop(clients);
+    client.bots = (Bot_t*)AllocateZeroed(clients, sizeof(Bot_t));
+    if (!client.loop || !client.bots)
+    {
+        DestroyEventLoop(client.loop);
+        free(client.bots);
+        StopNetworking();
+        return ERR_ALLOCATION_FAILED;
+    }
+
+    for (size_t i = 0; i < clients; i++)
+    {
+        client.bots[i].socket = INVALID_SOCKET_HANDLE;
+        SeedRandom(&client.bots[i].random, seed, i);
+        InitTimer(&client.bots[i].thinking, &client.bots[i]);
+    }
+    start = GetTimeNs();
+    for (size_t i = 0; i < clients && eErr == ERR_OK; i++)
+    {
+        eErr = ConnectBot(&client, &client.bots[i], i);
+    }
+
+    while (eErr == ERR_OK && client.games < client.target)
+    {
+        count = WaitForEvents(client.loop, events, LOAD_EVENTS, NextTimerDelay(&client.timers));
+        if (count < 0)
+        {
+            eErr = ERR_GENERAL;
+            break;
+        }
+        client.nowMs = GetTimeNs() / NS_PER_MS;
+        for (int i = 0; i < count; i++)
+        {
+            bot = (Bot_t*)events[i].data;
+            if (events[i].events & (NET_EVENT_READ | NET_EVENT_CLOSED))
+            {
+                switch (ReadBot(&client, bot))
+                {
+                case ERR_FINISH_SUCCESS:
+                    DisconnectBot(&client, bot);
+                    break;
+                case ERR_GENERAL:
+                    ++client.failures;
+                    ++client.games;
+                    DisconnectBot(&client, bot);
+                    break;
+                default:
+                    break;
+                }
+            }
+            else if ((events[i].events & NET_EVENT_WRITE) && FlushBot(&client, bot) != ERR_OK)
+            {
+                ++client.failures;
+                ++client.games;
+                DisconnectBot(&client, bot);
+            }
+        }
+        AdvanceTimerWheel(&client.timers, client.nowMs, SendHeldMove, &client);
+    }
+
+    PrintLoadSummary(client.games, client.wins, client.failures, client.moves, clients,
+        client.answers ? client.waitNs / client.answers : 0, GetTimeNs() - start);
+
+    for (size_t i = 0; i < clients; i++)
+    {
+        if (client.bots[i].socket != INVALID_SOCKET_HANDLE)
+        {
+            UnwatchSocket(client.loop, client.bots[i].socket);
+            CloseSocket(client.bots[i].socket);
+        }
+    }
+    DestroyEventLoop(client.loop);
+    free(client.bots);
+    StopNetworking();
+
+    return eErr;
+}
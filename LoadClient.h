@@ -0,0 +1,27 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  A load generator for the game server. Many bot clients run on one thread around an event loop,
+    each plays one game per connection by answering every TURN with a random candidate of the slot and
+    connects again for the next game, so the server sees a steady number of concurrent sessions.
+***************************************************************************************/
+
+#ifndef __LOAD_CLIENT_H__
+#define __LOAD_CLIENT_H__
+
+#include <stddef.h>
+
+/**
+ * @brief Plays 'games' games against a server with 'clients' connections open at a time.
+ *
+ * @param address: the address of the server, a TCP port of the local machine or "unix:" followed by a path.
+ * @param clients: the number of concurrent connections.
+ * @param games: the number of games to play in total.
+ * @param thinkMs: the longest a bot waits before it answers a TURN, it waits a random time up to this; 0 answers at once.
+ * @param seed: the seed the bots pick their moves and think times with.
+ *
+ * @return ERR_OK, ERR_GENERAL if the server could not be reached or ERR_ALLOCATION_FAILED.
+ */
+Errors RunLoadClient(const char* address, size_t clients, size_t games, unsigned int thinkMs, unsigned long long seed);
+
+#endif /*__LOAD_CLIENT_H__*/
@@ -2,23 +2,226 @@
     Author: Mordechai Ben Shimon
     Creation date :  21/01/23
     Description :  Main file.
+    Without arguments the interactive game is started ("--seed N" replays the boards of an earlier game), "--batch <puzzles file> [solutions file] [--threads N]" runs the headless batch solver
+    and "--batch-scaling <puzzles file> [--threads N]" measures how the batch solver scales from 1 to N threads.
+    "--serve <port | unix:path> [--seed N] [--games N] [--move-time ms] [--on-timeout forfeit | random | first | lookahead]" runs the game server and
+    "--load-client <port | unix:path> [--clients N] [--games N] [--think ms] [--seed N]" plays bot games against it.
+    "--simulate <players> [--bot random | first | lookahead] [--boards N] [--seed N]" plays a whole game of bots with no output
+    and reports how fast it ran, with "--top K" it reports the standings after every round, with "--checkpoint path [--checkpoint-every rounds]" it writes a checkpoint of the game every few rounds
+    and "--resume <checkpoint file>" goes on with a game from its checkpoint, taking the same checkpoint options.
+    "--bench [results file] [--filter text] [--seed N]" runs the benchmark suite and writes its results as CSV.
+    Any mode takes "--metrics json | prometheus [--metrics-file path]" to dump the hot path metrics at exit and on SIGUSR1,
+    in a build with SUDOKU_METRICS defined.
 ***************************************************************************************/
 
-#include <windows.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 
 
 #include "Errors.h"
 #include "Players.h"
+#include "Batch.h"
+#include "Server.h"
+#include "LoadClient.h"
+#include "Bench.h"
+#include "Kernel.h"
+#include "Metrics.h"
+#include "Platform.h"
+#include "Ui.h"
 
-void main()
+#define LOAD_CLIENTS 100
+#define LOAD_GAMES 1000
+#define SIMULATION_BOARDS 1024
+#define BENCH_SEED 1
+#define CHECKPOINT_ROUNDS 10
+
+/**
+ * @brief Returns the value of the "--threads N" option, 0 (one thread per processor) when it is missing.
+ */
+static int GetThreadsOption(int argc, char* argv[])
 {
-    StartGame();   
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], "--threads") == 0)
+        {
+            return atoi(argv[i + 1]);
+        }
+    }
+
+    return 0;
 }
 
+/**
+ * @brief Returns the value of the "--seed N" option, the current time when it is missing.
+ */
+static unsigned long long GetSeedOption(int argc, char* argv[])
+{
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], "--seed") == 0)
+        {
+            return strtoull(argv[i + 1], NULL, 10);
+        }
+    }
 
+    return (unsigned long long)time(NULL);
+}
 
+/**
+ * @brief Returns the value of a numeric option such as "--games N", 'fallback' when it is missing.
+ */
+static size_t GetCountOption(int argc, char* argv[], const char* option, size_t fallback)
+{
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], option) == 0)
+        {
+            return (size_t)strtoull(argv[i + 1], NULL, 10);
+        }
+    }
+
+    return fallback;
+}
+
+/**
+ * @brief Returns the value of a text option such as "--bot name", 'fallback' when it is missing.
+ */
+static const char* GetTextOption(int argc, char* argv[], const char* option, const char* fallback)
+{
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], option) == 0)
+        {
+            return argv[i + 1];
+        }
+    }
+
+    return fallback;
+}
+
+/**
+ * @brief Runs "--simulate" and "--resume": creates the tournament or restores it from its checkpoint, plays it and reports it.
+ */
+static Errors RunSimulation(int argc, char* argv[])
+{
+    ActivePlayerslistManeger_t* tournament = NULL;
+    const char* checkpoint = GetTextOption(argc, argv, "--checkpoint", NULL);
+    TournamentStats_t stats;
+    Errors eErr;
 
+    memset(&stats, 0, sizeof(stats));
+    if (strcmp(argv[1], "--resume") == 0)
+    {
+        eErr = RestoreTournament(&tournament, argv[2]);
+    }
+    else
+    {
+        eErr = CreateTournament(&tournament, (size_t)strtoull(argv[2], NULL, 10), GetBotStrategy(GetTextOption(argc, argv, "--bot", "lookahead")),
+            GetCountOption(argc, argv, "--boards", SIMULATION_BOARDS), GetSeedOption(argc, argv));
+    }
+    if (eErr == ERR_OK && GetCountOption(argc, argv, "--top", 0))
+    {
+        eErr = SetTournamentStandings(tournament, GetCountOption(argc, argv, "--top", 0));
+    }
+    if (eErr == ERR_OK && checkpoint)
+    {
+        eErr = SetTournamentCheckpoints(tournament, checkpoint, (unsigned int)GetCountOption(argc, argv, "--checkpoint-every", CHECKPOINT_ROUNDS));
+    }
+    if (eErr == ERR_OK)
+    {
+        eErr = PlayTournament(tournament, &stats);
+    }
+    DestroyTournament(tournament);
 
+    if (eErr == ERR_OK)
+    {
+        PrintTournamentSummary(stats.players, stats.wins, stats.rounds, stats.moves, stats.setupNs, stats.elapsedNs, stats.peakMemory,
+            stats.playAllocations);
+        if (strcmp(argv[1], "--resume") == 0)
+        {
+            PrintTournamentResumed(stats.restoredRound);
+        }
+        if (checkpoint)
+        {
+            PrintCheckpointSummary(stats.checkpoints, stats.checkpointsDropped, stats.checkpointsFailed, stats.checkpointSize,
+                stats.checkpointCopyNs, stats.checkpointWriteNs);
+        }
+    }
 
+    return eErr;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* metrics = GetTextOption(argc, argv, "--metrics", NULL);
+    Errors eErr = ERR_OK;
+
+    // Before any thread is started, they all read the kernel it picks
+    InitBoardKernel();
+
+    // Before anything else, so every thread the modes start records into the metrics
+    if (metrics)
+    {
+        eErr = StartMetrics(strcmp(metrics, "prometheus") == 0 ? METRICS_PROMETHEUS : METRICS_JSON,
+            GetTextOption(argc, argv, "--metrics-file", NULL));
+        HandleErr(eErr, "metrics are not available, build with SUDOKU_METRICS defined");
+    }
+
+    // Sudoku --batch <puzzles file> [solutions file] [--threads N]
+    if (argc >= 3 && strcmp(argv[1], "--batch") == 0)
+    {
+        eErr = RunBatchSolve(argv[2], argc > 3 && argv[3][0] != '-' ? argv[3] : NULL, GetThreadsOption(argc, argv));
+        HandleErr(eErr, "batch solve failed");
+        return eErr == ERR_OK ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    // Sudoku --batch-scaling <puzzles file> [--threads N]
+    if (argc >= 3 && strcmp(argv[1], "--batch-scaling") == 0)
+    {
+        eErr = RunBatchScaling(argv[2], GetThreadsOption(argc, argv));
+        HandleErr(eErr, "batch scaling failed");
+        return eErr == ERR_OK ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Sudoku --serve <port | unix:path> [--seed N] [--games N] [--move-time ms] [--on-timeout forfeit | random | first | lookahead]
+    if (argc >= 3 && strcmp(argv[1], "--serve") == 0)
+    {
+        // "forfeit" names no bot, so a client that runs out of time loses
+        eErr = RunServer(argv[2], GetSeedOption(argc, argv), GetCountOption(argc, argv, "--games", 0),
+            (unsigned int)GetCountOption(argc, argv, "--move-time", 0), GetBotStrategy(GetTextOption(argc, argv, "--on-timeout", "forfeit")));
+        HandleErr(eErr, "server failed");
+        return eErr == ERR_OK ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    // Sudoku --load-client <port | unix:path> [--clients N] [--games N] [--think ms] [--seed N]
+    if (argc >= 3 && strcmp(argv[1], "--load-client") == 0)
+    {
+        eErr = RunLoadClient(argv[2], GetCountOption(argc, argv, "--clients", LOAD_CLIENTS),
+            GetCountOption(argc, argv, "--games", LOAD_GAMES), (unsigned int)GetCountOption(argc, argv, "--think", 0), GetSeedOption(argc, argv));
+        HandleErr(eErr, "load client failed");
+        return eErr == ERR_OK ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Sudoku --simulate <players> [--bot random | first | lookahead] [--boards N] [--seed N] [--top K] [--checkpoint path [--checkpoint-every rounds]]
+    // Sudoku --resume <checkpoint file> [--top K] [--checkpoint path [--checkpoint-every rounds]]
+    if (argc >= 3 && (strcmp(argv[1], "--simulate") == 0 || strcmp(argv[1], "--resume") == 0))
+    {
+        eErr = RunSimulation(argc, argv);
+        HandleErr(eErr, "simulation failed");
+        return eErr == ERR_OK ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Sudoku --bench [results file] [--filter text] [--seed N]
+    if (argc >= 2 && strcmp(argv[1], "--bench") == 0)
+    {
+        // A fixed seed by default, so two builds run the same benchmarks
+        eErr = RunBenchmarks(argc > 2 && argv[2][0] != '-' ? argv[2] : NULL, GetTextOption(argc, argv, "--filter", NULL),
+            (unsigned long long)GetCountOption(argc, argv, "--seed", BENCH_SEED));
+        HandleErr(eErr, "benchmarks failed");
+        return eErr == ERR_OK ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    StartGame(GetSeedOption(argc, argv));
+
+    return EXIT_SUCCESS;
+}
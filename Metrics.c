@@ -0,0 +1,351 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  Instrumentation of the hot paths. Every thread records into a block of its own, taken the first time
+    it records something and linked into a list that only a new thread or a dump locks. A dump merges the blocks of
+    every thread and writes them as JSON or Prometheus text. On POSIX systems SIGUSR1 is blocked in every thread and
+    a thread of its own waits for it with sigwait, so a dump never runs inside a signal handler.
+***************************************************************************************/
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+
+#if defined(SUDOKU_METRICS) && !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+#include "Errors.h"
+#include "Metrics.h"
+#include "Platform.h"
+
+#ifdef SUDOKU_METRICS
+
+static const char* g_counterNames[METRIC_COUNTERS] =
+{
+    "moves", "candidate_updates", "candidates_removed", "propagations", "units_scanned", "singles_placed", "allocations"
+};
+
+static const char* g_histogramNames[METRIC_HISTOGRAMS] =
+{
+    "generate", "candidate_rebuild", "propagation", "input_wait", "ranking", "leaderboard_insert"
+};
+
+static const double g_quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+METRICS_THREAD_LOCAL ThreadMetrics_t* g_threadMetrics = NULL;
+static METRICS_THREAD_LOCAL int g_joiningMetrics = 0;
+int g_metricsStarted = 0;
+
+static ThreadMetrics_t* g_allMetrics = NULL;
+static ThreadMetrics_t g_mergedMetrics;         /* the sum of every thread, only touched under the lock */
+static Lock_t* g_metricsLock = NULL;
+static MetricsFormat g_metricsFormat = METRICS_JSON;
+static const char* g_metricsPath = NULL;
+
+#ifndef _WIN32
+static Thread_t* g_signalThread = NULL;
+static volatile sig_atomic_t g_metricsStopping = 0;
+#endif
+
+unsigned long long MetricClock(void)
+{
+    return g_metricsStarted ? GetTimeNs() : 0;
+}
+
+ThreadMetrics_t* JoinMetrics(void)
+{
+    ThreadMetrics_t* metrics = NULL;
+
+    // The allocation below counts itself into the metrics, which would join again
+    if (!g_metricsStarted || g_joiningMetrics)
+    {
+        return NULL;
+    }
+
+    g_joiningMetrics = 1;
+    metrics = (ThreadMetrics_t*)AllocateZeroed(1, sizeof(ThreadMetrics_t));
+    g_joiningMetrics = 0;
+    if (!metrics)
+    {
+        return NULL;
+    }
+    AcquireLock(g_metricsLock);
+    metrics->next = g_allMetrics;
+    g_allMetrics = metrics;
+    ReleaseLock(g_metricsLock);
+
+    g_threadMetrics = metrics;
+    return metrics;
+}
+
+/**
+ * @brief Returns the highest value a bucket holds.
+ */
+static unsigned long long BucketLimit(int bucket)
+{
+    int top = 0, sub = 0;
+
+    if (bucket < METRIC_SUB_BUCKETS)
+    {
+        return (unsigned long long)bucket;
+    }
+    top = bucket / METRIC_SUB_BUCKETS + METRIC_SUB_BUCKET_BITS - 1;
+    sub = bucket % METRIC_SUB_BUCKETS;
+
+    return ((unsigned long long)(METRIC_SUB_BUCKETS + sub + 1) << (top - METRIC_SUB_BUCKET_BITS)) - 1;
+}
+
+static unsigned long long HistogramQuantile(const LatencyHistogram_t* histogram, double quantile)
+{
+    unsigned long long rank = (unsigned long long)(quantile * histogram->count + 0.5), seen = 0;
+
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+    for (int bucket = 0; bucket < METRIC_BUCKETS; bucket++)
+    {
+        seen += histogram->buckets[bucket];
+        if (seen >= rank)
+        {
+            return BucketLimit(bucket) < histogram->max ? BucketLimit(bucket) : histogram->max;
+        }
+    }
+
+    return histogram->max;
+}
+
+static void MergeMetrics(ThreadMetrics_t* total)
+{
+    const LatencyHistogram_t* from = NULL;
+    LatencyHistogram_t* to = NULL;
+
+    memset(total, 0, sizeof(ThreadMetrics_t));
+    for (const ThreadMetrics_t* metrics = g_allMetrics; metrics; metrics = metrics->next)
+    {
+        for (int counter = 0; counter < METRIC_COUNTERS; counter++)
+        {
+            total->counters[counter] += metrics->counters[counter];
+        }
+        for (int histogram = 0; histogram < METRIC_HISTOGRAMS; histogram++)
+        {
+            from = &metrics->histograms[histogram];
+            to = &total->histograms[histogram];
+            to->count += from->count;
+            to->sum += from->sum;
+            to->max = from->max > to->max ? from->max : to->max;
+            for (int bucket = 0; bucket < METRIC_BUCKETS; bucket++)
+            {
+                to->buckets[bucket] += from->buckets[bucket];
+            }
+        }
+    }
+}
+
+static void WriteJson(FILE* file, const ThreadMetrics_t* total)
+{
+    const LatencyHistogram_t* histogram = NULL;
+
+    fprintf(file, "{\n  \"counters\": {\n");
+    for (int counter = 0; counter < METRIC_COUNTERS; counter++)
+    {
+        fprintf(file, "    \"%s\": %llu%s\n", g_counterNames[counter], total->counters[counter],
+            counter + 1 < METRIC_COUNTERS ? "," : "");
+    }
+    fprintf(file, "  },\n  \"histograms\": {\n");
+    for (int i = 0; i < METRIC_HISTOGRAMS; i++)
+    {
+        histogram = &total->histograms[i];
+        fprintf(file, "    \"%s_ns\": { \"count\": %llu, \"sum\": %llu, \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"p999\": %llu, \"max\": %llu }%s\n",
+            g_histogramNames[i], histogram->count, histogram->sum, HistogramQuantile(histogram, 0.5), HistogramQuantile(histogram, 0.9),
+            HistogramQuantile(histogram, 0.99), HistogramQuantile(histogram, 0.999), histogram->max, i + 1 < METRIC_HISTOGRAMS ? "," : "");
+    }
+    fprintf(file, "  }\n}\n");
+}
+
+/**
+ * @brief Writes the counters as Prometheus counters and the histograms as summaries in seconds.
+ */
+static void WritePrometheus(FILE* file, const ThreadMetrics_t* total)
+{
+    const LatencyHistogram_t* histogram = NULL;
+
+    for (int counter = 0; counter < METRIC_COUNTERS; counter++)
+    {
+        fprintf(file, "# TYPE sudoku_%s_total counter\nsudoku_%s_total %llu\n",
+            g_counterNames[counter], g_counterNames[counter], total->counters[counter]);
+    }
+    for (int i = 0; i < METRIC_HISTOGRAMS; i++)
+    {
+        histogram = &total->histograms[i];
+        fprintf(file, "# TYPE sudoku_%s_seconds summary\n", g_histogramNames[i]);
+        for (size_t q = 0; q < sizeof(g_quantiles) / sizeof(g_quantiles[0]); q++)
+        {
+            fprintf(file, "sudoku_%s_seconds{quantile=\"%g\"} %.9f\n",
+                g_histogramNames[i], g_quantiles[q], HistogramQuantile(histogram, g_quantiles[q]) / 1e9);
+        }
+        fprintf(file, "sudoku_%s_seconds_sum %.9f\nsudoku_%s_seconds_count %llu\n",
+            g_histogramNames[i], histogram->sum / 1e9, g_histogramNames[i], histogram->count);
+    }
+}
+
+void DumpMetrics(void)
+{
+    FILE* file = NULL;
+
+    if (!g_metricsLock)
+    {
+        return;
+    }
+
+    AcquireLock(g_metricsLock);
+    file = g_metricsPath ? fopen(g_metricsPath, "w") : stderr;
+    if (file)
+    {
+        MergeMetrics(&g_mergedMetrics);
+        if (g_metricsFormat == METRICS_PROMETHEUS)
+        {
+            WritePrometheus(file, &g_mergedMetrics);
+        }
+        else
+        {
+            WriteJson(file, &g_mergedMetrics);
+        }
+        if (file != stderr)
+        {
+            fclose(file);
+        }
+    }
+    ReleaseLock(g_metricsLock);
+}
+
+#ifdef _WIN32
+
+/**
+ * @brief The C runtime runs the Ctrl+Break handler on a thread of its own, so it can write the dump itself.
+ */
+static void OnDumpSignal(int signalNumber)
+{
+    DumpMetrics();
+    signal(signalNumber, OnDumpSignal);
+}
+
+static Errors StartDumpSignal(void)
+{
+    return signal(SIGBREAK, OnDumpSignal) == SIG_ERR ? ERR_GENERAL : ERR_OK;
+}
+
+static void StopDumpSignal(void)
+{
+    signal(SIGBREAK, SIG_DFL);
+}
+
+#else
+
+static void WaitForDumpSignal(void* arg)
+{
+    sigset_t* signals = (sigset_t*)arg;
+    int signalNumber = 0;
+
+    while (sigwait(signals, &signalNumber) == 0 && !g_metricsStopping)
+    {
+        DumpMetrics();
+    }
+}
+
+static Errors StartDumpSignal(void)
+{
+    static sigset_t signals;
+
+    // Threads started later inherit the mask, so only the waiting thread ever takes the signal
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    if (pthread_sigmask(SIG_BLOCK, &signals, NULL) != 0)
+    {
+        return ERR_GENERAL;
+    }
+    g_signalThread = StartThread(WaitForDumpSignal, &signals);
+
+    return g_signalThread ? ERR_OK : ERR_GENERAL;
+}
+
+static void StopDumpSignal(void)
+{
+    g_metricsStopping = 1;
+    kill(getpid(), SIGUSR1);
+    JoinThread(g_signalThread);
+    g_signalThread = NULL;
+}
+
+#endif
+
+/**
+ * @brief Writes the last dump and releases the blocks of every thread, the other threads are all joined by now.
+ */
+static void StopMetrics(void)
+{
+    ThreadMetrics_t* next = NULL;
+
+    StopDumpSignal();
+    DumpMetrics();
+
+    g_metricsStarted = 0;
+    for (ThreadMetrics_t* metrics = g_allMetrics; metrics; metrics = next)
+    {
+        next = metrics->next;
+        free(metrics);
+    }
+    g_allMetrics = NULL;
+    g_threadMetrics = NULL;
+    DestroyLock(g_metricsLock);
+    g_metricsLock = NULL;
+}
+
+Errors StartMetrics(MetricsFormat format, const char* path)
+{
+    if (g_metricsStarted)
+    {
+        return ERR_OK;
+    }
+    g_metricsLock = CreateLock();
+    if (!g_metricsLock)
+    {
+        return ERR_ALLOCATION_FAILED;
+    }
+    g_metricsFormat = format;
+    g_metricsPath = path;
+    if (StartDumpSignal() != ERR_OK)
+    {
+        DestroyLock(g_metricsLock);
+        g_metricsLock = NULL;
+        return ERR_GENERAL;
+    }
+
+    g_metricsStarted = 1;
+    atexit(StopMetrics);
+
+    return ERR_OK;
+}
+
+#else
+
+Errors StartMetrics(MetricsFormat format, const char* path)
+{
+    (void)format;
+    (void)path;
+
+    return ERR_GENERAL;
+}
+
+void DumpMetrics(void)
+{
+}
+
+#endif /*SUDOKU_METRICS*/
@@ -0,0 +1,159 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  Instrumentation of the hot paths: counters and latency histograms, kept per thread so recording
+    one never takes a lock or shares a cache line with another thread. A histogram is log-linear like an HDR histogram,
+    16 buckets for every power of two, so any latency from 1 ns up is kept within 6%.
+    Everything is compiled in only when SUDOKU_METRICS is defined; without it the METRIC_* macros expand to nothing.
+    With it, nothing is recorded until "StartMetrics" is called, and the merged results of every thread are written as
+    JSON or Prometheus text at exit and whenever the process receives SIGUSR1 (Ctrl+Break on Windows).
+***************************************************************************************/
+
+#ifndef __METRICS_H__
+#define __METRICS_H__
+
+typedef enum
+{
+    METRIC_MOVES,                       /* moves the players made, in the game and on the server */
+    METRIC_CANDIDATE_UPDATES,           /* calls of UpdatingPossibleDigits */
+    METRIC_CANDIDATES_REMOVED,          /* candidates UpdatingPossibleDigits removed from peer slots */
+    METRIC_PROPAGATIONS,                /* calls of PropagateSingles */
+    METRIC_UNITS_SCANNED,               /* units PropagateSingles looked at for hidden singles */
+    METRIC_SINGLES_PLACED,              /* digits PropagateSingles placed */
+    METRIC_ALLOCATIONS,                 /* calls of Allocate, AllocateZeroed and AllocateAligned */
+    METRIC_COUNTERS
+} MetricCounter;
+
+typedef enum
+{
+    METRIC_GENERATE_NS,                 /* CreateSudokuBoard */
+    METRIC_CANDIDATE_REBUILD_NS,        /* InitPossibleDigits */
+    METRIC_PROPAGATION_NS,              /* the forced fills of a turn in OneStage */
+    METRIC_INPUT_WAIT_NS,               /* from a prompt to the player's digit */
+    METRIC_RANKING_NS,                  /* RankPlayers */
+    METRIC_LEADERBOARD_NS,              /* AddToLeaderboard */
+    METRIC_HISTOGRAMS
+} MetricHistogram;
+
+typedef enum
+{
+    METRICS_JSON,
+    METRICS_PROMETHEUS
+} MetricsFormat;
+
+/**
+ * @brief Starts recording and installs the dumps at exit and on the signal.
+ *
+ * @param format: the format of the dumps.
+ * @param path: the file every dump overwrites, NULL for the standard error stream.
+ *
+ * @return ERR_OK, or ERR_GENERAL when the program was built without SUDOKU_METRICS.
+ */
+Errors StartMetrics(MetricsFormat format, const char* path);
+
+/**
+ * @brief Writes the merged counters and histograms of every thread. Threads that are still running may be a few records ahead.
+ */
+void DumpMetrics(void);
+
+#ifdef SUDOKU_METRICS
+
+#include "Bits.h"
+
+#if defined(_MSC_VER)
+#define METRICS_THREAD_LOCAL __declspec(thread)
+#else
+#define METRICS_THREAD_LOCAL _Thread_local
+#endif
+
+#define METRIC_SUB_BUCKET_BITS 4
+#define METRIC_SUB_BUCKETS (1 << METRIC_SUB_BUCKET_BITS)
+#define METRIC_BUCKETS ((64 - METRIC_SUB_BUCKET_BITS + 1) * METRIC_SUB_BUCKETS)
+
+typedef struct LatencyHistogram
+{
+    unsigned long long count;
+    unsigned long long sum;
+    unsigned long long max;
+    unsigned long long buckets[METRIC_BUCKETS];
+} LatencyHistogram_t;
+
+typedef struct ThreadMetrics
+{
+    unsigned long long counters[METRIC_COUNTERS];
+    LatencyHistogram_t histograms[METRIC_HISTOGRAMS];
+    struct ThreadMetrics* next;
+} ThreadMetrics_t;
+
+extern METRICS_THREAD_LOCAL ThreadMetrics_t* g_threadMetrics;
+extern int g_metricsStarted;
+
+/**
+ * @brief Gives the calling thread its own metrics, NULL while the metrics are not started.
+ */
+ThreadMetrics_t* JoinMetrics(void);
+
+unsigned long long MetricClock(void);
+
+/**
+ * @brief Returns the bucket of a value: the value itself below METRIC_SUB_BUCKETS, then METRIC_SUB_BUCKETS buckets per power of two.
+ */
+static inline int MetricBucket(unsigned long long value)
+{
+    int top = 0;
+
+    if (value < METRIC_SUB_BUCKETS)
+    {
+        return (int)value;
+    }
+    top = HighestBitIndex(value);
+
+    return (top - METRIC_SUB_BUCKET_BITS + 1) * METRIC_SUB_BUCKETS +
+        (int)((value >> (top - METRIC_SUB_BUCKET_BITS)) & (METRIC_SUB_BUCKETS - 1));
+}
+
+static inline void AddMetric(MetricCounter counter, unsigned long long amount)
+{
+    ThreadMetrics_t* metrics = g_threadMetrics ? g_threadMetrics : JoinMetrics();
+
+    if (metrics)
+    {
+        metrics->counters[counter] += amount;
+    }
+}
+
+static inline void RecordLatency(MetricHistogram histogram, unsigned long long startNs)
+{
+    ThreadMetrics_t* metrics = g_threadMetrics ? g_threadMetrics : JoinMetrics();
+    LatencyHistogram_t* latencies = NULL;
+    unsigned long long elapsed = 0;
+
+    if (!metrics || !startNs)
+    {
+        return;
+    }
+    elapsed = MetricClock() - startNs;
+    latencies = &metrics->histograms[histogram];
+    ++latencies->count;
+    latencies->sum += elapsed;
+    if (elapsed > latencies->max)
+    {
+        latencies->max = elapsed;
+    }
+    ++latencies->buckets[MetricBucket(elapsed)];
+}
+
+#define METRIC_ADD(counter, amount) AddMetric((counter), (amount))
+/* Declares 'name' and reads the clock into it, 0 while the metrics are not started */
+#define METRIC_START(name) unsigned long long name = MetricClock()
+#define METRIC_STOP(histogram, name) RecordLatency((histogram), (name))
+
+#else
+
+#define METRIC_ADD(counter, amount) ((void)0)
+#define METRIC_START(name)
+#define METRIC_STOP(histogram, name) ((void)0)
+
+#endif /*SUDOKU_METRICS*/
+
+#endif /*__METRICS_H__*/
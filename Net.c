@@ -0,0 +1,498 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  Thin wrappers over sockets and readiness notification, the networking counterpart of Platform.c.
+    On Linux the event loop is an epoll instance, so waiting costs O(ready sockets) however many are watched.
+    Everywhere else it is an array of poll descriptors handed to poll (WSAPoll on Windows) on every wait.
+***************************************************************************************/
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "Ws2_32.lib")
+#endif
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+#endif
+
+#include "Errors.h"
+#include "Net.h"
+#include "Platform.h"
+
+#define UNIX_ADDRESS_PREFIX "unix:"
+#define LOCALHOST "127.0.0.1"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#ifdef _WIN32
+#define NATIVE_SOCKET(socket) ((SOCKET)(socket))
+#define IS_WOULD_BLOCK() (WSAGetLastError() == WSAEWOULDBLOCK)
+#define IS_IN_PROGRESS() (WSAGetLastError() == WSAEWOULDBLOCK)
+#else
+#define NATIVE_SOCKET(socket) ((int)(socket))
+#define IS_WOULD_BLOCK() (errno == EAGAIN || errno == EWOULDBLOCK)
+#define IS_IN_PROGRESS() (errno == EINPROGRESS)
+#endif
+
+#if defined(__linux__)
+
+struct EventLoop
+{
+    int descriptor;
+    struct epoll_event* ready;
+    int capacity;
+};
+
+#else
+
+#ifdef _WIN32
+typedef WSAPOLLFD PollDescriptor_t;
+#define PollSockets(descriptors, count, timeoutMs) WSAPoll((descriptors), (ULONG)(count), (timeoutMs))
+#else
+typedef struct pollfd PollDescriptor_t;
+#define PollSockets(descriptors, count, timeoutMs) poll((descriptors), (nfds_t)(count), (timeoutMs))
+#endif
+
+struct EventLoop
+{
+    PollDescriptor_t* descriptors;
+    void** data;
+    size_t count;
+    size_t capacity;
+};
+
+#endif
+
+Errors StartNetworking(void)
+{
+#ifdef _WIN32
+    WSADATA data;
+
+    return WSAStartup(MAKEWORD(2, 2), &data) == 0 ? ERR_OK : ERR_GENERAL;
+#else
+    return ERR_OK;
+#endif
+}
+
+void StopNetworking(void)
+{
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+/**
+ * @brief Puts a socket in non blocking mode.
+ */
+static Errors SetNonBlocking(Socket_t socket)
+{
+#ifdef _WIN32
+    u_long on = 1;
+
+    return ioctlsocket(NATIVE_SOCKET(socket), FIONBIO, &on) == 0 ? ERR_OK : ERR_GENERAL;
+#else
+    int flags = fcntl(NATIVE_SOCKET(socket), F_GETFL, 0);
+
+    return flags >= 0 && fcntl(NATIVE_SOCKET(socket), F_SETFL, flags | O_NONBLOCK) == 0 ? ERR_OK : ERR_GENERAL;
+#endif
+}
+
+/**
+ * @brief Turns off Nagle's algorithm, the game sends small messages and waits for the answer.
+ */
+static void SetNoDelay(Socket_t socket)
+{
+    int on = 1;
+
+    setsockopt(NATIVE_SOCKET(socket), IPPROTO_TCP, TCP_NODELAY, (const char*)&on, sizeof(on));
+}
+
+/**
+ * @brief Fills the socket address of a TCP port of the local machine or of a Unix socket path.
+ *
+ * @return the length of the address, or 0 if the address is not valid.
+ */
+static int ParseAddress(const char* address, struct sockaddr_storage* storage, int bindAll)
+{
+    memset(storage, 0, sizeof(*storage));
+
+    if (strncmp(address, UNIX_ADDRESS_PREFIX, strlen(UNIX_ADDRESS_PREFIX)) == 0)
+    {
+#ifdef _WIN32
+        return 0;
+#else
+        struct sockaddr_un* local = (struct sockaddr_un*)storage;
+        const char* path = address + strlen(UNIX_ADDRESS_PREFIX);
+
+        if (!*path || strlen(path) >= sizeof(local->sun_path))
+        {
+            return 0;
+        }
+        local->sun_family = AF_UNIX;
+        strcpy(local->sun_path, path);
+        return (int)sizeof(struct sockaddr_un);
+#endif
+    }
+    else
+    {
+        struct sockaddr_in* inet = (struct sockaddr_in*)storage;
+        long port = strtol(address, NULL, 10);
+
+        if (port <= 0 || port > 65535)
+        {
+            return 0;
+        }
+        inet->sin_family = AF_INET;
+        inet->sin_port = htons((unsigned short)port);
+        inet->sin_addr.s_addr = bindAll ? htonl(INADDR_ANY) : inet_addr(LOCALHOST);
+        return (int)sizeof(struct sockaddr_in);
+    }
+}
+
+Errors ListenOn(const char* address, Socket_t* listener)
+{
+    struct sockaddr_storage storage;
+    int length = ParseAddress(address, &storage, 1), on = 1;
+    Socket_t handle = INVALID_SOCKET_HANDLE;
+
+    *listener = INVALID_SOCKET_HANDLE;
+    if (!length)
+    {
+        return ERR_GENERAL;
+    }
+
+    handle = (Socket_t)socket(storage.ss_family, SOCK_STREAM, 0);
+    if (handle == INVALID_SOCKET_HANDLE)
+    {
+        return ERR_GENERAL;
+    }
+#ifndef _WIN32
+    if (storage.ss_family == AF_UNIX)
+    {
+        unlink(((struct sockaddr_un*)&storage)->sun_path);
+    }
+#endif
+    setsockopt(NATIVE_SOCKET(handle), SOL_SOCKET, SO_REUSEADDR, (const char*)&on, sizeof(on));
+
+    if (bind(NATIVE_SOCKET(handle), (struct sockaddr*)&storage, length) != 0 || listen(NATIVE_SOCKET(handle), SOMAXCONN) != 0 ||
+        SetNonBlocking(handle) != ERR_OK)
+    {
+        CloseSocket(handle);
+        return ERR_GENERAL;
+    }
+
+    *listener = handle;
+
+    return ERR_OK;
+}
+
+Errors ConnectTo(const char* address, Socket_t* connection)
+{
+    struct sockaddr_storage storage;
+    int length = ParseAddress(address, &storage, 0);
+    Socket_t handle = INVALID_SOCKET_HANDLE;
+
+    *connection = INVALID_SOCKET_HANDLE;
+    if (!length)
+    {
+        return ERR_GENERAL;
+    }
+
+    handle = (Socket_t)socket(storage.ss_family, SOCK_STREAM, 0);
+    if (handle == INVALID_SOCKET_HANDLE)
+    {
+        return ERR_GENERAL;
+    }
+    if (SetNonBlocking(handle) != ERR_OK ||
+        (connect(NATIVE_SOCKET(handle), (struct sockaddr*)&storage, length) != 0 && !IS_IN_PROGRESS()))
+    {
+        CloseSocket(handle);
+        return ERR_GENERAL;
+    }
+    if (storage.ss_family == AF_INET)
+    {
+        SetNoDelay(handle);
+    }
+
+    *connection = handle;
+
+    return ERR_OK;
+}
+
+Socket_t AcceptConnection(Socket_t listener)
+{
+    struct sockaddr_storage storage;
+    socklen_t length = sizeof(storage);
+    Socket_t handle = (Socket_t)accept(NATIVE_SOCKET(listener), (struct sockaddr*)&storage, &length);
+
+    if (handle == INVALID_SOCKET_HANDLE)
+    {
+        return INVALID_SOCKET_HANDLE;
+    }
+    if (SetNonBlocking(handle) != ERR_OK)
+    {
+        CloseSocket(handle);
+        return INVALID_SOCKET_HANDLE;
+    }
+    if (storage.ss_family == AF_INET)
+    {
+        SetNoDelay(handle);
+    }
+
+    return handle;
+}
+
+void CloseSocket(Socket_t socket)
+{
+    if (socket == INVALID_SOCKET_HANDLE)
+    {
+        return;
+    }
+#ifdef _WIN32
+    closesocket(NATIVE_SOCKET(socket));
+#else
+    close(NATIVE_SOCKET(socket));
+#endif
+}
+
+long SendSome(Socket_t socket, const char* buffer, size_t size)
+{
+    long sent = (long)send(NATIVE_SOCKET(socket), buffer, (int)size, MSG_NOSIGNAL);
+
+    if (sent < 0)
+    {
+        return IS_WOULD_BLOCK() ? NET_WOULD_BLOCK : -1;
+    }
+
+    return sent;
+}
+
+long ReceiveSome(Socket_t socket, char* buffer, size_t size)
+{
+    long received = (long)recv(NATIVE_SOCKET(socket), buffer, (int)size, 0);
+
+    if (received < 0)
+    {
+        return IS_WOULD_BLOCK() ? NET_WOULD_BLOCK : -1;
+    }
+
+    return received;
+}
+
+#if defined(__linux__)
+
+EventLoop_t* CreateEventLoop(size_t capacity)
+{
+    EventLoop_t* loop = NULL;
+
+    loop = (EventLoop_t*)AllocateZeroed(1, sizeof(EventLoop_t));
+    if (!loop)
+    {
+        return NULL;
+    }
+    loop->capacity = (int)capacity;
+    loop->ready = (struct epoll_event*)Allocate(capacity * sizeof(struct epoll_event));
+    loop->descriptor = epoll_create1(0);
+    if (!loop->ready || loop->descriptor < 0)
+    {
+        DestroyEventLoop(loop);
+        return NULL;
+    }
+
+    return loop;
+}
+
+void DestroyEventLoop(EventLoop_t* loop)
+{
+    if (!loop)
+    {
+        return;
+    }
+    if (loop->descriptor >= 0)
+    {
+        close(loop->descriptor);
+    }
+    free(loop->ready);
+    free(loop);
+}
+
+Errors WatchSocket(EventLoop_t* loop, Socket_t socket, int events, void* data)
+{
+    struct epoll_event event;
+
+    event.events = ((events & NET_EVENT_READ) ? EPOLLIN : 0) | ((events & NET_EVENT_WRITE) ? EPOLLOUT : 0);
+    event.data.ptr = data;
+
+    if (epoll_ctl(loop->descriptor, EPOLL_CTL_MOD, NATIVE_SOCKET(socket), &event) == 0)
+    {
+        return ERR_OK;
+    }
+
+    return errno == ENOENT && epoll_ctl(loop->descriptor, EPOLL_CTL_ADD, NATIVE_SOCKET(socket), &event) == 0 ? ERR_OK : ERR_GENERAL;
+}
+
+void UnwatchSocket(EventLoop_t* loop, Socket_t socket)
+{
+    struct epoll_event event = { 0 };
+
+    epoll_ctl(loop->descriptor, EPOLL_CTL_DEL, NATIVE_SOCKET(socket), &event);
+}
+
+int WaitForEvents(EventLoop_t* loop, NetEvent_t* events, int maxEvents, int timeoutMs)
+{
+    int count = 0;
+
+    if (maxEvents > loop->capacity)
+    {
+        maxEvents = loop->capacity;
+    }
+
+    count = epoll_wait(loop->descriptor, loop->ready, maxEvents, timeoutMs);
+    if (count < 0)
+    {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        events[i].data = loop->ready[i].data.ptr;
+        events[i].events = ((loop->ready[i].events & EPOLLIN) ? NET_EVENT_READ : 0) |
+            ((loop->ready[i].events & EPOLLOUT) ? NET_EVENT_WRITE : 0) |
+            ((loop->ready[i].events & (EPOLLERR | EPOLLHUP)) ? NET_EVENT_CLOSED : 0);
+    }
+
+    return count;
+}
+
+#else
+
+EventLoop_t* CreateEventLoop(size_t capacity)
+{
+    EventLoop_t* loop = NULL;
+
+    loop = (EventLoop_t*)AllocateZeroed(1, sizeof(EventLoop_t));
+    if (!loop)
+    {
+        return NULL;
+    }
+    loop->capacity = capacity;
+    loop->descriptors = (PollDescriptor_t*)Allocate(capacity * sizeof(PollDescriptor_t));
+    loop->data = (void**)Allocate(capacity * sizeof(void*));
+    if (!loop->descriptors || !loop->data)
+    {
+        DestroyEventLoop(loop);
+        return NULL;
+    }
+
+    return loop;
+}
+
+void DestroyEventLoop(EventLoop_t* loop)
+{
+    if (!loop)
+    {
+        return;
+    }
+    free(loop->descriptors);
+    free(loop->data);
+    free(loop);
+}
+
+/**
+ * @brief Returns the index of a watched socket, or the number of watched sockets if it is not watched.
+ */
+static size_t FindWatchedSocket(const EventLoop_t* loop, Socket_t socket)
+{
+    size_t i = 0;
+
+    while (i < loop->count && (Socket_t)loop->descriptors[i].fd != socket)
+    {
+        i++;
+    }
+
+    return i;
+}
+
+Errors WatchSocket(EventLoop_t* loop, Socket_t socket, int events, void* data)
+{
+    size_t i = FindWatchedSocket(loop, socket);
+
+    if (i == loop->count)
+    {
+        if (loop->count == loop->capacity)
+        {
+            return ERR_GENERAL;
+        }
+        ++loop->count;
+    }
+    loop->descriptors[i].fd = NATIVE_SOCKET(socket);
+    loop->descriptors[i].events = (short)(((events & NET_EVENT_READ) ? POLLIN : 0) | ((events & NET_EVENT_WRITE) ? POLLOUT : 0));
+    loop->descriptors[i].revents = 0;
+    loop->data[i] = data;
+
+    return ERR_OK;
+}
+
+void UnwatchSocket(EventLoop_t* loop, Socket_t socket)
+{
+    size_t i = FindWatchedSocket(loop, socket);
+
+    if (i < loop->count)
+    {
+        --loop->count;
+        loop->descriptors[i] = loop->descriptors[loop->count];
+        loop->data[i] = loop->data[loop->count];
+    }
+}
+
+int WaitForEvents(EventLoop_t* loop, NetEvent_t* events, int maxEvents, int timeoutMs)
+{
+    int ready = PollSockets(loop->descriptors, loop->count, timeoutMs), count = 0;
+
+    if (ready < 0)
+    {
+        return -1;
+    }
+
+    for (size_t i = 0; i < loop->count && count < maxEvents; i++)
+    {
+        short revents = loop->descriptors[i].revents;
+
+        if (!revents)
+        {
+            continue;
+        }
+        events[count].data = loop->data[i];
+        events[count].events = ((revents & POLLIN) ? NET_EVENT_READ : 0) | ((revents & POLLOUT) ? NET_EVENT_WRITE : 0) |
+            ((revents & (POLLERR | POLLHUP | POLLNVAL)) ? NET_EVENT_CLOSED : 0);
+        ++count;
+    }
+
+    return count;
+}
+
+#endif
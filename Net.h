@@ -0,0 +1,124 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  Thin wrappers over sockets and readiness notification, the networking counterpart of Platform.h.
+    Every socket is non blocking. An event loop watches many sockets from one thread and reports the ones that
+    can be read or written: it is built on epoll on Linux and on poll (WSAPoll on Windows) everywhere else.
+    An address is either a TCP port ("5000") or a Unix socket path ("unix:/tmp/sudoku.sock"). A TCP port is listened on
+    on every interface and connected to on the local machine.
+***************************************************************************************/
+
+#ifndef __NET_H__
+#define __NET_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define NET_EVENT_READ 1
+#define NET_EVENT_WRITE 2
+#define NET_EVENT_CLOSED 4              /* the peer hung up or the socket failed */
+
+#define NET_WOULD_BLOCK (-2)
+
+typedef intptr_t Socket_t;
+
+#define INVALID_SOCKET_HANDLE ((Socket_t)-1)
+
+typedef struct EventLoop EventLoop_t;
+
+typedef struct NetEvent
+{
+    void* data;                         /* what the socket was watched with */
+    int events;                         /* NET_EVENT_* bits */
+} NetEvent_t;
+
+
+/**
+ * @brief Prepares the socket library, must be called once before any other function of this file.
+ *
+ * @return ERR_OK on success, ERR_GENERAL if the socket library is not available.
+ */
+Errors StartNetworking(void);
+
+void StopNetworking(void);
+
+/**
+ * @brief Opens a non blocking socket listening on an address.
+ *
+ * @param address: a TCP port or "unix:" followed by a path, an old socket file at the path is replaced.
+ * @param listener: receives the socket.
+ *
+ * @return ERR_OK on success, ERR_GENERAL if the address is not valid or cannot be listened on.
+ */
+Errors ListenOn(const char* address, Socket_t* listener);
+
+/**
+ * @brief Opens a non blocking socket connected to an address of the local machine, the connection may still be in progress.
+ *
+ * @return ERR_OK on success, ERR_GENERAL if the connection failed.
+ */
+Errors ConnectTo(const char* address, Socket_t* connection);
+
+/**
+ * @brief Accepts a waiting connection as a non blocking socket.
+ *
+ * @return the socket, or INVALID_SOCKET_HANDLE when no connection is waiting.
+ */
+Socket_t AcceptConnection(Socket_t listener);
+
+void CloseSocket(Socket_t socket);
+
+/**
+ * @brief Sends as much of a buffer as the socket takes without blocking.
+ *
+ * @return the number of bytes sent, NET_WOULD_BLOCK if none could be sent now, or -1 if the connection failed.
+ */
+long SendSome(Socket_t socket, const char* buffer, size_t size);
+
+/**
+ * @brief Receives what is waiting on a socket without blocking.
+ *
+ * @return the number of bytes received, 0 once the peer closed the connection,
+ *  NET_WOULD_BLOCK if nothing is waiting, or -1 if the connection failed.
+ */
+long ReceiveSome(Socket_t socket, char* buffer, size_t size);
+
+/**
+ * @brief Creates an event loop for up to 'capacity' sockets.
+ *
+ * @return the event loop, or NULL if it could not be created.
+ */
+EventLoop_t* CreateEventLoop(size_t capacity);
+
+void DestroyEventLoop(EventLoop_t* loop);
+
+/**
+ * @brief Starts watching a socket, or changes the events a watched socket is watched for.
+ *
+ * @param loop: the event loop.
+ * @param socket: the socket.
+ * @param events: NET_EVENT_READ and/or NET_EVENT_WRITE.
+ * @param data: reported back with every event of the socket.
+ *
+ * @return ERR_OK on success, ERR_GENERAL if the socket could not be watched.
+ */
+Errors WatchSocket(EventLoop_t* loop, Socket_t socket, int events, void* data);
+
+/**
+ * @brief Stops watching a socket, must be called before the socket is closed.
+ */
+void UnwatchSocket(EventLoop_t* loop, Socket_t socket);
+
+/**
+ * @brief Waits for watched sockets to be ready.
+ *
+ * @param loop: the event loop.
+ * @param events: receives the ready sockets.
+ * @param maxEvents: the size of 'events'.
+ * @param timeoutMs: how long to wait at most, -1 to wait until a socket is ready.
+ *
+ * @return the number of events stored, 0 on a timeout, or -1 if waiting failed.
+ */
+int WaitForEvents(EventLoop_t* loop, NetEvent_t* events, int maxEvents, int timeoutMs);
+
+#endif /*__NET_H__*/
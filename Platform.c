@@ -0,0 +1,722 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  Thin wrappers over the operating system services the headless modes need,
+    so the rest of the game does not have to care whether it runs on Windows or on a POSIX system.
+    The "MapFile" function maps a whole file read only into memory and "UnmapFile" releases it.
+    The "GetTimeNs" function reads a monotonic clock in nanoseconds.
+    "AllocateAligned" and "FreeAligned" hand out memory that starts on a given boundary, such as a cache line,
+    "Allocate" and "AllocateZeroed" stand for malloc and calloc, every allocation of the program goes through one of them
+    and is counted, and "GetPeakMemory" reports the most memory the process held.
+    "ReplaceFileContents" writes a file next to the old one and renames it over it once it is on the disk.
+    The thread, lock and condition functions are the minimal set the worker pools are built on.
+***************************************************************************************/
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#include <psapi.h>
+#ifndef ENABLE_VIRTUAL_TERMINAL_PROCESSING
+#define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004
+#endif
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "Errors.h"
+#include "Platform.h"
+#include "Metrics.h"
+
+struct Thread
+{
+    ThreadFunction_t function;
+    void* arg;
+#ifdef _WIN32
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+};
+
+struct Lock
+{
+#ifdef _WIN32
+    CRITICAL_SECTION section;
+#else
+    pthread_mutex_t mutex;
+#endif
+};
+
+struct Condition
+{
+#ifdef _WIN32
+    CONDITION_VARIABLE variable;
+#else
+    pthread_cond_t variable;
+#endif
+};
+
+// Every allocation of the program is counted here, from whatever thread makes it
+#ifdef _WIN32
+static volatile LONG64 g_allocationCount = 0;
+#else
+static atomic_ullong g_allocationCount = 0;
+#endif
+
+static void CountAllocation(void)
+{
+#ifdef _WIN32
+    InterlockedIncrement64(&g_allocationCount);
+#else
+    atomic_fetch_add_explicit(&g_allocationCount, 1, memory_order_relaxed);
+#endif
+    METRIC_ADD(METRIC_ALLOCATIONS, 1);
+}
+
+unsigned long long GetAllocationCount(void)
+{
+#ifdef _WIN32
+    return (unsigned long long)InterlockedCompareExchange64(&g_allocationCount, 0, 0);
+#else
+    return atomic_load_explicit(&g_allocationCount, memory_order_relaxed);
+#endif
+}
+
+void* Allocate(size_t size)
+{
+    CountAllocation();
+    return malloc(size);
+}
+
+void* AllocateZeroed(size_t count, size_t size)
+{
+    CountAllocation();
+    return calloc(count, size);
+}
+
+/**
+ * @brief Returns "<path>.tmp" in memory the caller frees, NULL if it could not be allocated.
+ */
+static char* TemporaryPath(const char* path)
+{
+    size_t length = strlen(path);
+    char* temporary = (char*)Allocate(length + sizeof(".tmp"));
+
+    if (temporary)
+    {
+        memcpy(temporary, path, length);
+        memcpy(temporary + length, ".tmp", sizeof(".tmp"));
+    }
+
+    return temporary;
+}
+
+#ifdef _WIN32
+
+Errors MapFile(const char* path, MappedFile_t* file)
+{
+    LARGE_INTEGER size;
+    HANDLE fileHandle, mappingHandle;
+
+    file->data = NULL;
+    file->size = 0;
+    file->fileHandle = file->mappingHandle = NULL;
+
+    fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        return ERR_GENERAL;
+    }
+    if (!GetFileSizeEx(fileHandle, &size))
+    {
+        CloseHandle(fileHandle);
+        return ERR_GENERAL;
+    }
+    if (size.QuadPart == 0)
+    {
+        // An empty file cannot be mapped, but it is a valid (empty) input
+        CloseHandle(fileHandle);
+        return ERR_OK;
+    }
+
+    mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mappingHandle)
+    {
+        CloseHandle(fileHandle);
+        return ERR_GENERAL;
+    }
+    file->data = (const char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (!file->data)
+    {
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        return ERR_GENERAL;
+    }
+
+    file->size = (size_t)size.QuadPart;
+    file->fileHandle = fileHandle;
+    file->mappingHandle = mappingHandle;
+
+    return ERR_OK;
+}
+
+void UnmapFile(MappedFile_t* file)
+{
+    if (file->data)
+    {
+        UnmapViewOfFile(file->data);
+        CloseHandle(file->mappingHandle);
+        CloseHandle(file->fileHandle);
+    }
+    file->data = NULL;
+    file->size = 0;
+}
+
+unsigned long long GetTimeNs(void)
+{
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    if (!frequency.QuadPart)
+    {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+
+    return (unsigned long long)(counter.QuadPart / frequency.QuadPart) * 1000000000ull +
+        (unsigned long long)(counter.QuadPart % frequency.QuadPart) * 1000000000ull / frequency.QuadPart;
+}
+
+void SleepMs(unsigned int milliseconds)
+{
+    Sleep(milliseconds);
+}
+
+void YieldThread(void)
+{
+    SwitchToThread();
+}
+
+void* AllocateAligned(size_t alignment, size_t size)
+{
+    CountAllocation();
+    return _aligned_malloc(size, alignment);
+}
+
+void FreeAligned(void* memory)
+{
+    _aligned_free(memory);
+}
+
+size_t GetPeakMemory(void)
+{
+    PROCESS_MEMORY_COUNTERS counters;
+
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return 0;
+    }
+
+    return counters.PeakWorkingSetSize;
+}
+
+int GetProcessorCount(void)
+{
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+
+Errors WriteOutput(const char* data, size_t size)
+{
+    static int virtualTerminal = 0;
+    HANDLE output = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0, written = 0;
+
+    // Without this mode a console prints the escape sequences instead of acting on them
+    if (!virtualTerminal && GetConsoleMode(output, &mode))
+    {
+        SetConsoleMode(output, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    }
+    virtualTerminal = 1;
+
+    while (size)
+    {
+        if (!WriteFile(output, data, (DWORD)size, &written, NULL))
+        {
+            return ERR_GENERAL;
+        }
+        data += written;
+        size -= written;
+    }
+
+    return ERR_OK;
+}
+
+Errors ReplaceFileContents(const char* path, const void* data, size_t size)
+{
+    char* temporary = TemporaryPath(path);
+    HANDLE file = INVALID_HANDLE_VALUE;
+    const char* next = (const char*)data;
+    DWORD written = 0;
+    Errors eErr = ERR_OK;
+
+    if (!temporary)
+    {
+        return ERR_ALLOCATION_FAILED;
+    }
+    file = CreateFileA(temporary, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        free(temporary);
+        return ERR_GENERAL;
+    }
+    while (size)
+    {
+        if (!WriteFile(file, next, size > 0x40000000 ? 0x40000000 : (DWORD)size, &written, NULL))
+        {
+            eErr = ERR_GENERAL;
+            break;
+        }
+        next += written;
+        size -= written;
+    }
+    if (eErr == ERR_OK && !FlushFileBuffers(file))
+    {
+        eErr = ERR_GENERAL;
+    }
+    CloseHandle(file);
+    if (eErr == ERR_OK && !MoveFileExA(temporary, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+    {
+        eErr = ERR_GENERAL;
+    }
+    free(temporary);
+
+    return eErr;
+}
+
+static unsigned __stdcall ThreadEntry(void* arg)
+{
+    Thread_t* thread = (Thread_t*)arg;
+
+    thread->function(thread->arg);
+
+    return 0;
+}
+
+Thread_t* StartThread(ThreadFunction_t function, void* arg)
+{
+    Thread_t* thread = NULL;
+
+    thread = (Thread_t*)Allocate(sizeof(Thread_t));
+    if (!thread)
+    {
+        return NULL;
+    }
+    thread->function = function;
+    thread->arg = arg;
+    thread->handle = (HANDLE)_beginthreadex(NULL, 0, ThreadEntry, thread, 0, NULL);
+    if (!thread->handle)
+    {
+        free(thread);
+        return NULL;
+    }
+
+    return thread;
+}
+
+void JoinThread(Thread_t* thread)
+{
+    if (!thread)
+    {
+        return;
+    }
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+    free(thread);
+}
+
+Lock_t* CreateLock(void)
+{
+    Lock_t* lock = NULL;
+
+    lock = (Lock_t*)Allocate(sizeof(Lock_t));
+    if (!lock)
+    {
+        return NULL;
+    }
+    InitializeCriticalSection(&lock->section);
+
+    return lock;
+}
+
+void DestroyLock(Lock_t* lock)
+{
+    if (!lock)
+    {
+        return;
+    }
+    DeleteCriticalSection(&lock->section);
+    free(lock);
+}
+
+void AcquireLock(Lock_t* lock)
+{
+    EnterCriticalSection(&lock->section);
+}
+
+void ReleaseLock(Lock_t* lock)
+{
+    LeaveCriticalSection(&lock->section);
+}
+
+Condition_t* CreateCondition(void)
+{
+    Condition_t* condition = NULL;
+
+    condition = (Condition_t*)Allocate(sizeof(Condition_t));
+    if (!condition)
+    {
+        return NULL;
+    }
+    InitializeConditionVariable(&condition->variable);
+
+    return condition;
+}
+
+void DestroyCondition(Condition_t* condition)
+{
+    free(condition);
+}
+
+void WaitCondition(Condition_t* condition, Lock_t* lock)
+{
+    SleepConditionVariableCS(&condition->variable, &lock->section, INFINITE);
+}
+
+void SignalCondition(Condition_t* condition)
+{
+    WakeConditionVariable(&condition->variable);
+}
+
+void BroadcastCondition(Condition_t* condition)
+{
+    WakeAllConditionVariable(&condition->variable);
+}
+
+#else
+
+Errors MapFile(const char* path, MappedFile_t* file)
+{
+    struct stat info;
+    void* data = NULL;
+    int fd = 0;
+
+    file->data = NULL;
+    file->size = 0;
+    file->fileHandle = file->mappingHandle = NULL;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return ERR_GENERAL;
+    }
+    if (fstat(fd, &info) != 0)
+    {
+        close(fd);
+        return ERR_GENERAL;
+    }
+    if (info.st_size == 0)
+    {
+        // An empty file cannot be mapped, but it is a valid (empty) input
+        close(fd);
+        return ERR_OK;
+    }
+
+    data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        return ERR_GENERAL;
+    }
+    posix_madvise(data, (size_t)info.st_size, POSIX_MADV_SEQUENTIAL);
+
+    file->data = (const char*)data;
+    file->size = (size_t)info.st_size;
+
+    return ERR_OK;
+}
+
+void UnmapFile(MappedFile_t* file)
+{
+    if (file->data)
+    {
+        munmap((void*)file->data, file->size);
+    }
+    file->data = NULL;
+    file->size = 0;
+}
+
+unsigned long long GetTimeNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (unsigned long long)now.tv_sec * 1000000000ull + (unsigned long long)now.tv_nsec;
+}
+
+void SleepMs(unsigned int milliseconds)
+{
+    struct timespec wait;
+
+    wait.tv_sec = milliseconds / 1000;
+    wait.tv_nsec = (long)(milliseconds % 1000) * 1000000L;
+    // A signal cuts the sleep short, the rest of it is slept again
+    while (nanosleep(&wait, &wait) != 0 && errno == EINTR)
+    {
+    }
+}
+
+void YieldThread(void)
+{
+    sched_yield();
+}
+
+void* AllocateAligned(size_t alignment, size_t size)
+{
+    void* memory = NULL;
+
+    CountAllocation();
+    return posix_memalign(&memory, alignment, size) == 0 ? memory : NULL;
+}
+
+void FreeAligned(void* memory)
+{
+    free(memory);
+}
+
+size_t GetPeakMemory(void)
+{
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+#ifdef __APPLE__
+    return (size_t)usage.ru_maxrss;
+#else
+    // Linux reports the peak in kilobytes
+    return (size_t)usage.ru_maxrss * 1024;
+#endif
+}
+
+int GetProcessorCount(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return count > 0 ? (int)count : 1;
+}
+
+Errors WriteOutput(const char* data, size_t size)
+{
+    ssize_t written = 0;
+
+    while (size)
+    {
+        written = write(STDOUT_FILENO, data, size);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return ERR_GENERAL;
+        }
+        data += written;
+        size -= (size_t)written;
+    }
+
+    return ERR_OK;
+}
+
+Errors ReplaceFileContents(const char* path, const void* data, size_t size)
+{
+    char* temporary = TemporaryPath(path);
+    const char* next = (const char*)data;
+    ssize_t written = 0;
+    Errors eErr = ERR_OK;
+    int file = -1;
+
+    if (!temporary)
+    {
+        return ERR_ALLOCATION_FAILED;
+    }
+    file = open(temporary, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file < 0)
+    {
+        free(temporary);
+        return ERR_GENERAL;
+    }
+    while (size)
+    {
+        written = write(file, next, size);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            eErr = ERR_GENERAL;
+            break;
+        }
+        next += written;
+        size -= (size_t)written;
+    }
+    if (eErr == ERR_OK && fsync(file) != 0)
+    {
+        eErr = ERR_GENERAL;
+    }
+    close(file);
+    if (eErr == ERR_OK && rename(temporary, path) != 0)
+    {
+        eErr = ERR_GENERAL;
+    }
+    free(temporary);
+
+    return eErr;
+}
+
+static void* ThreadEntry(void* arg)
+{
+    Thread_t* thread = (Thread_t*)arg;
+
+    thread->function(thread->arg);
+
+    return NULL;
+}
+
+Thread_t* StartThread(ThreadFunction_t function, void* arg)
+{
+    Thread_t* thread = NULL;
+
+    thread = (Thread_t*)Allocate(sizeof(Thread_t));
+    if (!thread)
+    {
+        return NULL;
+    }
+    thread->function = function;
+    thread->arg = arg;
+    if (pthread_create(&thread->handle, NULL, ThreadEntry, thread) != 0)
+    {
+        free(thread);
+        return NULL;
+    }
+
+    return thread;
+}
+
+void JoinThread(Thread_t* thread)
+{
+    if (!thread)
+    {
+        return;
+    }
+    pthread_join(thread->handle, NULL);
+    free(thread);
+}
+
+Lock_t* CreateLock(void)
+{
+    Lock_t* lock = NULL;
+
+    lock = (Lock_t*)Allocate(sizeof(Lock_t));
+    if (!lock)
+    {
+        return NULL;
+    }
+    pthread_mutex_init(&lock->mutex, NULL);
+
+    return lock;
+}
+
+void DestroyLock(Lock_t* lock)
+{
+    if (!lock)
+    {
+        return;
+    }
+    pthread_mutex_destroy(&lock->mutex);
+    free(lock);
+}
+
+void AcquireLock(Lock_t* lock)
+{
+    pthread_mutex_lock(&lock->mutex);
+}
+
+void ReleaseLock(Lock_t* lock)
+{
+    pthread_mutex_unlock(&lock->mutex);
+}
+
+Condition_t* CreateCondition(void)
+{
+    Condition_t* condition = NULL;
+
+    condition = (Condition_t*)Allocate(sizeof(Condition_t));
+    if (!condition)
+    {
+        return NULL;
+    }
+    pthread_cond_init(&condition->variable, NULL);
+
+    return condition;
+}
+
+void DestroyCondition(Condition_t* condition)
+{
+    if (!condition)
+    {
+        return;
+    }
+    pthread_cond_destroy(&condition->variable);
+    free(condition);
+}
+
+void WaitCondition(Condition_t* condition, Lock_t* lock)
+{
+    pthread_cond_wait(&condition->variable, &lock->mutex);
+}
+
+void SignalCondition(Condition_t* condition)
+{
+    pthread_cond_signal(&condition->variable);
+}
+
+void BroadcastCondition(Condition_t* condition)
+{
+    pthread_cond_broadcast(&condition->variable);
+}
+
+#endif
@@ -0,0 +1,156 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  Thin wrappers over the operating system services the headless modes need,
+    so the rest of the game does not have to care whether it runs on Windows or on a POSIX system.
+    The "MapFile" function maps a whole file read only into memory and "UnmapFile" releases it.
+    The "GetTimeNs" function reads a monotonic clock in nanoseconds, "SleepMs" waits without using the processor
+    and "YieldThread" lets another thread run in a short wait.
+    "AllocateAligned" and "FreeAligned" hand out memory that starts on a given boundary, such as a cache line,
+    "Allocate" and "AllocateZeroed" stand for malloc and calloc, every allocation of the program goes through one of them
+    and is counted, and "GetPeakMemory" reports the most memory the process held.
+    "WriteOutput" writes a whole buffer to the standard output with one system call where the system allows it.
+    "ReplaceFileContents" writes a whole file so that a reader sees either the old contents or the new ones.
+    The thread, lock and condition functions are the minimal set the worker pools are built on.
+***************************************************************************************/
+
+#ifndef __PLATFORM_H__
+#define __PLATFORM_H__
+
+#include <stddef.h>
+
+#define CACHE_LINE_SIZE 64
+
+typedef struct MappedFile
+{
+    const char* data;
+    size_t size;
+    void* fileHandle;
+    void* mappingHandle;
+} MappedFile_t;
+
+typedef struct Thread Thread_t;
+
+typedef struct Lock Lock_t;
+
+typedef struct Condition Condition_t;
+
+typedef void (*ThreadFunction_t)(void* arg);
+
+
+/**
+ * @brief Maps a file read only into memory.
+ *
+ * @param path: the path of the file.
+ * @param file: receives the address and size of the mapping.
+ *
+ * @return ERR_OK on success, ERR_GENERAL if the file cannot be opened or mapped.
+ */
+Errors MapFile(const char* path, MappedFile_t* file);
+
+void UnmapFile(MappedFile_t* file);
+
+/**
+ * @brief Returns the value of a monotonic clock in nanoseconds.
+ */
+unsigned long long GetTimeNs(void);
+
+/**
+ * @brief Suspends the calling thread for at least 'milliseconds'.
+ */
+void SleepMs(unsigned int milliseconds);
+
+/**
+ * @brief Gives the rest of the calling thread's time slice to another thread that is ready to run, for a wait of a few instructions.
+ */
+void YieldThread(void);
+
+/**
+ * @brief Allocates memory that starts on a multiple of 'alignment'.
+ *
+ * @param alignment: a power of two, at least the size of a pointer.
+ * @param size: the number of bytes.
+ *
+ * @return the memory, or NULL if it could not be allocated. It must be released with FreeAligned.
+ */
+void* AllocateAligned(size_t alignment, size_t size);
+
+void FreeAligned(void* memory);
+
+/**
+ * @brief Stand for malloc and calloc and count the allocation, the memory is released with free.
+ *  The program allocates only through these and AllocateAligned.
+ */
+void* Allocate(size_t size);
+
+void* AllocateZeroed(size_t count, size_t size);
+
+/**
+ * @brief Returns how many allocations the whole process made so far, from every thread.
+ *  The difference of two readings is how much a stretch of code allocated, along with what other threads allocated meanwhile.
+ */
+unsigned long long GetAllocationCount(void);
+
+/**
+ * @brief Returns the most physical memory the process held so far in bytes, 0 if the system does not tell.
+ */
+size_t GetPeakMemory(void);
+
+/**
+ * @brief Returns the number of logical processors of the machine (at least 1).
+ */
+int GetProcessorCount(void);
+
+/**
+ * @brief Writes a buffer straight to the standard output, past the buffer of stdio, so a whole frame of the
+ *  terminal reaches it at once. On Windows the first call also turns on the escape sequences of the console.
+ *  Whatever was printed with stdio must be flushed first.
+ *
+ * @return ERR_OK, or ERR_GENERAL if the output is closed.
+ */
+Errors WriteOutput(const char* data, size_t size);
+
+/**
+ * @brief Writes a buffer to "<path>.tmp" in one sequential pass, flushes it to the disk and renames it over 'path',
+ *  so a process that dies at any point leaves either the old file or the new one.
+ *
+ * @return ERR_OK, ERR_ALLOCATION_FAILED, or ERR_GENERAL if the file cannot be written or renamed.
+ */
+Errors ReplaceFileContents(const char* path, const void* data, size_t size);
+
+/**
+ * @brief Starts a thread running function(arg).
+ *
+ * @return the thread, or NULL if it could not be started.
+ */
+Thread_t* StartThread(ThreadFunction_t function, void* arg);
+
+/**
+ * @brief Waits for a thread to return and frees it.
+ */
+void JoinThread(Thread_t* thread);
+
+Lock_t* CreateLock(void);
+
+void DestroyLock(Lock_t* lock);
+
+void AcquireLock(Lock_t* lock);
+
+void ReleaseLock(Lock_t* lock);
+
+Condition_t* CreateCondition(void);
+
+void DestroyCondition(Condition_t* condition);
+
+/**
+ * @brief Atomically releases the lock and waits for the condition, the lock is held again on return.
+ */
+void WaitCondition(Condition_t* condition, Lock_t* lock);
+
+void SignalCondition(Condition_t* condition);
+
+void BroadcastCondition(Condition_t* condition);
+
+
+
+#endif /*__PLATFORM_H__*/
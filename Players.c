@@ -3,13 +3,14 @@
     Creation date :  21/01/23
     Description : This file contains functions related to managing a list of players in a game.
     The functions allows you to create a new player, create a list of active players, create an array of players from the linked list of active players and
-    sort the array of active players using the merge sort algorithm,
-    Create a binary tree from the orderly array, and scan the binary tree using the inOrder algorithm.
-    This file also includes functionality for determining whether a player has completed the game successfully, and if so, moving them to a list of winning players
-    and removing them from the active players list and their cell in the binary tree is set to NULL.
-    If a player has not completed the game, they can fill in the slot on their board that has the least number of options.
-    If a player's board is a failure, they are removed from the active player list and their cell in the binary tree is set to NULL.
-    The file also includes a function for destroying the list of active players, the array of active players, the binary tree, and the list of winning players.
+    rank the array of active players by a counting sort and a radix sort,
+    play the game in rounds over the orderly array, which is compacted as players leave so a round only visits the players still playing.
+    This file also includes functionality for determining whether a player has completed the game successfully, and if so, moving them to the leaderboard
+    of winning players and removing them from the active players list.
+    If a player has not completed the game, they fill in one slot per round, the slot on their board that has the least number of options.
+    If a player's board is a failure, they are removed from the active player list.
+    The file also includes a function for destroying the list of active players and the leaderboard of winning players.
+    A tournament can take checkpoints between its rounds and be restored from one, the format is in Checkpoint.h.
 ***************************************************************************************/
 
 #include <stdlib.h>
@@ -22,18 +23,48 @@
 #include "Players.h"
 #include "Board.h"
 #include "Ui.h"
-#include "Solver.h"
-
+#include "PuzzlePool.h"
+#include "Platform.h"
+#include "Arena.h"
+#include "Slab.h"
+#include "Leaderboard.h"
+#include "Game.h"
+#include "Bot.h"
+#include "Random.h"
+#include "Metrics.h"
+#include "TimerWheel.h"
+#include "Checkpoint.h"
+#include "Bits.h"
+
+#define PLAYER_NAME_SIZE 100
+#define RANK_NAME_BYTES 8
+#define RANK_INSERTION_LIMIT 16
+#define GAME_POOL_CAPACITY 16
+#define GAME_POOL_LOW_WATERMARK 4
+#define TOURNAMENT_RANDOM_STREAM 0xB07ull
+#define LOSER_SCREEN_MS 3000
+#define NS_PER_MS 1000000ull
+
+/* Everything a turn reads and writes sits in one cache line aligned block of 7 lines,
+   the name is stored apart and is only read to print the player or to break a ranking tie */
 struct Player
 {
-    char name[100];
-    short board[9][9];
-   Array_t*** possibilities;
+    GameState_t game;
+    char* name;
+    ActivePlayers_t* handle;            /* the player's node in the active players list, NULL once it left the list */
 };
 
+/* The sort key of a player during a ranking */
+typedef struct RankKey
+{
+    unsigned long long name;            /* RANK_NAME_BYTES characters of the name, as NameKey returns them */
+    Player_t* player;
+} RankKey_t;
+
 struct ActivePlayers
 {
     Player_t* player;
+    ActivePlayers_t* prev;
     ActivePlayers_t* next;
 };
 
@@ -41,71 +72,371 @@ struct ActivePlayerslistManeger
 {
     ActivePlayers_t* head;
     ActivePlayers_t* tail;
+    Arena_t arena;                      /* all the memory of the game: the slabs below and the names */
+    Slab_t players;
+    Slab_t activeNodes;
+    Leaderboard_t winners;
+    unsigned int round;                 /* the round the players are playing in, from 1 */
+    BotStrategy bot;                    /* BOT_HUMAN for the console game, a bot plays every player of a tournament */
+    Random_t random;                    /* the stream the bots draw their moves from */
+    signed char (*deck)[SUDOKU_SIZE][SUDOKU_SIZE];  /* the boards a tournament deals round robin, instead of a pool */
+    size_t deckSize;
+    size_t created;                     /* players created so far, names the bots */
+    unsigned long long moves;           /* moves submitted, forced fills not included */
+    unsigned long long setupNs;         /* how long creating the players of a tournament took */
+    unsigned long long playAllocations; /* the allocations of the process while the rounds were played */
+    TimerWheel_t timers;                /* the display delays of the console game, in milliseconds */
+    Timer_t screenHold;                 /* scheduled while a loser's screen must stay up */
+    Player_t** schedule;                /* the schedule a restored tournament plays on instead of ranking its players */
+    size_t live;                        /* the players in 'schedule' */
+    CheckpointWriter_t* checkpoints;    /* NULL when the tournament takes no checkpoints */
+    unsigned int checkpointRounds;      /* a checkpoint is taken before every round that follows a multiple of this */
+    LeaderboardEntry_t** top;           /* the page the standings of a tournament are copied into after every round, NULL for none */
+    size_t topCount;                    /* the winners the standings show */
+    LeaderboardEntry_t* lastWinner;     /* the winner added last */
+    int restored;                       /* the tournament was restored from a checkpoint and did not play a round since */
+    unsigned int restoredRound;         /* the round and the moves of the checkpoint it was restored from */
+    unsigned long long restoredMoves;
 };
 
-struct TreeNodePlayers
+/**
+ * @brief Called by the timer wheel when a loser's screen was up for its time, the screen may then be drawn over.
+ */
+static void ReleaseScreen(Timer_t* timer, void* context)
 {
-    Player_t* player;
-    TreeNodePlayers_t* left;
-    TreeNodePlayers_t* right;
-};
+    (void)timer;
+    (void)context;
+}
 
-struct TreePlayers
+/**
+ * @brief Waits, without using the processor, until the screen a loser was shown may be drawn over.
+ *  Everything up to the next drawing runs before, only the drawing waits.
+ */
+static void WaitForScreen(ActivePlayerslistManeger_t* maneger)
 {
-    TreeNodePlayers_t* root;
-};
+    while (IsTimerScheduled(&maneger->screenHold))
+    {
+        SleepMs((unsigned int)NextTimerDelay(&maneger->timers));
+        AdvanceTimerWheel(&maneger->timers, GetTimeNs() / NS_PER_MS, ReleaseScreen, maneger);
+    }
+}
 
-struct WinningPlayers
+/**
+ * @brief Ranks the players of a game and plays its rounds, the part of a game a tournament shares with the console game.
+ */
+static Errors PlayGame(ActivePlayerslistManeger_t* maneger, size_t size)
 {
-    Player_t* winner;
-    WinningPlayers_t* next;
-};
+    Player_t** array = maneger->schedule;
+    unsigned long long allocations = 0;
+    Errors eErr = ERR_OK;
 
-void StartGame()
+    // A restored game goes on with the schedule it was stopped with
+    if (array)
+    {
+        size = maneger->live;
+        maneger->schedule = NULL;
+    }
+    else
+    {
+        array = CreateArrayActivePlayers(maneger->head, size);
+        if (!array)
+        {
+            return ERR_ALLOCATION_FAILED;
+        }
+        eErr = RankPlayers(array, size);
+        if (eErr != ERR_OK)
+        {
+            free(array);
+            return eErr;
+        }
+    }
+    allocations = GetAllocationCount();
+    // The ranked array is the schedule of the rounds
+    CheckListActivePlayers(maneger, array, size);
+    // Turns only use memory taken before the game started, winners included, so this is what the other threads allocated
+    maneger->playAllocations = GetAllocationCount() - allocations;
+    free(array);
+
+    return eErr;
+}
+
+void StartGame(unsigned long long seed)
 {
     size_t size = 0;
     ActivePlayerslistManeger_t maneger = { NULL };
     Errors eErr;
-    Player_t** array;
-    TreePlayers_t* tree;
-    WinningPlayers_t* winners = NULL;
+    LeaderboardEntry_t* entry = NULL;
+    PuzzlePool_t* pool = NULL;
+    PuzzlePoolStats_t stats;
+
+    // The generator threads start filling the pool while the players type their names
+    pool = CreatePuzzlePool(GAME_POOL_CAPACITY, GAME_POOL_LOW_WATERMARK, 0, seed);
+    if (!pool)
+    {
+        HandleErr(ERR_ALLOCATION_FAILED, "puzzle pool");
+        return;
+    }
+
+    InitTimerWheel(&maneger.timers, GetTimeNs() / NS_PER_MS);
+    InitTimer(&maneger.screenHold, NULL);
 
     size = PrintGetNumOfPlayers();
-    eErr = CreateListOfActivePlayers(&maneger, size);
-    array = CreateArrayActivePlayers(maneger.head, size);
-    eErr = MergeSort(array, size);
-    tree = BuildTreeFromArray(array, size);
-    CheckListActivePlayers(&maneger, tree, &winners);
-    if (winners)
+    PrintGameSeed(seed);
+    eErr = CreateListOfActivePlayers(&maneger, size, pool);
+    GetPuzzlePoolStats(pool, &stats);
+    DestroyPuzzlePool(pool);
+    if (eErr == ERR_OK && size)
+    {
+        eErr = PlayGame(&maneger, size);
+    }
+    WaitForScreen(&maneger);
+    if (maneger.winners.count)
     {
-        PrintSudokuWinnersAndBoards(winners);
+        PrintWinnersTitle();
+        for (entry = GetLeaderboardEntryAt(&maneger.winners, 1); entry; entry = GetNextByRank(entry))
+        {
+            PrintWinner(GetLeaderboardRank(entry), entry->player->game.board, entry->player->name, entry->score.round, entry->score.moves);
+        }
     }
+    PrintPuzzlePoolSummary(stats.hits, stats.misses, stats.refills, stats.refills ? stats.refillNs / stats.refills : 0, stats.maxRefillNs);
 
- 
+    DestroyActivePlayersList(&maneger);
+}
 
-    DestroyTree(tree->root);
-    free(tree);
-    DestroyWinnersList(winners);
-    free(array);
+/**
+ * @brief Generates the boards a tournament deals to its players.
+ */
+static Errors CreateDeck(ActivePlayerslistManeger_t* maneger, size_t boards, unsigned long long seed)
+{
+    PuzzlePool_t* pool = NULL;
+    Errors eErr = ERR_OK;
+
+    maneger->deck = (signed char (*)[SUDOKU_SIZE][SUDOKU_SIZE])Allocate(boards * sizeof(*maneger->deck));
+    pool = CreatePuzzlePool(GAME_POOL_CAPACITY, GAME_POOL_LOW_WATERMARK, 0, seed);
+    if (!maneger->deck || !pool)
+    {
+        DestroyPuzzlePool(pool);
+        return ERR_ALLOCATION_FAILED;
+    }
+    for (size_t i = 0; i < boards && eErr == ERR_OK; i++)
+    {
+        eErr = TakePuzzle(pool, maneger->deck[i]);
+    }
+    maneger->deckSize = boards;
+    DestroyPuzzlePool(pool);
+
+    return eErr;
 }
 
-Errors CreateListOfActivePlayers(ActivePlayerslistManeger_t* maneger, size_t size)
+Errors CreateTournament(ActivePlayerslistManeger_t** tournament, size_t players, BotStrategy strategy, size_t boards, unsigned long long seed)
+{
+    ActivePlayerslistManeger_t* maneger = NULL;
+    unsigned long long start = 0;
+    Errors eErr;
+
+    *tournament = NULL;
+    if (!players || !boards || strategy == BOT_HUMAN)
+    {
+        return ERR_WRONG_INDEX;
+    }
+    maneger = (ActivePlayerslistManeger_t*)AllocateZeroed(1, sizeof(ActivePlayerslistManeger_t));
+    if (!maneger)
+    {
+        return ERR_ALLOCATION_FAILED;
+    }
+
+    // Generating a board costs far more than playing it, so a tournament deals a few boards to many players
+    eErr = CreateDeck(maneger, boards < players ? boards : players, seed);
+    maneger->bot = strategy;
+    SeedRandom(&maneger->random, seed, TOURNAMENT_RANDOM_STREAM);
+
+    start = GetTimeNs();
+    if (eErr == ERR_OK)
+    {
+        eErr = CreateListOfActivePlayers(maneger, players, NULL);
+    }
+    maneger->setupNs = GetTimeNs() - start;
+    if (eErr != ERR_OK)
+    {
+        DestroyTournament(maneger);
+        return eErr;
+    }
+
+    *tournament = maneger;
+    return ERR_OK;
+}
+
+Errors PlayTournament(ActivePlayerslistManeger_t* tournament, TournamentStats_t* stats)
+{
+    unsigned long long start = GetTimeNs();
+    CheckpointStats_t checkpoints = { 0 };
+    Errors eErr;
+
+    eErr = PlayGame(tournament, tournament->created);
+
+    stats->elapsedNs = GetTimeNs() - start;
+    // The game is over, only now is the last checkpoint waited for
+    if (tournament->checkpoints)
+    {
+        StopCheckpointWriter(tournament->checkpoints, &checkpoints);
+    }
+    stats->checkpoints = checkpoints.written;
+    stats->checkpointsDropped = checkpoints.dropped;
+    stats->checkpointsFailed = checkpoints.failed;
+    stats->checkpointSize = checkpoints.lastSize;
+    stats->checkpointCopyNs = checkpoints.copyNs;
+    stats->checkpointWriteNs = checkpoints.writeNs;
+    stats->setupNs = tournament->setupNs;
+    stats->playAllocations = tournament->playAllocations;
+    stats->players = tournament->created;
+    stats->wins = tournament->winners.count;
+    // A restored tournament counts only what this run played, the time is this run's too
+    stats->rounds = tournament->round - tournament->restoredRound;
+    stats->moves = tournament->moves - tournament->restoredMoves;
+    stats->restoredRound = tournament->restoredRound;
+    stats->peakMemory = GetPeakMemory();
+
+    return eErr;
+}
+
+ActivePlayers_t* GetActivePlayers(const ActivePlayerslistManeger_t* maneger)
+{
+    return maneger->head;
+}
+
+void DestroyTournament(ActivePlayerslistManeger_t* tournament)
+{
+    if (!tournament)
+    {
+        return;
+    }
+    DestroyCheckpointWriter(tournament->checkpoints);
+    DestroyActivePlayersList(tournament);
+    free(tournament->schedule);
+    free(tournament->deck);
+    free(tournament->top);
+    free(tournament);
+}
+
+Errors SetTournamentCheckpoints(ActivePlayerslistManeger_t* tournament, const char* path, unsigned int everyRounds)
+{
+    if (!everyRounds || tournament->checkpoints)
+    {
+        return ERR_WRONG_INDEX;
+    }
+
+    // The winners and the players still playing never add up to more than the players created, and a winner's record is the larger
+    tournament->checkpoints = CreateCheckpointWriter(path, CheckpointSize(tournament->created, 0));
+    if (!tournament->checkpoints)
+    {
+        return ERR_ALLOCATION_FAILED;
+    }
+    tournament->checkpointRounds = everyRounds;
+
+    return ERR_OK;
+}
+
+Errors SetTournamentStandings(ActivePlayerslistManeger_t* tournament, size_t top)
+{
+    if (!top || tournament->top)
+    {
+        return ERR_WRONG_INDEX;
+    }
+
+    // Taken now, so the rounds still allocate nothing
+    tournament->top = (LeaderboardEntry_t**)Allocate(top * sizeof(LeaderboardEntry_t*));
+    if (!tournament->top)
+    {
+        return ERR_ALLOCATION_FAILED;
+    }
+    tournament->topCount = top;
+
+    return ERR_OK;
+}
+
+/**
+ * @brief Reports the standings of a tournament between two rounds: the rank the last winner got and the top of the leaderboard,
+ *  both answered by the leaderboard's index in logarithmic time while the game goes on.
+ */
+static void ReportStandings(ActivePlayerslistManeger_t* maneger, size_t live)
+{
+    size_t count = 0;
+
+    if (!maneger->lastWinner)
+    {
+        return;
+    }
+    count = GetLeaderboardPage(&maneger->winners, 1, maneger->topCount, maneger->top);
+    PrintStandingsTitle(maneger->round, maneger->winners.count, live, maneger->lastWinner->player->name, GetLeaderboardRank(maneger->lastWinner));
+    for (size_t i = 0; i < count; i++)
+    {
+        PrintStanding(i + 1, maneger->top[i]->player->name, maneger->top[i]->score.round, maneger->top[i]->score.moves);
+    }
+}
+
+Errors RunTournament(size_t players, BotStrategy strategy, size_t boards, unsigned long long seed, TournamentStats_t* stats)
+{
+    ActivePlayerslistManeger_t* tournament = NULL;
+    Errors eErr;
+
+    memset(stats, 0, sizeof(*stats));
+    eErr = CreateTournament(&tournament, players, strategy, boards, seed);
+    if (eErr != ERR_OK)
+    {
+        return eErr;
+    }
+    eErr = PlayTournament(tournament, stats);
+    DestroyTournament(tournament);
+
+    return eErr;
+}
+
+/**
+ * @brief Creates the arena of a game of 'size' players with its slabs and its leaderboard.
+ */
+static Errors CreateGameMemory(ActivePlayerslistManeger_t* maneger, size_t size)
+{
+    // One block holds the whole game, sized up front so no player ever outgrows it, with one slab per node type
+    // so the nodes a traversal walks are packed next to each other
+    if (CreateArena(&maneger->arena, SlabArenaSize(sizeof(Player_t), size, CACHE_LINE_SIZE) +
+            SlabArenaSize(sizeof(ActivePlayers_t), size, sizeof(void*)) + LeaderboardArenaSize(size) +
+            size * PLAYER_NAME_SIZE) != ERR_OK)
+    {
+        return ERR_ALLOCATION_FAILED;
+    }
+    if (CreateSlab(&maneger->players, &maneger->arena, sizeof(Player_t), size, CACHE_LINE_SIZE) != ERR_OK ||
+        CreateSlab(&maneger->activeNodes, &maneger->arena, sizeof(ActivePlayers_t), size, sizeof(void*)) != ERR_OK ||
+        CreateLeaderboard(&maneger->winners, &maneger->arena, size) != ERR_OK)
+    {
+        DestroyActivePlayersList(maneger);
+        return ERR_ALLOCATION_FAILED;
+    }
+
+    return ERR_OK;
+}
+
+Errors CreateListOfActivePlayers(ActivePlayerslistManeger_t* maneger, size_t size, PuzzlePool_t* pool)
 {
     ActivePlayers_t* item = NULL;
     
     assert(maneger);
 
+    if (CreateGameMemory(maneger, size) != ERR_OK)
+    {
+        return ERR_ALLOCATION_FAILED;
+    }
+
     for (size_t i = 0; i < size; i++)
     {
-        item = CreateNewPlayer();
+        item = CreateNewPlayer(maneger, pool);
         if (!item)
         {
-            DestroyActivePlayersList(maneger->head);
+            DestroyActivePlayersList(maneger);
             return ERR_ALLOCATION_FAILED;
         }
         if (AddToEndOfPlayersList(maneger, item) != ERR_OK)
         {
-            DestroyActivePlayersList(maneger->head);
+            DestroyActivePlayersList(maneger);
             return ERR_NOT_INITIALIZED;
         }
     }
@@ -113,62 +444,220 @@ Errors CreateListOfActivePlayers(ActivePlayerslistManeger_t* maneger, size_t siz
     return ERR_OK;
 }
 
-void DestroyActivePlayersList(ActivePlayers_t* head)
+void DestroyActivePlayersList(ActivePlayerslistManeger_t* maneger)
+{
+    DestroyArena(&maneger->arena);
+    maneger->head = maneger->tail = NULL;
+}
+
+/**
+ * @brief Takes the player of a checkpoint record back to the place it had in the players slab, which keeps its name.
+ *
+ * @param maneger: the tournament being restored.
+ * @param record: the record.
+ * @param restored: a bit per place of the players slab, set for the places already taken back.
+ *
+ * @return the player, or NULL if the record does not fit the slab, is not a legal record or its place was already taken.
+ */
+static Player_t* RestorePlayer(ActivePlayerslistManeger_t* maneger, const CheckpointPlayer_t* record, unsigned long long* restored)
 {
-    if (!head) 
+    Candidates_t* possibilities = NULL;
+    Player_t* player = NULL;
+    unsigned short candidates[SUDOKU_CELLS];
+    unsigned short ruledOut = 0;
+    char name[PLAYER_NAME_SIZE];
+
+    // A record the checksum let through can still be wrong, it is taken back only if the game could have written it
+    if (record->index >= maneger->created || (restored[record->index / 64] >> (record->index % 64) & 1) ||
+        CheckCheckpointRecord(record) != ERR_OK)
     {
-        return;
+        return NULL;
+    }
+    player = (Player_t*)SlabAllocateAt(&maneger->players, record->index);
+    if (!player)
+    {
+        return NULL;
+    }
+    restored[record->index / 64] |= 1ull << (record->index % 64);
+    sprintf(name, "bot%u", record->index);
+    player->name = (char*)ArenaAllocate(&maneger->arena, strlen(name) + 1, 1);
+    if (!player->name)
+    {
+        return NULL;
+    }
+    strcpy(player->name, name);
+    player->handle = NULL;
+
+    // The masks and the candidate count index are rebuilt from the board, then the candidates the game had ruled out
+    // besides the digits on the board are taken out again
+    possibilities = &player->game.possibilities;
+    UnpackCheckpointBoard(record, player->game.board);
+    UnpackCheckpointCandidates(record, candidates);
+    InitPossibleDigits(possibilities, player->game.board);
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        for (ruledOut = possibilities->cell[i] & ~candidates[i]; ruledOut; ruledOut &= ruledOut - 1)
+        {
+            RemoveCandidate(possibilities, i / SUDOKU_SIZE, i % SUDOKU_SIZE, (short)(LowestBitIndex(ruledOut) + 1));
+        }
     }
+    possibilities->dirty = record->dirty;
+    possibilities->conflicts = record->conflicts;
+    player->game.moves = record->moves;
+    player->game.cell = record->cell;
+    player->game.prompted = record->prompted;
+
+    return player;
+}
 
-    ActivePlayers_t* curr = NULL;
-    while (head->next)
+Errors RestoreTournament(ActivePlayerslistManeger_t** tournament, const char* path)
+{
+    ActivePlayerslistManeger_t* maneger = NULL;
+    const CheckpointHeader_t* header = NULL;
+    const CheckpointWinner_t* winners = NULL;
+    const CheckpointPlayer_t* records = NULL;
+    ActivePlayers_t* item = NULL;
+    Player_t* player = NULL;
+    LeaderboardScore_t score;
+    MappedFile_t file;
+    unsigned long long* restored = NULL;
+    unsigned long long start = GetTimeNs();
+    Errors eErr = ERR_OK;
+
+    *tournament = NULL;
+    header = OpenCheckpoint(path, &file);
+    if (!header)
+    {
+        return ERR_GENERAL;
+    }
+    if (header->strategy == BOT_HUMAN || header->strategy > BOT_LOOKAHEAD || !header->created)
+    {
+        UnmapFile(&file);
+        return ERR_GENERAL;
+    }
+    maneger = (ActivePlayerslistManeger_t*)AllocateZeroed(1, sizeof(ActivePlayerslistManeger_t));
+    restored = (unsigned long long*)AllocateZeroed(((size_t)header->created + 63) / 64, sizeof(unsigned long long));
+    if (!maneger || !restored || CreateGameMemory(maneger, (size_t)header->created) != ERR_OK ||
+        !(maneger->schedule = (Player_t**)Allocate((header->live ? (size_t)header->live : 1) * sizeof(Player_t*))))
     {
-        curr = head;
-        head = head->next;
-        DestroyPossibleDigits(curr->player->possibilities);
-        free(curr->player);
-        free(curr);
+        UnmapFile(&file);
+        free(restored);
+        DestroyTournament(maneger);
+        return ERR_ALLOCATION_FAILED;
     }
 
-    DestroyPossibleDigits(head->player->possibilities);
-    free(head->player);
-    free(head);
+    maneger->bot = (BotStrategy)header->strategy;
+    maneger->round = header->round;
+    maneger->created = (size_t)header->created;
+    maneger->moves = header->moves;
+    maneger->live = (size_t)header->live;
+    maneger->restored = 1;
+    maneger->restoredRound = header->round;
+    maneger->restoredMoves = header->moves;
+    memcpy(maneger->random.state, header->random, sizeof(maneger->random.state));
+
+    // The records are read where they are mapped: the winners in finishing order, so adding them again gives every
+    // winner the place it had, then the players still playing in schedule order
+    winners = (const CheckpointWinner_t*)(header + 1);
+    for (size_t i = 0; i < header->winners && eErr == ERR_OK; i++)
+    {
+        player = RestorePlayer(maneger, &winners[i].player, restored);
+        score.round = winners[i].round;
+        score.moves = winners[i].moves;
+        if (!player || !AddToLeaderboard(&maneger->winners, player, &score))
+        {
+            eErr = ERR_GENERAL;
+        }
+    }
+    records = (const CheckpointPlayer_t*)(winners + header->winners);
+    for (size_t i = 0; i < maneger->live && eErr == ERR_OK; i++)
+    {
+        player = RestorePlayer(maneger, &records[i], restored);
+        item = player ? (ActivePlayers_t*)SlabAllocate(&maneger->activeNodes) : NULL;
+        if (!item)
+        {
+            eErr = ERR_GENERAL;
+            break;
+        }
+        item->player = player;
+        item->prev = item->next = NULL;
+        player->handle = item;
+        eErr = AddToEndOfPlayersList(maneger, item);
+        maneger->schedule[i] = player;
+    }
+    UnmapFile(&file);
+    free(restored);
+    maneger->setupNs = GetTimeNs() - start;
+    if (eErr != ERR_OK)
+    {
+        DestroyTournament(maneger);
+        return eErr;
+    }
+
+    *tournament = maneger;
+    return ERR_OK;
 }
 
-ActivePlayers_t* CreateNewPlayer()
+ActivePlayers_t* CreateNewPlayer(ActivePlayerslistManeger_t* maneger, PuzzlePool_t* pool)
 {
     ActivePlayers_t* item = NULL;
-    
 
-    item = (ActivePlayers_t*)malloc(sizeof(ActivePlayers_t));
+    item = (ActivePlayers_t*)SlabAllocate(&maneger->activeNodes);
     if (!item)
     {
         return NULL;
     }
 
-    item->player = (Player_t*)malloc(sizeof(Player_t));
+    item->player = CreatePlayer(maneger, pool);
     if (!item->player)
     {
-        free(item);
         return NULL;
     }
+    item->player->handle = item;
+    item->prev = NULL;
+    item->next = NULL;
 
-    PrintGetPlayersNames(item->player->name);
-    
-    if (CreateSudokuBoard(item->player->board) != ERR_OK)
+    return item;
+}
+
+Player_t* CreatePlayer(ActivePlayerslistManeger_t* maneger, PuzzlePool_t* pool)
+{
+    Player_t* player = NULL;
+    char name[PLAYER_NAME_SIZE];
+
+    player = (Player_t*)SlabAllocate(&maneger->players);
+    if (!player)
     {
-        free(item);
         return NULL;
     }
-    item->player->possibilities = PossibleDigits(item->player->board);
-    if (!item->player->possibilities)
+
+    if (maneger->bot == BOT_HUMAN)
+    {
+        PrintGetPlayersNames(name);
+    }
+    else
+    {
+        sprintf(name, "bot%zu", maneger->created);
+    }
+    player->name = (char*)ArenaAllocate(&maneger->arena, strlen(name) + 1, 1);
+    if (!player->name)
     {
-        free(item);
         return NULL;
     }
-    item->next = NULL;
+    strcpy(player->name, name);
 
-    return item;
+    if (!pool)
+    {
+        memcpy(player->game.board, maneger->deck[maneger->created % maneger->deckSize], sizeof(player->game.board));
+    }
+    else if (TakePuzzle(pool, player->game.board) != ERR_OK)
+    {
+        return NULL;
+    }
+    ++maneger->created;
+    InitGameState(&player->game);
+
+    return player;
 }
 
 Errors AddToEndOfPlayersList(ActivePlayerslistManeger_t* maneger, ActivePlayers_t* item)
@@ -186,6 +675,7 @@ Errors AddToEndOfPlayersList(ActivePlayerslistManeger_t* maneger, ActivePlayers_
 
     else
     {
+        item->prev = maneger->tail;
         maneger->tail->next = item;
         maneger->tail = item;
     }
@@ -200,7 +690,7 @@ Player_t** CreateArrayActivePlayers(ActivePlayers_t* head, size_t size)
 
     assert(head);
 
-    array = (Player_t**)malloc(size * sizeof(Player_t*));
+    array = (Player_t**)Allocate(size * sizeof(Player_t*));
     if (!array)
     {
         return NULL;
@@ -216,355 +706,371 @@ Player_t** CreateArrayActivePlayers(ActivePlayers_t* head, size_t size)
     return array;
 }
 
-Errors MergeSort(Player_t** array, size_t size)
+/**
+ * @brief Returns RANK_NAME_BYTES characters of a name as one number that orders like strcmp.
+ */
+static unsigned long long NameKey(const char* name)
 {
-    ActivePlayers_t** newArray;
-    if (size < 2)
-    {
-        return;
-    }
-
-    MergeSort(array, size / 2);
-    MergeSort(array + size / 2, size - (size / 2));
+    unsigned long long key = 0;
 
-    newArray = (Player_t**)malloc(size * sizeof(Player_t*));
-    if (!newArray)
+    // A short name is padded with 0 bytes, which orders it before the names it is a prefix of
+    for (int i = 0; i < RANK_NAME_BYTES; i++)
     {
-        return ERR_ALLOCATION_FAILED;
+        key = (key << 8) | (unsigned char)*name;
+        name += *name != '\0';
     }
 
-    Merge(array, size/2, array + size / 2, size - (size / 2), newArray);
-
-    for (size_t i = 0; i < size; i++)
-    {
-        array[i] = newArray[i];
-    }
-
-    free(newArray);
+    return key;
 }
 
-void Merge(Player_t** array1, int sizeArray1, Player_t** array2, int sizeArray2, Player_t** newArray)
+/**
+ * @brief Stable LSD radix sort of keys by their name chunk, a byte every key shares is skipped.
+ *  The result is left in 'keys', 'scratch' is the same size.
+ */
+static void RadixSortByName(RankKey_t* keys, RankKey_t* scratch, size_t count)
 {
-    int numOfPlayerOne = 0, numOfPlayerTwo = 0;
-    int indexArray1 = 0, indexArray2 = 0, i = 0, result = 0;
+    size_t counts[RANK_NAME_BYTES][256] = { 0 };
+    RankKey_t* from = keys, * to = scratch, * temp = NULL;
+    size_t offset = 0, bucket = 0;
+    int shift = 0;
 
-    while (indexArray1 < sizeArray1 && indexArray2 < sizeArray2)
+    for (size_t i = 0; i < count; i++)
     {
-        NumOfFullSlots(array1[indexArray1], array2[indexArray2], &numOfPlayerOne, &numOfPlayerTwo);
+        for (int byte = 0; byte < RANK_NAME_BYTES; byte++)
+        {
+            ++counts[byte][(keys[i].name >> (8 * byte)) & 0xFF];
+        }
+    }
 
-        if (numOfPlayerOne == numOfPlayerTwo)
+    for (int byte = 0; byte < RANK_NAME_BYTES; byte++)
+    {
+        shift = 8 * byte;
+        if (counts[byte][(from[0].name >> shift) & 0xFF] == count)
         {
-            numOfPlayerTwo = 0;
-            numOfPlayerOne = strcmp(array1[indexArray1]->name, array2[indexArray2]->name);
+            continue;
         }
-        if (numOfPlayerOne > numOfPlayerTwo)
+        offset = 0;
+        for (int digit = 0; digit < 256; digit++)
         {
-            newArray[i] = array2[indexArray2];
-            ++indexArray2;
+            bucket = counts[byte][digit];
+            counts[byte][digit] = offset;
+            offset += bucket;
         }
-        else
+        for (size_t i = 0; i < count; i++)
         {
-            newArray[i] = array1[indexArray1];
-            ++indexArray1;
+            to[counts[byte][(from[i].name >> shift) & 0xFF]++] = from[i];
         }
-        ++i;
-    }
-
-    while (indexArray1 < sizeArray1)
-    {
-        newArray[i] = array1[indexArray1];
-        ++indexArray1, ++i;
+        temp = from, from = to, to = temp;
     }
 
-    while (indexArray2 < sizeArray2)
+    if (from != keys)
     {
-        newArray[i] = array2[indexArray2];
-        ++indexArray2, ++i;
+        memcpy(keys, from, count * sizeof(RankKey_t));
     }
 }
 
-void NumOfFullSlots(Player_t* playerOne, Player_t* playerTwo, int* numOfPlayerOne, int* numOfPlayerTwo)
+/**
+ * @brief Stable sort by name of keys whose names agree on their first 'depth' chunks of RANK_NAME_BYTES characters.
+ *  Large groups are radix sorted on the next chunk and only the names that also agree on it go one chunk deeper,
+ *  small groups are finished with strcmp.
+ */
+static void SortByName(RankKey_t* keys, RankKey_t* scratch, size_t count, size_t depth)
 {
-    // Initialize the counters to 0
-    *numOfPlayerOne = *numOfPlayerTwo = 0;
+    size_t skip = depth * RANK_NAME_BYTES, end = 0;
+    RankKey_t key;
 
-    // Iterate over the boards of the two players and count the number of full slots
-    for (size_t i = 0; i < SUDOKU_SIZE; i++)
+    if (count <= RANK_INSERTION_LIMIT)
     {
-        for (size_t j = 0; j < SUDOKU_SIZE; j++)
+        for (size_t i = 1; i < count; i++)
         {
-            if (playerOne->board[i][j] != -1)
+            key = keys[i];
+            for (end = i; end > 0 && strcmp(key.player->name + skip, keys[end - 1].player->name + skip) < 0; end--)
             {
-                ++(*numOfPlayerOne);
-            }
-            if (playerTwo->board[i][j] != -1)
-            {
-                ++(*numOfPlayerTwo);
+                keys[end] = keys[end - 1];
             }
+            keys[end] = key;
         }
+        return;
     }
-}
 
-TreePlayers_t* BuildTreeFromArray(ActivePlayers_t** array, size_t size)
-{
-    TreePlayers_t* tree;
-    tree = (TreePlayers_t*)malloc(sizeof(TreePlayers_t));
-    if(tree == NULL) 
+    if (depth > 0)
     {
-        return NULL;
+        for (size_t i = 0; i < count; i++)
+        {
+            keys[i].name = NameKey(keys[i].player->name + skip);
+        }
     }
+    RadixSortByName(keys, scratch, count);
 
-    tree->root = CreateTreeFromArray(array, size);
-    if (!tree->root)
+    // A chunk without a terminating zero means the names go on, equal chunks are settled by the next one
+    for (size_t i = 0; i < count; i = end)
     {
-        return NULL;
+        for (end = i + 1; end < count && keys[end].name == keys[i].name; end++)
+        {
+        }
+        if (end - i > 1 && (keys[i].name & 0xFF))
+        {
+            SortByName(keys + i, scratch + i, end - i, depth + 1);
+        }
     }
-
-    return tree;
 }
 
-TreeNodePlayers_t* CreateTreeFromArray(Player_t** array, size_t size)
+Errors RankPlayers(Player_t** array, size_t size)
 {
-    TreeNodePlayers_t* root = NULL, * left = NULL, * right = NULL;
+    RankKey_t* keys = NULL, * scratch = NULL;
+    unsigned char* filled = NULL;
+    size_t counts[SUDOKU_CELLS + 2] = { 0 };
+    METRIC_START(start);
 
-    if (size == 0 || array[size / 2] == -1)
+    if (size < 2)
     {
-        return NULL;
+        return ERR_OK;
     }
-    else
+
+    // One buffer for the whole sort: the keys, the array they are scattered into and the filled counts
+    keys = (RankKey_t*)AllocateAligned(CACHE_LINE_SIZE, size * (2 * sizeof(RankKey_t) + 1));
+    if (!keys)
     {
-        root = CreateNewTNode(*(array + size / 2), NULL, NULL);
-        if (!root)
-        {
-            return NULL;
-        }
-        root->left = CreateTreeFromArray(array, size / 2);
-        root->right = CreateTreeFromArray(array + size / 2 + 1, size - size / 2 - 1);
+        return ERR_ALLOCATION_FAILED;
     }
-    return root;
-}
+    scratch = keys + size;
+    filled = (unsigned char*)(scratch + size);
 
-TreeNodePlayers_t* CreateNewTNode(Player_t* player, TreeNodePlayers_t* left, TreeNodePlayers_t* right)
-{
-    TreeNodePlayers_t* temp = NULL;
-    temp = (TreeNodePlayers_t*)malloc(sizeof(TreeNodePlayers_t));
-    if (!temp)
+    // Every key is computed once, the filled count comes straight from the candidate block
+    for (size_t i = 0; i < size; i++)
     {
-        return NULL;
+        scratch[i].player = array[i];
+        scratch[i].name = NameKey(array[i]->name);
+        filled[i] = array[i]->game.possibilities.filled;
+        ++counts[filled[i] + 1];
+    }
+
+    // The primary key first: a stable counting sort over the 0..81 filled count buckets
+    for (int bucket = 1; bucket <= SUDOKU_CELLS + 1; bucket++)
+    {
+        counts[bucket] += counts[bucket - 1];
+    }
+    for (size_t i = 0; i < size; i++)
+    {
+        keys[counts[filled[i]]++] = scratch[i];
     }
 
-    temp->player = player;
-    temp->left = left;
-    temp->right = right;
+    // Then every bucket by name, small enough by now to be sorted in cache
+    for (int bucket = 0; bucket <= SUDOKU_CELLS; bucket++)
+    {
+        size_t start = bucket ? counts[bucket - 1] : 0;
 
-    return temp;
-}
+        SortByName(keys + start, scratch + start, counts[bucket] - start, 0);
+    }
 
-void DestroyTree(TreeNodePlayers_t* root)
-{
-    if (!root)
+    for (size_t i = 0; i < size; i++)
     {
-        return;
+        array[i] = keys[i].player;
     }
 
-    DestroyTree(root->left);
-    DestroyTree(root->right);
+    FreeAligned(keys);
+    METRIC_STOP(METRIC_RANKING_NS, start);
 
-    free(root);
+    return ERR_OK;
 }
 
-void CheckListActivePlayers(ActivePlayerslistManeger_t* maneger, TreePlayers_t* tree, WinningPlayers_t** winners)
+/**
+ * @brief Packs a player into a checkpoint record.
+ */
+static void SavePlayer(const ActivePlayerslistManeger_t* maneger, Player_t* player, CheckpointPlayer_t* record)
 {
-    while (maneger->head)
-    {
-        ScannerTree(tree->root, maneger, winners);
-    }
+    const Candidates_t* possibilities = &player->game.possibilities;
+
+    record->index = (unsigned int)SlabIndexOf(&maneger->players, player);
+    record->dirty = possibilities->dirty;
+    PackCheckpointBoard(record, player->game.board);
+    PackCheckpointCandidates(record, possibilities->cell);
+    record->moves = player->game.moves;
+    record->cell = player->game.cell;
+    record->prompted = player->game.prompted;
+    record->conflicts = possibilities->conflicts;
+    memset(record->reserved, 0, sizeof(record->reserved));
 }
 
-void ScannerTree(TreeNodePlayers_t* root, ActivePlayerslistManeger_t* maneger, WinningPlayers_t** winners)
+/**
+ * @brief Copies the state of the game into the next buffer of the checkpoint writer in one sequential pass and hands
+ *  it to the writer's thread. The copy is the only part of a checkpoint the game waits for, and it skips the winners
+ *  the buffer already holds.
+ */
+static void TakeCheckpoint(ActivePlayerslistManeger_t* maneger, Player_t** schedule, size_t live)
 {
-    
-    if (!root)
+    unsigned long long start = GetTimeNs();
+    const LeaderboardEntry_t* entry = maneger->winners.first;
+    CheckpointHeader_t* header = NULL;
+    CheckpointWinner_t* winner = NULL;
+    CheckpointPlayer_t* record = NULL;
+    size_t kept = 0;
+
+    header = (CheckpointHeader_t*)BeginCheckpoint(maneger->checkpoints, &kept);
+    memset(header, 0, sizeof(CheckpointHeader_t));
+    header->strategy = (unsigned int)maneger->bot;
+    header->round = maneger->round;
+    header->created = maneger->created;
+    header->winners = maneger->winners.count;
+    header->live = live;
+    header->moves = maneger->moves;
+    memcpy(header->random, maneger->random.state, sizeof(header->random));
+
+    winner = (CheckpointWinner_t*)(header + 1);
+    for (size_t i = 0; i < kept; i++)
     {
-        return;
+        entry = entry->next;
+    }
+    for (winner += kept; entry; entry = entry->next, winner++)
+    {
+        SavePlayer(maneger, entry->player, &winner->player);
+        winner->round = entry->score.round;
+        winner->moves = entry->score.moves;
+    }
+    record = (CheckpointPlayer_t*)winner;
+    for (size_t i = 0; i < live; i++)
+    {
+        SavePlayer(maneger, schedule[i], record++);
     }
-    
-    ScannerTree(root->left, maneger, winners);
-
-    checkPlayerStatus(root, maneger, winners);
 
-    ScannerTree(root->right, maneger, winners);
+    CommitCheckpoint(maneger->checkpoints, CheckpointSize(maneger->winners.count, live), maneger->winners.count, GetTimeNs() - start);
 }
 
-void checkPlayerStatus(TreeNodePlayers_t* root, ActivePlayerslistManeger_t* maneger, WinningPlayers_t** winners)
+void CheckListActivePlayers(ActivePlayerslistManeger_t* maneger, Player_t** schedule, size_t size)
 {
-    Errors eErr, eErr2;
-    int x = 0, y = 0;
+    size_t live = size;
 
-    if (!root)
+    while (live)
     {
-        return;
+        // Between two rounds no player is in the middle of a turn, so this is the one place a checkpoint is consistent.
+        // The round a tournament was restored at is already in its checkpoint
+        if (maneger->checkpoints && !maneger->restored && maneger->round % maneger->checkpointRounds == 0)
+        {
+            TakeCheckpoint(maneger, schedule, live);
+        }
+        maneger->restored = 0;
+        ++maneger->round;
+        live = PlayRound(maneger, schedule, live);
+        if (maneger->top)
+        {
+            ReportStandings(maneger, live);
+        }
     }
+}
 
+size_t PlayRound(ActivePlayerslistManeger_t* maneger, Player_t** schedule, size_t live)
+{
+    size_t kept = 0;
+    Errors eErr;
 
-    eErr = OneStage(root->player->board, root->player->possibilities, &x, &y);
-
-    while (eErr == ERR_NOT_FINISH)
+    // Players who are still playing slide down over the ones who left, keeping their order
+    for (size_t i = 0; i < live; i++)
     {
-        eErr2 = EnterNumberFromUser(root->player->board, root->player->possibilities, root->player->name, x, y);
-        if (eErr2 != ERR_OK)
+        eErr = checkPlayerStatus(schedule[i], maneger);
+        if (eErr != ERR_FINISH_FAILURE && eErr != ERR_FINISH_SUCCESS)
         {
-            eErr = eErr2;
-            break;
+            schedule[kept++] = schedule[i];
         }
-        eErr = OneStage(root->player->board, root->player->possibilities, &x, &y);
     }
 
-    if (eErr == ERR_FINISH_FAILURE)
-    {
-        RemovePlayer(maneger, root);
-    }
-    else if (eErr == ERR_FINISH_SUCCESS)
-    {
-        MovePlayerToWinningList(maneger, root, root->player, winners);
-    }
+    return kept;
 }
 
-Errors AddWinnersPlayer(WinningPlayers_t** head, Player_t* player)
+Errors checkPlayerStatus(Player_t* player, ActivePlayerslistManeger_t* maneger)
 {
-    WinningPlayers_t* curr;
+    Errors eErr;
+    TurnPrompt_t prompt;
+    short digit = 0;
 
-    if (!*head)
+    // One move per round, every player still playing moves once before anyone moves again
+    eErr = BeginTurn(&player->game, &prompt);
+    if (eErr == ERR_NOT_FINISH)
     {
-        *head = (WinningPlayers_t*)malloc(sizeof(WinningPlayers_t));
-        if (!*head)
+        if (maneger->bot == BOT_HUMAN)
         {
-            return ERR_ALLOCATION_FAILED;
+            // The turn was already worked out while a loser's screen was still up
+            WaitForScreen(maneger);
+            METRIC_START(start);
+            digit = PrintGetNumberFromUser(player->game.board, prompt.candidates, player->name, prompt.x, prompt.y);
+            METRIC_STOP(METRIC_INPUT_WAIT_NS, start);
         }
-        (*head)->winner = player;
-        (*head)->next = NULL;
-        return ERR_OK;
+        else
+        {
+            digit = ChooseBotMove(maneger->bot, &player->game, &prompt, &maneger->random);
+        }
+        // Without a digit (the input ended) the game cannot go on
+        eErr = digit ? SubmitMove(&player->game, digit) : ERR_FINISH_FAILURE;
+        maneger->moves += digit != 0;
+        METRIC_ADD(METRIC_MOVES, digit != 0);
     }
 
-    curr = *head;
-    while (curr->next)
+    if (eErr == ERR_FINISH_FAILURE)
     {
-        curr = curr->next;
+        RemovePlayer(maneger, player);
     }
-
-    curr->next = (WinningPlayers_t*)malloc(sizeof(WinningPlayers_t));
-    if (!curr->next)
+    else if (eErr == ERR_FINISH_SUCCESS)
     {
-        return ERR_ALLOCATION_FAILED;
+        MovePlayerToWinningList(maneger, player);
     }
-    curr->next->winner = player;
-    curr->next->next = NULL;
 
-    return ERR_OK;
+    return eErr;
 }
 
-void DestroyWinnersList(WinningPlayers_t* head)
+/**
+ * @brief Unlinks a player's node from the active players list through the node's own links and frees it.
+ */
+static void UnlinkActivePlayer(ActivePlayerslistManeger_t* maneger, ActivePlayers_t* item)
 {
-    WinningPlayers_t* curr = NULL;
-
-    if (!head)
-    {
-        return;
-    }
-    curr = head;
-
-    while (head->next)
+    if (item->prev)
     {
-        curr = head;
-        head = head->next;
-        DestroyPossibleDigits(curr->winner->possibilities);
-        free(curr->winner);
-        free(curr);
-        curr = NULL;
+        item->prev->next = item->next;
     }
-
-    DestroyPossibleDigits(head->winner->possibilities);
-    free(head->winner);
-    free(head);
-    curr = NULL;
-}
-
-void RemovePlayer(ActivePlayerslistManeger_t* maneger, TreeNodePlayers_t* node)
-{
-    ActivePlayers_t* curr = maneger->head, * prev = NULL;
-
-    if (!maneger->head)
+    else
     {
-        return;
+        maneger->head = item->next;
     }
-    PrintPlayerLoses(node->player->board, node->player->name);
-
-    if (maneger->head->player->name == node->player->name)
+    if (item->next)
     {
-        curr = maneger->head;
-        maneger->head = maneger->head->next;
-        DestroyPlayerFromActivePlayersList(curr);
+        item->next->prev = item->prev;
     }
     else
     {
-        while (curr && curr->player->name != node->player->name)
-        {
-            prev = curr;
-            curr = curr->next;
-        }
-        if (curr)
-        {
-            prev->next = curr->next;
-            DestroyPlayerFromActivePlayersList(curr);
-        }
+        maneger->tail = item->prev;
     }
 
-    node->player = NULL;
+    item->player->handle = NULL;
+    SlabFree(&maneger->activeNodes, item);
 }
 
-void MovePlayerToWinningList(ActivePlayerslistManeger_t* maneger, TreeNodePlayers_t* node, Player_t* player, WinningPlayers_t** winnersList)
+void RemovePlayer(ActivePlayerslistManeger_t* maneger, Player_t* player)
 {
-    ActivePlayers_t* curr = maneger->head, *prev = NULL;
-
-    
-    assert(maneger->head || player);
-    if (maneger->head->player->name == player->name)
+    if (!player->handle)
     {
-        curr = maneger->head;
-        maneger->head = maneger->head->next;
-        AddWinnersPlayer(winnersList, player);
-        free(curr);
+        return;
     }
-    else
+    if (maneger->bot == BOT_HUMAN)
     {
-        while (curr && curr->player->name != player->name)
-        {
-            prev = curr;
-            curr = curr->next;
-        }
-        if (curr)
-        {
-            prev->next = curr->next;
-            AddWinnersPlayer(winnersList, player);
-            free(curr);
-        }
+        // The screen stays up while the game goes on, the next drawing waits for its timer
+        WaitForScreen(maneger);
+        PrintPlayerLoses(player->game.board, player->name);
+        ScheduleTimer(&maneger->timers, &maneger->screenHold, GetTimeNs() / NS_PER_MS + LOSER_SCREEN_MS);
     }
 
-    node->player = NULL;
+    UnlinkActivePlayer(maneger, player->handle);
+    SlabFree(&maneger->players, player);
 }
 
-void DestroyPlayerFromActivePlayersList(ActivePlayers_t* player)
+void MovePlayerToWinningList(ActivePlayerslistManeger_t* maneger, Player_t* player)
 {
-    if (!player)
-    {
-        return;
-    }
+    LeaderboardScore_t score;
+
+    assert(player->handle);
 
-    DestroyPossibleDigits(player->player->possibilities);
+    score.round = maneger->round;
+    score.moves = GetGameMoves(&player->game);
 
-    free(player->player);
-    free(player);
-    player = NULL;
+    UnlinkActivePlayer(maneger, player->handle);
+    maneger->lastWinner = AddToLeaderboard(&maneger->winners, player, &score);
 }
 
 
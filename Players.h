@@ -3,56 +3,161 @@
     Creation date :  21/01/23
     Description : This file contains functions related to managing a list of players in a game.
     The functions allows you to create a new player, create a list of active players, create an array of players from the linked list of active players and
-    sort the array of active players using the merge sort algorithm,
-    Create a binary tree from the orderly array, and scan the binary tree using the inOrder algorithm.
-    This file also includes functionality for determining whether a player has completed the game successfully, and if so, moving them to a list of winning players
-    and removing them from the active players list and their cell in the binary tree is set to NULL.
-    If a player has not completed the game, they can fill in the slot on their board that has the least number of options.
-    If a player's board is a failure, they are removed from the active player list and their cell in the binary tree is set to NULL.
-    The file also includes a function for destroying the list of active players, the array of active players, the binary tree, and the list of winning players.
+    rank the array of active players by a counting sort and a radix sort,
+    play the game in rounds over the orderly array, which is compacted as players leave so a round only visits the players still playing.
+    This file also includes functionality for determining whether a player has completed the game successfully, and if so, moving them to the leaderboard
+    of winning players and removing them from the active players list.
+    If a player has not completed the game, they fill in one slot per round, the slot on their board that has the least number of options.
+    If a player's board is a failure, they are removed from the active player list.
+    The file also includes a function for destroying the list of active players and the leaderboard of winning players.
 ***************************************************************************************/
 
 #ifndef __PLAYERS_H__
 #define __PLAYERS_H__
 
+#include "PuzzlePool.h"
+#include "Slab.h"
+#include "Bot.h"
+
 typedef struct Player Player_t;
 
 typedef struct ActivePlayers ActivePlayers_t;
 
 typedef struct ActivePlayerslistManeger ActivePlayerslistManeger_t;
 
-typedef struct WinningPlayers WinningPlayers_t;
+typedef struct TournamentStats
+{
+    size_t players;
+    size_t wins;                        /* the players who solved their board, the others lost */
+    unsigned int rounds;                /* the rounds this run played, a restored tournament leaves out those before its checkpoint */
+    unsigned long long moves;           /* the moves the bots chose in those rounds, forced fills not included */
+    unsigned int restoredRound;         /* the round of the checkpoint the tournament was restored from, 0 otherwise */
+    unsigned long long setupNs;         /* creating the players, or restoring them from a checkpoint */
+    unsigned long long elapsedNs;       /* ranking and playing */
+    unsigned long long playAllocations; /* allocations of the whole process while the rounds were played */
+    size_t peakMemory;                  /* the most memory the process held, in bytes */
+    size_t checkpoints;                 /* checkpoints written, 0 when the tournament took none */
+    size_t checkpointsDropped;          /* checkpoints replaced by a newer one before they were written */
+    size_t checkpointsFailed;
+    size_t checkpointSize;              /* the bytes of the last checkpoint */
+    unsigned long long checkpointCopyNs;    /* the time the game spent copying its state for the checkpoints */
+    unsigned long long checkpointWriteNs;   /* the time the background thread spent writing them */
+} TournamentStats_t;
 
-typedef struct TreeNodePlayers TreeNodePlayers_t;
+/**
+ * @brief Runs an interactive game.
+ *
+ * @param seed: the seed every player's board is generated from, the same seed and players give the same boards.
+ */
+void StartGame(unsigned long long seed);
 
-typedef struct TreePlayers TreePlayers_t;
+/**
+ * @brief Runs a whole game of bot players with no output: the players are created, ranked and play their rounds
+ *  just like the players of the console game, so the game loop can be measured at any number of players.
+ *
+ * @param players: the number of players.
+ * @param strategy: the strategy every player plays with.
+ * @param boards: the number of distinct boards, player i gets board (i % boards) of the seed.
+ * @param seed: the seed of the boards and of the bots.
+ * @param stats: receives the results and timings of the game.
+ *
+ * @return ERR_OK, ERR_ALLOCATION_FAILED, or ERR_WRONG_INDEX if there are no players, no boards or no bot strategy.
+ */
+Errors RunTournament(size_t players, BotStrategy strategy, size_t boards, unsigned long long seed, TournamentStats_t* stats);
 
+/**
+ * @brief Creates the players of a tournament without playing it, RunTournament is CreateTournament, PlayTournament and DestroyTournament.
+ *
+ * @param tournament: receives the tournament, NULL on failure.
+ *
+ * @return as RunTournament.
+ */
+Errors CreateTournament(ActivePlayerslistManeger_t** tournament, size_t players, BotStrategy strategy, size_t boards, unsigned long long seed);
 
+/**
+ * @brief Ranks the players of a tournament and plays its rounds, a tournament is played once.
+ */
+Errors PlayTournament(ActivePlayerslistManeger_t* tournament, TournamentStats_t* stats);
 
+void DestroyTournament(ActivePlayerslistManeger_t* tournament);
 
-void StartGame();
+/**
+ * @brief Makes a tournament that was not played yet take a checkpoint before its first round and then every few rounds.
+ *  Between two rounds the game copies its state into a buffer in one pass and a background thread writes it
+ *  to the disk, so the game never waits for the disk. Both buffers are allocated now.
+ *
+ * @param tournament: the tournament.
+ * @param path: the file every checkpoint replaces, it must stay valid until the tournament is destroyed.
+ * @param everyRounds: the rounds between two checkpoints.
+ *
+ * @return ERR_OK, ERR_ALLOCATION_FAILED, or ERR_WRONG_INDEX if 'everyRounds' is 0 or the tournament already takes checkpoints.
+ */
+Errors SetTournamentCheckpoints(ActivePlayerslistManeger_t* tournament, const char* path, unsigned int everyRounds);
+
+/**
+ * @brief Makes a tournament report its standings after every round: the rank of the last player who won and the top of the leaderboard.
+ *
+ * @param tournament: the tournament.
+ * @param top: the number of winners the top shows.
+ *
+ * @return ERR_OK, ERR_ALLOCATION_FAILED, or ERR_WRONG_INDEX if 'top' is 0 or the tournament already reports its standings.
+ */
+Errors SetTournamentStandings(ActivePlayerslistManeger_t* tournament, size_t top);
+
+/**
+ * @brief Creates a tournament from a checkpoint, PlayTournament then goes on with the round after the one it was taken
+ *  after and gives the results the tournament would have given if it had not been stopped.
+ *  The checkpoint is mapped and its player records are unpacked where they lie, no board is generated again.
+ *
+ * @param tournament: receives the tournament, NULL on failure.
+ * @param path: the checkpoint file.
+ *
+ * @return ERR_OK, ERR_ALLOCATION_FAILED, or ERR_GENERAL if the file is not a checkpoint this build can read.
+ */
+Errors RestoreTournament(ActivePlayerslistManeger_t** tournament, const char* path);
+
+/**
+ * @brief Returns the first node of the active players list, for CreateArrayActivePlayers.
+ */
+ActivePlayers_t* GetActivePlayers(const ActivePlayerslistManeger_t* maneger);
 
 /**
  * @brief Creates a linked list of active players.
  *
  * @param size: The number of players to be added to the list.
+ * @param pool: the pool the boards of the players are taken from, player i gets puzzle i of the pool.
+ *  NULL deals the boards of a tournament instead.
  * @return A pointer to the head of the linked list of active players.
  */
-Errors CreateListOfActivePlayers(ActivePlayerslistManeger_t* maneger, size_t size);
+Errors CreateListOfActivePlayers(ActivePlayerslistManeger_t* maneger, size_t size, PuzzlePool_t* pool);
 
 /**
- * @brief destroyActivePlayersList frees all nodes in a linked list of ActivePlayers_t.
+ * @brief destroyActivePlayersList frees every player and node of the game, active or winner, with the arena that holds them.
  *
- * @param pointer to the head of the linked list.
+ * @param maneger: the active players list manager.
  */
-void DestroyActivePlayersList(ActivePlayers_t* head);
+void DestroyActivePlayersList(ActivePlayerslistManeger_t* maneger);
 
 /**
  * @brief Creates a new player with a name and a sudoku board.
  *
+ * @param maneger: the active players list manager, the list node and the player are taken from its slabs.
+ * @param pool: the puzzle pool the player's board is taken from.
+ *
  * @return A pointer to the new player, or NULL if an error occurred.
  */
-ActivePlayers_t* CreateNewPlayer();
+ActivePlayers_t* CreateNewPlayer(ActivePlayerslistManeger_t* maneger, PuzzlePool_t* pool);
+
+/**
+ * @brief Takes a player from the players slab (on its own cache lines), reads its name and takes its board from the puzzle pool.
+ *  The bots of a tournament are named by their index and get the next board of the tournament's deck when 'pool' is NULL.
+ *
+ * @param maneger: the active players list manager that owns the memory of the game.
+ * @param pool: the puzzle pool the player's board is taken from.
+ *
+ * @return the player, or NULL if an error occurred.
+ */
+Player_t* CreatePlayer(ActivePlayerslistManeger_t* maneger, PuzzlePool_t* pool);
 
 /**
  * @brief addToEndOfPlayersList adds an item to the end of a linked list of ActivePlayers_t.
@@ -75,124 +180,65 @@ Errors AddToEndOfPlayersList(ActivePlayerslistManeger_t* maneger, ActivePlayers_
 Player_t** CreateArrayActivePlayers(ActivePlayers_t* head, size_t size);
 
 /**
- * @brief Sorts an array of `Player_t` pointers using the merge sort algorithm.
+ * @brief Sorts an array of `Player_t` pointers by the number of filled slots on their board (from minimum to maximum),
+ *  then by name in ascending lexicographic order. Each player is read once: a counting sort over the 0..81 filled
+ *  counts comes first, then every bucket is radix sorted on 8 characters of the names at a time, going further only
+ *  for names that agree so far. Players with equal keys keep their order.
  *
  * @param array: Pointer to the array to be sorted.
  * @param size: The size of the array.
- */
-Errors MergeSort(Player_t** array, size_t size);
-
-/**
- * @brief Merges two sorted arrays of `Player_t` pointers into a single sorted array.
- *
- * @param array1: Pointer to the first array to be merged.
- * @param sizeArray1: The size of the first array.
- * @param array2: Pointer to the second array to be merged.
- * @param sizeArray2: The size of the second array.
- * @param newArray: Pointer to the array to store the merged results.
- */
-void Merge(Player_t** array1, int sizeArray1, Player_t** array2, int sizeArray2, Player_t** newArray);
-
-/**
- * @brief Calculates the number of full slots in the boards of two players.
  *
- * @param playerOne: Pointer to the first player.
- * @param playerTwo: Pointer to the second player.
- * @param numOfPlayerOne: Pointer to a variable to store the number of full slots in the board of the first player.
- * @param numOfPlayerTwo: Pointer to a variable to store the number of full slots in the board of the second player.
+ * @return ERR_OK, or ERR_ALLOCATION_FAILED if the scratch buffer could not be allocated.
  */
-void NumOfFullSlots(Player_t* playerOne, Player_t* playerTwo, int* numOfPlayerOne, int* numOfPlayerTwo);
-
-
-
+Errors RankPlayers(Player_t** array, size_t size);
 
 /**
- * @brief BuildTreeFromArray - Creates a binary tree from an array of ActivePlayers_t.
- * @param array: Array of ActivePlayers_t to create the tree from.
- * @param size: Size of the array.
- *
- * Returns a pointer to the root node of the created tree.
- */
-TreePlayers_t* BuildTreeFromArray(ActivePlayers_t** array, size_t size);
-
-TreeNodePlayers_t* CreateTreeFromArray(Player_t** array, size_t size);
-
-/**
- * @brief Creates a new tree node for player data.
- *
- * @param player: Pointer to player data.
- * @param left: Pointer to left child node.
- * @param right: Pointer to right child node.
+ * @brief Plays rounds until no player is left playing.
  *
- * @return Pointer to the new tree node. Returns NULL if node creation fails.
+ * @param maneger: pointer to the active players list manager, players who win are added to its leaderboard.
+ * @param schedule: the ranked players, in the order they play every round. The array is reordered by the rounds.
+ * @param size: the number of players in the schedule.
  */
-TreeNodePlayers_t* CreateNewTNode(Player_t* player, TreeNodePlayers_t* left, TreeNodePlayers_t* right);
+void CheckListActivePlayers(ActivePlayerslistManeger_t* maneger, Player_t** schedule, size_t size);
 
 /**
- * @brief Recursively destroys a binary search tree and frees the memory allocated for each node.
+ * @brief Gives every player still playing one turn, in schedule order, and compacts the schedule:
+ *  the players still playing are moved to its start in the same order, so a round costs O(players still playing).
  *
- * @param root: Pointer to the root node of the binary search tree.
- */
-void DestroyTree(TreeNodePlayers_t* root);
-
-
-void CheckListActivePlayers(ActivePlayerslistManeger_t* maneger, TreePlayers_t* tree, WinningPlayers_t** winners);
-
-/**
- * @brief Recursively scans a binary search tree of player data and performs a series of operations based on the status of each player's game.
- *
- * @param root: pointer to the root node of the binary search tree.
  * @param maneger: pointer to the active players list manager.
- * @param winners: pointer to the head node of a linked list of winning players.
- */
-void ScannerTree(TreeNodePlayers_t* root, ActivePlayerslistManeger_t* maneger, WinningPlayers_t** winners);
-
-void checkPlayerStatus(TreeNodePlayers_t* root, ActivePlayerslistManeger_t* maneger, WinningPlayers_t** winners);
-
-/**
- * @brief Adds a player to a linked list of winning players.
- *
- * @param head:  pointer to the head node of the linked list.
- * @param player: Pointer to the player data to be added to the linked list.
+ * @param schedule: the players still playing.
+ * @param live: the number of players still playing.
  *
- * @return An Errors enum value indicating the success or failure of the operation. Returns ERR_OK if the operation is successful.
+ * @return the number of players still playing after the round.
  */
-Errors AddWinnersPlayer(WinningPlayers_t** head, Player_t* player);
+size_t PlayRound(ActivePlayerslistManeger_t* maneger, Player_t** schedule, size_t live);
 
 /**
- * @brief Frees the memory allocated for a linked list of winning players and the player data associated with each node in the list.
+ * @brief Plays one move of a player's turn, and removes the player or moves them to the leaderboard when their game is over.
+ * A player whose input ran out loses.
  *
- * @param head: Pointer to the head node of the linked list of winning players.
+ * @return ERR_FINISH_SUCCESS or ERR_FINISH_FAILURE when the game of the player is over, anything else when they play on.
  */
-void DestroyWinnersList(WinningPlayers_t* head);
+Errors checkPlayerStatus(Player_t* player, ActivePlayerslistManeger_t* maneger);
 
 /*
 *@brief Prints a message to the player indicating that they lost 
-and removes the player from the active players list.
+and removes the player from the active players list, in constant time through the player's handle.
 *
 *@param maneger: pointer to the active players list manager.
-*@param node: pointer to the tree node containing the player to remove.
+*@param player: the player to remove, freed with their list node.
 */
-void RemovePlayer(ActivePlayerslistManeger_t* maneger, TreeNodePlayers_t* node);
+void RemovePlayer(ActivePlayerslistManeger_t* maneger, Player_t* player);
 
 /**
- *@brief Removes a player from the linked list of active players and adds them to the linked list of winning players. 
-   The player's data is also removed from the binary search tree. 
+ *@brief Removes a player from the linked list of active players and adds them to the leaderboard, scored by the round
+   they finished in and the digits they submitted, the forced fills not included.
+   The active list is updated in constant time through the player's handle, the leaderboard in logarithmic time.
  *
- * @param maneger: pointer to the active players list manager.
- * @param node: Pointer to the node in the binary search tree that represents the player to be removed
+ * @param maneger: pointer to the active players list manager, it owns the leaderboard.
  * @param player: Pointer to the player data
- * @param winnersList: Pointer to the head of the linked list of winning players
- */
-void MovePlayerToWinningList(ActivePlayerslistManeger_t* maneger, TreeNodePlayers_t* node, Player_t* player, WinningPlayers_t** winnersList);
-
-/*
- *@brief Frees the memory for an active player and sets the pointer to NULL.
- *
- *@param player: pointer to the active player to be destroyed.
  */
-void DestroyPlayerFromActivePlayersList(ActivePlayers_t* player);
-
+void MovePlayerToWinningList(ActivePlayerslistManeger_t* maneger, Player_t* player);
 
 
 #endif /*__PLAYERS_H__*/
\ No newline at end of file
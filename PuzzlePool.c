@@ -0,0 +1,239 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  An in-process pool of pre-generated puzzles, so players can be created without waiting for the generator.
+    Puzzle n of the pool lives in slots[n % capacity]. Generator threads claim the next sequence number under the lock,
+    generate the puzzle from random stream n without holding it, and publish it only if the slot still expects puzzle n.
+    When "TakePuzzle" finds its puzzle missing or still in the works it abandons the slot and generates the same puzzle itself,
+    so a slow generator never holds a player back and the late copy is simply dropped.
+    The generators sleep until the number of ready puzzles falls to the low watermark and then refill the ring completely,
+    the time a refill takes is recorded so the watermarks can be sized for players joining in bursts.
+***************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "Errors.h"
+#include "PuzzlePool.h"
+#include "Board.h"
+#include "Random.h"
+#include "Platform.h"
+
+typedef enum
+{
+    SLOT_EMPTY = 0,
+    SLOT_GENERATING,
+    SLOT_READY
+} SlotState;
+
+typedef struct PuzzleSlot
+{
+    signed char board[SUDOKU_SIZE][SUDOKU_SIZE];
+    size_t sequence;                    /* the puzzle the slot holds or expects */
+    SlotState state;
+} PuzzleSlot_t;
+
+struct PuzzlePool
+{
+    PuzzleSlot_t* slots;
+    size_t capacity;
+    size_t lowWatermark;
+    unsigned long long seed;
+    Thread_t** generators;
+    int numGenerators;
+    Lock_t* lock;                       /* protects everything below */
+    Condition_t* needPuzzles;
+    size_t nextToGenerate;              /* the next sequence number a generator claims */
+    size_t nextToTake;                  /* the next sequence number TakePuzzle hands out */
+    size_t ready;
+    int refilling;
+    unsigned long long refillStart;
+    int finished;
+    PuzzlePoolStats_t stats;
+};
+
+
+static void PuzzleGeneratorLoop(void* arg)
+{
+    PuzzlePool_t* pool = (PuzzlePool_t*)arg;
+    PuzzleSlot_t* slot = NULL;
+    signed char board[SUDOKU_SIZE][SUDOKU_SIZE];
+    unsigned long long now = 0;
+    size_t sequence = 0;
+    Random_t random;
+
+    while (1)
+    {
+        AcquireLock(pool->lock);
+        while (!pool->finished && !(pool->refilling && pool->nextToGenerate - pool->nextToTake < pool->capacity))
+        {
+            WaitCondition(pool->needPuzzles, pool->lock);
+        }
+        if (pool->finished)
+        {
+            ReleaseLock(pool->lock);
+            return;
+        }
+        sequence = pool->nextToGenerate++;
+        slot = &pool->slots[sequence % pool->capacity];
+        slot->sequence = sequence;
+        slot->state = SLOT_GENERATING;
+        ReleaseLock(pool->lock);
+
+        SeedRandom(&random, pool->seed, sequence);
+        if (CreateSudokuBoard(board, &random) != ERR_OK)
+        {
+            continue;
+        }
+
+        AcquireLock(pool->lock);
+        // TakePuzzle may have given up on this puzzle and the slot may already expect a later one
+        if (slot->sequence == sequence && slot->state == SLOT_GENERATING)
+        {
+            memcpy(slot->board, board, sizeof(board));
+            slot->state = SLOT_READY;
+            ++pool->ready;
+            ++pool->stats.generated;
+            if (pool->refilling && pool->ready == pool->capacity)
+            {
+                pool->refilling = 0;
+                now = GetTimeNs() - pool->refillStart;
+                ++pool->stats.refills;
+                pool->stats.refillNs += now;
+                if (now > pool->stats.maxRefillNs)
+                {
+                    pool->stats.maxRefillNs = now;
+                }
+            }
+        }
+        ReleaseLock(pool->lock);
+    }
+}
+
+PuzzlePool_t* CreatePuzzlePool(size_t capacity, size_t lowWatermark, int numGenerators, unsigned long long seed)
+{
+    PuzzlePool_t* pool = NULL;
+
+    pool = (PuzzlePool_t*)AllocateZeroed(1, sizeof(PuzzlePool_t));
+    if (!pool)
+    {
+        return NULL;
+    }
+
+    if (numGenerators <= 0)
+    {
+        numGenerators = GetProcessorCount() > 1 ? GetProcessorCount() - 1 : 1;
+    }
+    pool->capacity = capacity ? capacity : 1;
+    pool->lowWatermark = lowWatermark < pool->capacity ? lowWatermark : pool->capacity - 1;
+    pool->seed = seed;
+    pool->refilling = 1;
+    pool->refillStart = GetTimeNs();
+    pool->slots = (PuzzleSlot_t*)AllocateZeroed(pool->capacity, sizeof(PuzzleSlot_t));
+    pool->generators = (Thread_t**)AllocateZeroed(numGenerators, sizeof(Thread_t*));
+    pool->lock = CreateLock();
+    pool->needPuzzles = CreateCondition();
+    if (!pool->slots || !pool->generators || !pool->lock || !pool->needPuzzles)
+    {
+        DestroyPuzzlePool(pool);
+        return NULL;
+    }
+
+    for (int i = 0; i < numGenerators; i++)
+    {
+        pool->generators[i] = StartThread(PuzzleGeneratorLoop, pool);
+        if (!pool->generators[i])
+        {
+            DestroyPuzzlePool(pool);
+            return NULL;
+        }
+        pool->numGenerators = i + 1;
+    }
+
+    return pool;
+}
+
+void DestroyPuzzlePool(PuzzlePool_t* pool)
+{
+    if (!pool)
+    {
+        return;
+    }
+
+    if (pool->numGenerators)
+    {
+        AcquireLock(pool->lock);
+        pool->finished = 1;
+        BroadcastCondition(pool->needPuzzles);
+        ReleaseLock(pool->lock);
+
+        for (int i = 0; i < pool->numGenerators; i++)
+        {
+            JoinThread(pool->generators[i]);
+        }
+    }
+    DestroyCondition(pool->needPuzzles);
+    DestroyLock(pool->lock);
+    free(pool->generators);
+    free(pool->slots);
+    free(pool);
+}
+
+Errors TakePuzzle(PuzzlePool_t* pool, signed char board[][SUDOKU_SIZE])
+{
+    PuzzleSlot_t* slot = NULL;
+    size_t sequence = 0;
+    int hit = 0;
+    Random_t random;
+
+    AcquireLock(pool->lock);
+    sequence = pool->nextToTake++;
+    slot = &pool->slots[sequence % pool->capacity];
+    if (sequence < pool->nextToGenerate && slot->sequence == sequence && slot->state == SLOT_READY)
+    {
+        memcpy(board, slot->board, sizeof(slot->board));
+        slot->state = SLOT_EMPTY;
+        --pool->ready;
+        ++pool->stats.hits;
+        hit = 1;
+    }
+    else
+    {
+        // Nobody claimed the puzzle yet, or its generator is still at work: either way it is generated here
+        if (sequence == pool->nextToGenerate)
+        {
+            ++pool->nextToGenerate;
+        }
+        else
+        {
+            slot->state = SLOT_EMPTY;
+        }
+        ++pool->stats.misses;
+    }
+    if (!pool->refilling && pool->ready <= pool->lowWatermark)
+    {
+        pool->refilling = 1;
+        pool->refillStart = GetTimeNs();
+    }
+    if (pool->refilling)
+    {
+        BroadcastCondition(pool->needPuzzles);
+    }
+    ReleaseLock(pool->lock);
+
+    if (hit)
+    {
+        return ERR_OK;
+    }
+
+    SeedRandom(&random, pool->seed, sequence);
+    return CreateSudokuBoard(board, &random);
+}
+
+void GetPuzzlePoolStats(PuzzlePool_t* pool, PuzzlePoolStats_t* stats)
+{
+    AcquireLock(pool->lock);
+    *stats = pool->stats;
+    stats->ready = pool->ready;
+    ReleaseLock(pool->lock);
+}
@@ -0,0 +1,67 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  An in-process pool of pre-generated puzzles, so players can be created without waiting for the generator.
+    Background threads fill a bounded ring of puzzles with "CreateSudokuBoard": once the number of ready puzzles falls to the
+    low watermark they refill it up to the high watermark and then sleep again. "TakePuzzle" pops the next puzzle in O(1)
+    and only generates inline when the ring has nothing ready.
+    Puzzle n is always generated from random stream n of the pool seed, whichever thread generates it,
+    so a game still gets the same boards for the same seed.
+***************************************************************************************/
+
+#ifndef __PUZZLE_POOL_H__
+#define __PUZZLE_POOL_H__
+
+#include <stddef.h>
+
+#include "Solver.h"
+
+typedef struct PuzzlePool PuzzlePool_t;
+
+typedef struct PuzzlePoolStats
+{
+    size_t hits;                        /* puzzles taken ready from the ring */
+    size_t misses;                      /* puzzles generated inline because none was ready */
+    size_t generated;                   /* puzzles generated by the background threads */
+    size_t ready;                       /* puzzles waiting in the ring right now */
+    size_t refills;                     /* completed refills from the low to the high watermark */
+    unsigned long long refillNs;        /* total time of the completed refills */
+    unsigned long long maxRefillNs;     /* the longest refill */
+} PuzzlePoolStats_t;
+
+
+/**
+ * @brief Creates a puzzle pool and starts its generator threads, which fill it up right away.
+ *
+ * @param capacity: the size of the ring, and the high watermark.
+ * @param lowWatermark: the background threads start refilling once this many puzzles or fewer are ready.
+ * @param numGenerators: the number of background threads, 0 for one less than the number of processors (at least 1).
+ * @param seed: the seed the puzzles are generated from.
+ *
+ * @return the pool, or NULL if it could not be created.
+ */
+PuzzlePool_t* CreatePuzzlePool(size_t capacity, size_t lowWatermark, int numGenerators, unsigned long long seed);
+
+/**
+ * @brief Stops the generator threads, waiting for the puzzles they are working on, and frees the pool.
+ */
+void DestroyPuzzlePool(PuzzlePool_t* pool);
+
+/**
+ * @brief Takes the next puzzle of the pool, generating it on the calling thread if it is not ready yet.
+ *
+ * @param pool: the puzzle pool.
+ * @param board: receives the puzzle, empty slots are -1.
+ *
+ * @return the error code of the generator.
+ */
+Errors TakePuzzle(PuzzlePool_t* pool, signed char board[][SUDOKU_SIZE]);
+
+/**
+ * @brief Copies the counters of the pool.
+ */
+void GetPuzzlePoolStats(PuzzlePool_t* pool, PuzzlePoolStats_t* stats);
+
+
+
+#endif /*__PUZZLE_POOL_H__*/
@@ -0,0 +1,55 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  A small seedable random number generator (xoshiro256**) used instead of rand().
+    The four words of state are filled from the seed and the stream number by splitmix64,
+    which never leaves the state all zero. "RandomBelow" maps 32 random bits to a range with one
+    multiplication instead of a division, the bias is far below anything a game can notice.
+***************************************************************************************/
+
+#include "Random.h"
+
+static unsigned long long SplitMix(unsigned long long* x)
+{
+    unsigned long long z = (*x += 0x9E3779B97F4A7C15ull);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static inline unsigned long long RotateLeft(unsigned long long x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+void SeedRandom(Random_t* random, unsigned long long seed, unsigned long long stream)
+{
+    unsigned long long x = seed ^ SplitMix(&stream);
+
+    for (int i = 0; i < 4; i++)
+    {
+        random->state[i] = SplitMix(&x);
+    }
+}
+
+unsigned long long NextRandom(Random_t* random)
+{
+    unsigned long long* s = random->state;
+    unsigned long long result = RotateLeft(s[1] * 5, 7) * 9;
+    unsigned long long t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = RotateLeft(s[3], 45);
+
+    return result;
+}
+
+unsigned int RandomBelow(Random_t* random, unsigned int bound)
+{
+    return (unsigned int)(((NextRandom(random) >> 32) * bound) >> 32);
+}
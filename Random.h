@@ -0,0 +1,37 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  A small seedable random number generator (xoshiro256**) used instead of rand().
+    Every player draws from its own stream, derived from the game seed and the player's index,
+    so a game can be replayed from its seed and boards do not depend on the order players are created in.
+***************************************************************************************/
+
+#ifndef __RANDOM_H__
+#define __RANDOM_H__
+
+typedef struct Random
+{
+    unsigned long long state[4];
+} Random_t;
+
+
+/**
+ * @brief Seeds a random stream. Different stream numbers of the same seed give independent sequences.
+ *
+ * @param random: the stream to seed.
+ * @param seed: the seed of the game.
+ * @param stream: the number of the stream, for example the index of a player.
+ */
+void SeedRandom(Random_t* random, unsigned long long seed, unsigned long long stream);
+
+/**
+ * @brief Returns the next 64 random bits of a stream.
+ */
+unsigned long long NextRandom(Random_t* random);
+
+/**
+ * @brief Returns a uniform random number in [0, bound), bound must be at least 1.
+ */
+unsigned int RandomBelow(Random_t* random, unsigned int bound);
+
+#endif /*__RANDOM_H__*/
@@ -0,0 +1,624 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  The game server. Sessions are taken from a slab, so accepting a client allocates nothing,
+    and a session only does work when its socket is ready: a line that is not complete yet stays in the
+    session's input buffer and an answer the socket does not take at once stays in its output buffer
+    until the event loop reports the socket writable.
+    With a move time, every session that waits for its client holds a timer in the server's timer wheel, and the
+    event loop waits no longer than the wheel's next deadline. A session whose timer expires forfeits its game, or
+    has a bot pick its move, and an unnamed session is closed.
+***************************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Errors.h"
+#include "Server.h"
+#include "Net.h"
+#include "Game.h"
+#include "PuzzlePool.h"
+#include "Platform.h"
+#include "Arena.h"
+#include "Slab.h"
+#include "Bits.h"
+#include "Ui.h"
+#include "Metrics.h"
+#include "TimerWheel.h"
+#include "Bot.h"
+#include "Random.h"
+
+#define SERVER_MAX_SESSIONS 16384
+#define SERVER_EVENTS 256
+#define SERVER_LINE_SIZE 128
+#define SERVER_OUTPUT_SIZE 256
+#define SERVER_NAME_SIZE 32
+#define SERVER_POOL_CAPACITY 256
+#define SERVER_POOL_LOW_WATERMARK 64
+#define SERVER_RANDOM_STREAM 0x5E7ull
+#define SERVER_THINK_STREAM 0x7417ull
+#define SERVER_THINK_SAMPLES 65536
+#define NS_PER_MS 1000000ull
+
+typedef enum
+{
+    SESSION_NAMING,                     /* waiting for the NAME line */
+    SESSION_PLAYING,                    /* waiting for a MOVE line */
+    SESSION_CLOSING                     /* the game is over, closed once the output is sent */
+} SessionState;
+
+/* The game comes first so it starts on the cache line the slab aligns the session on */
+typedef struct Session
+{
+    GameState_t game;
+    SessionState state;
+    int watching;                       /* the NET_EVENT_* bits the socket is watched for */
+    Socket_t socket;
+    size_t inputUsed;
+    size_t outputUsed;
+    size_t outputSent;
+    unsigned long long promptedAt;      /* when the last TURN was queued */
+    unsigned long long thinkNs;         /* the time this client took for its moves */
+    unsigned int thinkMoves;            /* the moves 'thinkNs' covers */
+    Timer_t deadline;                   /* when the client runs out of time for its NAME or MOVE line */
+    char input[SERVER_LINE_SIZE];
+    char output[SERVER_OUTPUT_SIZE];
+    char name[SERVER_NAME_SIZE];
+} Session_t;
+
+typedef struct Server
+{
+    EventLoop_t* loop;
+    Socket_t listener;
+    Arena_t arena;
+    Slab_t sessions;
+    PuzzlePool_t* pool;
+    size_t live;
+    size_t peak;
+    size_t games;                       /* games that ended, won or lost */
+    size_t wins;
+    size_t rejected;                    /* connections turned away because every session was in use */
+    unsigned long long moves;
+    TimerWheel_t timers;                /* the deadlines of the sessions, in milliseconds */
+    unsigned long long nowMs;           /* the clock, read once for every wake up of the event loop */
+    unsigned int moveTimeMs;            /* the time a client has for a line, 0 for no limit */
+    BotStrategy onTimeout;              /* the bot that moves for a client that ran out of time, BOT_HUMAN to forfeit */
+    Random_t random;
+    size_t timeouts;                    /* turns that ran out of time */
+    unsigned long long thinkNs;         /* the time the clients took for their moves */
+    size_t thinkers;                    /* clients that made a move, each is counted once its game is over */
+    unsigned long long* thinkSamples;   /* the average think time of a uniform sample of SERVER_THINK_SAMPLES of them */
+    Random_t thinkRandom;               /* picks the sample, apart from the stream the bots draw from */
+    unsigned long long fastestNs;       /* the lowest average think time of a client */
+    unsigned long long slowestNs;
+    char fastest[SERVER_NAME_SIZE];
+    char slowest[SERVER_NAME_SIZE];
+} Server_t;
+
+/**
+ * @brief Adds a message to the output of a session, a message that does not fit closes the session.
+ */
+static void QueueOutput(Session_t* session, const char* text, size_t length)
+{
+    if (session->outputUsed + length > SERVER_OUTPUT_SIZE)
+    {
+        session->state = SESSION_CLOSING;
+        return;
+    }
+    memcpy(session->output + session->outputUsed, text, length);
+    session->outputUsed += length;
+}
+
+static void QueueText(Session_t* session, const char* text)
+{
+    QueueOutput(session, text, strlen(text));
+}
+
+/**
+ * @brief Gives a session's client the move time from now for its next line.
+ */
+static void StartDeadline(Server_t* server, Session_t* session)
+{
+    if (server->moveTimeMs)
+    {
+        ScheduleTimer(&server->timers, &session->deadline, server->nowMs + server->moveTimeMs);
+    }
+}
+
+/**
+ * @brief Queues the BOARD and TURN lines of the slot the player plays next and starts the clock of the move.
+ */
+static void QueueTurn(Server_t* server, Session_t* session, const TurnPrompt_t* prompt)
+{
+    char line[SUDOKU_CELLS + 64];
+    size_t length = 0;
+    unsigned short candidates = prompt->candidates;
+
+    length += sprintf(line, "BOARD ");
+    for (int x = 0; x < SUDOKU_SIZE; x++)
+    {
+        for (int y = 0; y < SUDOKU_SIZE; y++)
+        {
+            line[length++] = session->game.board[x][y] == -1 ? '.' : (char)('0' + session->game.board[x][y]);
+        }
+    }
+    length += sprintf(line + length, "\nTURN %d %d ", prompt->x + 1, prompt->y + 1);
+    for (; candidates; candidates &= candidates - 1)
+    {
+        line[length++] = (char)('0' + LowestDigit(candidates));
+    }
+    line[length++] = '\n';
+
+    QueueOutput(session, line, length);
+    session->promptedAt = GetTimeNs();
+    StartDeadline(server, session);
+}
+
+/**
+ * @brief Adds the average think time of a session's client to the think times of the server, once its game is over.
+ */
+static void RecordThinkTime(Server_t* server, Session_t* session)
+{
+    unsigned long long average = 0;
+    size_t slot = 0;
+
+    if (!session->thinkMoves)
+    {
+        return;
+    }
+    average = session->thinkNs / session->thinkMoves;
+    session->thinkMoves = 0;
+
+    if (!server->thinkers || average < server->fastestNs)
+    {
+        server->fastestNs = average;
+        strcpy(server->fastest, session->name);
+    }
+    if (!server->thinkers || average > server->slowestNs)
+    {
+        server->slowestNs = average;
+        strcpy(server->slowest, session->name);
+    }
+    // Reservoir sampling: once the sample is full, the n-th client replaces a random one with probability SAMPLES / n
+    slot = server->thinkers++;
+    if (slot >= SERVER_THINK_SAMPLES)
+    {
+        slot = (size_t)(NextRandom(&server->thinkRandom) % server->thinkers);
+    }
+    if (slot < SERVER_THINK_SAMPLES)
+    {
+        server->thinkSamples[slot] = average;
+    }
+}
+
+/**
+ * @brief Ends the game of a session with a WIN or LOSE line.
+ */
+static void EndGame(Server_t* server, Session_t* session, Errors result)
+{
+    char line[32];
+
+    CancelTimer(&server->timers, &session->deadline);
+    RecordThinkTime(server, session);
+    ++server->games;
+    if (result == ERR_FINISH_SUCCESS)
+    {
+        ++server->wins;
+        sprintf(line, "WIN %u\n", GetGameMoves(&session->game));
+        QueueText(session, line);
+    }
+    else
+    {
+        QueueText(session, "LOSE\n");
+    }
+    session->state = SESSION_CLOSING;
+}
+
+/**
+ * @brief Begins the next turn of a session and either asks for the move or ends the game.
+ */
+static void NextTurn(Server_t* server, Session_t* session)
+{
+    TurnPrompt_t prompt;
+    Errors eErr = BeginTurn(&session->game, &prompt);
+
+    if (eErr != ERR_NOT_FINISH)
+    {
+        EndGame(server, session, eErr);
+        return;
+    }
+    QueueTurn(server, session, &prompt);
+}
+
+/**
+ * @brief Plays a digit in the pending slot of a session and goes on with the game.
+ */
+static void PlayMove(Server_t* server, Session_t* session, short digit)
+{
+    Errors eErr = SubmitMove(&session->game, digit);
+    unsigned long long elapsed = 0;
+
+    METRIC_STOP(METRIC_INPUT_WAIT_NS, session->promptedAt);
+    if (eErr == ERR_WRONG_INDEX)
+    {
+        QueueText(session, "ERR digit\n");
+        return;
+    }
+    elapsed = GetTimeNs() - session->promptedAt;
+    session->thinkNs += elapsed;
+    ++session->thinkMoves;
+    server->thinkNs += elapsed;
+    ++server->moves;
+    METRIC_ADD(METRIC_MOVES, 1);
+    if (eErr == ERR_OK)
+    {
+        NextTurn(server, session);
+    }
+    else
+    {
+        EndGame(server, session, eErr);
+    }
+}
+
+/**
+ * @brief Handles one complete line from a client, without its line end.
+ */
+static void HandleLine(Server_t* server, Session_t* session, char* line)
+{
+    if (session->state == SESSION_NAMING && strncmp(line, "NAME ", 5) == 0 && line[5])
+    {
+        strncpy(session->name, line + 5, SERVER_NAME_SIZE - 1);
+        session->name[SERVER_NAME_SIZE - 1] = '\0';
+        // The pool is filled in the background, a board is only generated here when it has run dry
+        if (TakePuzzle(server->pool, session->game.board) != ERR_OK)
+        {
+            QueueText(session, "ERR no board\n");
+            session->state = SESSION_CLOSING;
+            return;
+        }
+        InitGameState(&session->game);
+        session->state = SESSION_PLAYING;
+        NextTurn(server, session);
+    }
+    else if (session->state == SESSION_PLAYING && strncmp(line, "MOVE ", 5) == 0)
+    {
+        PlayMove(server, session, (short)atoi(line + 5));
+    }
+    else if (session->state != SESSION_CLOSING)
+    {
+        QueueText(session, "ERR unknown\n");
+    }
+}
+
+static void CloseSession(Server_t* server, Session_t* session)
+{
+    // A client that left in the middle of its game still took the time of its moves
+    RecordThinkTime(server, session);
+    CancelTimer(&server->timers, &session->deadline);
+    UnwatchSocket(server->loop, session->socket);
+    CloseSocket(session->socket);
+    SlabFree(&server->sessions, session);
+    --server->live;
+}
+
+/**
+ * @brief Sends what the socket takes of the output of a session and watches the socket for what the session waits for.
+ *
+ * @return ERR_OK, or ERR_GENERAL once the session was closed.
+ */
+static Errors FlushSession(Server_t* server, Session_t* session)
+{
+    long sent = 0;
+    int watching = NET_EVENT_READ;
+
+    while (session->outputSent < session->outputUsed)
+    {
+        sent = SendSome(session->socket, session->output + session->outputSent, session->outputUsed - session->outputSent);
+        if (sent == NET_WOULD_BLOCK)
+        {
+            break;
+        }
+        if (sent < 0)
+        {
+            CloseSession(server, session);
+            return ERR_GENERAL;
+        }
+        session->outputSent += (size_t)sent;
+    }
+
+    if (session->outputSent == session->outputUsed)
+    {
+        session->outputSent = session->outputUsed = 0;
+        if (session->state == SESSION_CLOSING)
+        {
+            CloseSession(server, session);
+            return ERR_GENERAL;
+        }
+    }
+    else
+    {
+        watching |= NET_EVENT_WRITE;
+    }
+
+    // The event loop is only told when the interest changes, most turns are answered at once
+    if (watching != session->watching)
+    {
+        WatchSocket(server->loop, session->socket, watching, session);
+        session->watching = watching;
+    }
+
+    return ERR_OK;
+}
+
+/**
+ * @brief Reads what is waiting on the socket of a session and handles every complete line.
+ */
+static void ReadSession(Server_t* server, Session_t* session)
+{
+    long received = 0;
+    char* line = NULL, * end = NULL;
+    size_t consumed = 0;
+
+    while (session->state != SESSION_CLOSING)
+    {
+        received = ReceiveSome(session->socket, session->input + session->inputUsed, SERVER_LINE_SIZE - session->inputUsed);
+        if (received == NET_WOULD_BLOCK)
+        {
+            break;
+        }
+        if (received <= 0)
+        {
+            // The client went away, whatever is still queued for it is dropped
+            CloseSession(server, session);
+            return;
+        }
+        session->inputUsed += (size_t)received;
+
+        consumed = 0;
+        line = session->input;
+        while (session->state != SESSION_CLOSING &&
+            (end = (char*)memchr(line, '\n', session->inputUsed - consumed)) != NULL)
+        {
+            *end = '\0';
+            if (end > line && end[-1] == '\r')
+            {
+                end[-1] = '\0';
+            }
+            HandleLine(server, session, line);
+            consumed += (size_t)(end - line) + 1;
+            line = end + 1;
+        }
+        if (consumed == 0 && session->inputUsed == SERVER_LINE_SIZE)
+        {
+            QueueText(session, "ERR line too long\n");
+            session->state = SESSION_CLOSING;
+        }
+        memmove(session->input, session->input + consumed, session->inputUsed - consumed);
+        session->inputUsed -= consumed;
+    }
+
+    FlushSession(server, session);
+}
+
+/**
+ * @brief Accepts every waiting connection, a connection beyond the last free session is closed at once.
+ */
+static void AcceptSessions(Server_t* server)
+{
+    Socket_t socket = INVALID_SOCKET_HANDLE;
+    Session_t* session = NULL;
+
+    while ((socket = AcceptConnection(server->listener)) != INVALID_SOCKET_HANDLE)
+    {
+        session = (Session_t*)SlabAllocate(&server->sessions);
+        if (!session)
+        {
+            ++server->rejected;
+            CloseSocket(socket);
+            continue;
+        }
+        session->socket = socket;
+        session->state = SESSION_NAMING;
+        session->inputUsed = session->outputUsed = session->outputSent = 0;
+        session->thinkNs = 0;
+        session->thinkMoves = 0;
+        session->name[0] = '\0';
+        session->watching = NET_EVENT_READ;
+        InitTimer(&session->deadline, session);
+        if (WatchSocket(server->loop, socket, NET_EVENT_READ, session) != ERR_OK)
+        {
+            CloseSocket(socket);
+            SlabFree(&server->sessions, session);
+            continue;
+        }
+        if (++server->live > server->peak)
+        {
+            server->peak = server->live;
+        }
+        StartDeadline(server, session);
+    }
+}
+
+/**
+ * @brief Called by the timer wheel for a session whose client ran out of time.
+ */
+static void ExpireSession(Timer_t* timer, void* context)
+{
+    Server_t* server = (Server_t*)context;
+    Session_t* session = (Session_t*)timer->data;
+    TurnPrompt_t prompt;
+    char line[32];
+    short digit = 0;
+
+    if (session->state == SESSION_PLAYING)
+    {
+        ++server->timeouts;
+        if (server->onTimeout != BOT_HUMAN && BeginTurn(&session->game, &prompt) == ERR_NOT_FINISH)
+        {
+            digit = ChooseBotMove(server->onTimeout, &session->game, &prompt, &server->random);
+        }
+        if (digit)
+        {
+            // The client learns which digit was played for it before the next TURN
+            sprintf(line, "TIMEOUT %hd\n", digit);
+            QueueText(session, line);
+            PlayMove(server, session, digit);
+        }
+        else
+        {
+            QueueText(session, "TIMEOUT\n");
+            EndGame(server, session, ERR_FINISH_FAILURE);
+        }
+    }
+    else
+    {
+        // A client that never sent its name gives its session back
+        QueueText(session, "ERR timeout\n");
+        session->state = SESSION_CLOSING;
+    }
+    FlushSession(server, session);
+}
+
+static int CompareThinkTimes(const void* a, const void* b)
+{
+    unsigned long long first = *(const unsigned long long*)a, second = *(const unsigned long long*)b;
+
+    return (first > second) - (first < second);
+}
+
+/**
+ * @brief Reports the spread of the average think time of the clients: the fastest and the slowest one and the percentiles of the sample.
+ */
+static void ReportThinkTimes(Server_t* server)
+{
+    size_t count = server->thinkers < SERVER_THINK_SAMPLES ? server->thinkers : SERVER_THINK_SAMPLES;
+    const unsigned long long* sorted = server->thinkSamples;
+
+    if (!count)
+    {
+        return;
+    }
+    qsort(server->thinkSamples, count, sizeof(unsigned long long), CompareThinkTimes);
+    PrintThinkTimeSummary(server->thinkers, server->fastest, server->fastestNs, sorted[(size_t)(0.5 * (count - 1) + 0.5)],
+        sorted[(size_t)(0.9 * (count - 1) + 0.5)], sorted[(size_t)(0.99 * (count - 1) + 0.5)], server->slowest, server->slowestNs);
+}
+
+/**
+ * @brief Releases whatever part of a server was started, the sessions still open go with their arena.
+ */
+static void StopServer(Server_t* server)
+{
+    if (server->loop && server->listener != INVALID_SOCKET_HANDLE)
+    {
+        UnwatchSocket(server->loop, server->listener);
+    }
+    CloseSocket(server->listener);
+    DestroyEventLoop(server->loop);
+    DestroyPuzzlePool(server->pool);
+    DestroyArena(&server->arena);
+    StopNetworking();
+}
+
+/**
+ * @brief Takes the sessions, the event loop and the puzzle pool of a server and starts listening.
+ */
+static Errors StartServer(Server_t* server, const char* address, unsigned long long seed)
+{
+    server->listener = INVALID_SOCKET_HANDLE;
+    server->nowMs = GetTimeNs() / NS_PER_MS;
+    InitTimerWheel(&server->timers, server->nowMs);
+    SeedRandom(&server->random, seed, SERVER_RANDOM_STREAM);
+    SeedRandom(&server->thinkRandom, seed, SERVER_THINK_STREAM);
+    if (StartNetworking() != ERR_OK)
+    {
+        return ERR_GENERAL;
+    }
+    if (CreateArena(&server->arena, SlabArenaSize(sizeof(Session_t), SERVER_MAX_SESSIONS, CACHE_LINE_SIZE) +
+            SERVER_THINK_SAMPLES * sizeof(unsigned long long) + CACHE_LINE_SIZE) != ERR_OK ||
+        CreateSlab(&server->sessions, &server->arena, sizeof(Session_t), SERVER_MAX_SESSIONS, CACHE_LINE_SIZE) != ERR_OK)
+    {
+        return ERR_ALLOCATION_FAILED;
+    }
+    server->thinkSamples = (unsigned long long*)ArenaAllocate(&server->arena, SERVER_THINK_SAMPLES * sizeof(unsigned long long), CACHE_LINE_SIZE);
+    if (!server->thinkSamples)
+    {
+        return ERR_ALLOCATION_FAILED;
+    }
+    server->loop = CreateEventLoop(SERVER_MAX_SESSIONS + 1);
+    server->pool = CreatePuzzlePool(SERVER_POOL_CAPACITY, SERVER_POOL_LOW_WATERMARK, 0, seed);
+    if (!server->loop || !server->pool)
+    {
+        return ERR_ALLOCATION_FAILED;
+    }
+    if (ListenOn(address, &server->listener) != ERR_OK ||
+        WatchSocket(server->loop, server->listener, NET_EVENT_READ, server) != ERR_OK)
+    {
+        return ERR_GENERAL;
+    }
+
+    return ERR_OK;
+}
+
+Errors RunServer(const char* address, unsigned long long seed, size_t games, unsigned int moveTimeMs, BotStrategy onTimeout)
+{
+    Server_t server = { NULL };
+    NetEvent_t events[SERVER_EVENTS];
+    Session_t* session = NULL;
+    PuzzlePoolStats_t stats;
+    unsigned long long start = 0;
+    int count = 0;
+    Errors eErr = ERR_OK;
+
+    server.moveTimeMs = moveTimeMs;
+    server.onTimeout = onTimeout;
+    eErr = StartServer(&server, address, seed);
+    if (eErr != ERR_OK)
+    {
+        StopServer(&server);
+        return eErr;
+    }
+
+    PrintServerListening(address, seed);
+    start = GetTimeNs();
+    while (!games || server.games < games)
+    {
+        // Without a move time no timer is ever scheduled and the wait has no end
+        count = WaitForEvents(server.loop, events, SERVER_EVENTS, NextTimerDelay(&server.timers));
+        if (count < 0)
+        {
+            eErr = ERR_GENERAL;
+            break;
+        }
+        server.nowMs = GetTimeNs() / NS_PER_MS;
+        for (int i = 0; i < count; i++)
+        {
+            if (events[i].data == &server)
+            {
+                AcceptSessions(&server);
+                continue;
+            }
+            session = (Session_t*)events[i].data;
+            if (events[i].events & (NET_EVENT_READ | NET_EVENT_CLOSED))
+            {
+                ReadSession(&server, session);
+            }
+            else if (events[i].events & NET_EVENT_WRITE)
+            {
+                FlushSession(&server, session);
+            }
+        }
+        // A line that arrived with its deadline still counts
+        AdvanceTimerWheel(&server.timers, server.nowMs, ExpireSession, &server);
+    }
+
+    GetPuzzlePoolStats(server.pool, &stats);
+    PrintServerSummary(server.games, server.wins, server.moves, server.peak, server.rejected, server.timeouts,
+        server.moves ? server.thinkNs / server.moves : 0, GetTimeNs() - start);
+    ReportThinkTimes(&server);
+    PrintPuzzlePoolSummary(stats.hits, stats.misses, stats.refills, stats.refills ? stats.refillNs / stats.refills : 0, stats.maxRefillNs);
+
+    StopServer(&server);
+
+    return eErr;
+}
@@ -0,0 +1,37 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  The game server. Every client that connects owns a player and plays its own board,
+    all sessions run on one thread around an event loop, so a slow client never holds up the others.
+    The protocol is one line per message:
+        client: NAME <name>            starts the game of the session
+        server: BOARD <81 characters>  the board by rows, '.' for an empty slot
+        server: TURN <row> <col> <digits>  the slot OneStage chose (1 based) and its candidates
+        client: MOVE <digit>           the digit for the slot of the last TURN
+        server: TIMEOUT [<digit>]      the move time ran out, the digit a bot played for the client follows,
+                                       without one the client forfeits and LOSE follows
+        server: WIN <moves> | LOSE     the end of the game, the server then closes the connection
+        server: ERR <reason>           a message that was not understood, the session goes on
+***************************************************************************************/
+
+#ifndef __SERVER_H__
+#define __SERVER_H__
+
+#include <stddef.h>
+
+#include "Bot.h"
+
+/**
+ * @brief Runs the game server until 'games' games were played.
+ *
+ * @param address: the address to listen on, a TCP port or "unix:" followed by a path.
+ * @param seed: the seed the boards are generated from, board n of a seed is always the same.
+ * @param games: the number of games to play before the server stops, 0 to never stop.
+ * @param moveTimeMs: the time a client has for each NAME and MOVE line, 0 for no limit.
+ * @param onTimeout: the bot that moves for a client that ran out of time, BOT_HUMAN to make it forfeit.
+ *
+ * @return ERR_OK, or ERR_GENERAL / ERR_ALLOCATION_FAILED if the server could not be started.
+ */
+Errors RunServer(const char* address, unsigned long long seed, size_t games, unsigned int moveTimeMs, BotStrategy onTimeout);
+
+#endif /*__SERVER_H__*/
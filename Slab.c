@@ -0,0 +1,86 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  A pool of fixed size items carved from an arena. Items are handed out in address order,
+    so nodes created one after the other sit next to each other in memory, and freed items are kept on a free list
+    for the next allocation. The free list is threaded through the first bytes of the free items themselves.
+***************************************************************************************/
+
+#include <stdlib.h>
+
+#include "Errors.h"
+#include "Slab.h"
+
+static size_t SlabItemSize(size_t itemSize, size_t alignment)
+{
+    if (itemSize < sizeof(void*))
+    {
+        itemSize = sizeof(void*);
+    }
+
+    return (itemSize + alignment - 1) & ~(alignment - 1);
+}
+
+size_t SlabArenaSize(size_t itemSize, size_t capacity, size_t alignment)
+{
+    return SlabItemSize(itemSize, alignment) * capacity + alignment - 1;
+}
+
+Errors CreateSlab(Slab_t* slab, Arena_t* arena, size_t itemSize, size_t capacity, size_t alignment)
+{
+    slab->itemSize = SlabItemSize(itemSize, alignment);
+    slab->capacity = capacity;
+    slab->used = 0;
+    slab->freeList = NULL;
+    slab->memory = (char*)ArenaAllocate(arena, slab->itemSize * capacity, alignment);
+
+    return slab->memory ? ERR_OK : ERR_ALLOCATION_FAILED;
+}
+
+void* SlabAllocate(Slab_t* slab)
+{
+    void* item = NULL;
+
+    if (slab->freeList)
+    {
+        item = slab->freeList;
+        slab->freeList = *(void**)item;
+        return item;
+    }
+    if (slab->used == slab->capacity)
+    {
+        return NULL;
+    }
+
+    return slab->memory + slab->itemSize * slab->used++;
+}
+
+void SlabFree(Slab_t* slab, void* item)
+{
+    if (!item)
+    {
+        return;
+    }
+
+    *(void**)item = slab->freeList;
+    slab->freeList = item;
+}
+
+size_t SlabIndexOf(const Slab_t* slab, const void* item)
+{
+    return (size_t)((const char*)item - slab->memory) / slab->itemSize;
+}
+
+void* SlabAllocateAt(Slab_t* slab, size_t index)
+{
+    if (index >= slab->capacity)
+    {
+        return NULL;
+    }
+    if (index >= slab->used)
+    {
+        slab->used = index + 1;
+    }
+
+    return slab->memory + slab->itemSize * index;
+}
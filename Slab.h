@@ -0,0 +1,69 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  A pool of fixed size items carved from an arena. Items are handed out in address order,
+    so nodes created one after the other sit next to each other in memory, and freed items are kept on a free list
+    for the next allocation. The items go back to the system with the arena they were taken from.
+***************************************************************************************/
+
+#ifndef __SLAB_H__
+#define __SLAB_H__
+
+#include <stddef.h>
+
+#include "Arena.h"
+
+typedef struct Slab
+{
+    char* memory;
+    size_t itemSize;                    /* the item size rounded up to the alignment */
+    size_t capacity;
+    size_t used;                        /* items handed out from 'memory' so far, free list not counted */
+    void* freeList;
+} Slab_t;
+
+
+/**
+ * @brief Takes room for 'capacity' items from an arena.
+ *
+ * @param slab: the slab to create.
+ * @param arena: the arena that owns the memory.
+ * @param itemSize: the size of one item.
+ * @param capacity: the number of items.
+ * @param alignment: a power of two every item must start on, at most a cache line.
+ *
+ * @return ERR_OK on success, ERR_ALLOCATION_FAILED if the arena is too small.
+ */
+Errors CreateSlab(Slab_t* slab, Arena_t* arena, size_t itemSize, size_t capacity, size_t alignment);
+
+/**
+ * @brief Returns the arena room a slab needs, including the padding that aligns it.
+ */
+size_t SlabArenaSize(size_t itemSize, size_t capacity, size_t alignment);
+
+/**
+ * @brief Hands out an item, the most recently freed one first.
+ *
+ * @return the item, or NULL if every item is in use.
+ */
+void* SlabAllocate(Slab_t* slab);
+
+/**
+ * @brief Puts an item back on the free list of its slab.
+ */
+void SlabFree(Slab_t* slab, void* item);
+
+/**
+ * @brief Returns the position of an item in its slab, the first item handed out is at position 0.
+ */
+size_t SlabIndexOf(const Slab_t* slab, const void* item);
+
+/**
+ * @brief Hands out the item at a position, to rebuild a slab whose items keep their places. The positions are handed out
+ *  in any order, each at most once, and the positions up to the highest one are never handed out by SlabAllocate.
+ *
+ * @return the item, or NULL if the position is past the capacity of the slab.
+ */
+void* SlabAllocateAt(Slab_t* slab, size_t index);
+
+#endif /*__SLAB_H__*/
@@ -2,15 +2,21 @@
     Author: Mordechai Ben Shimon
     Creation date :  21/01/23
     Description :  This file deals with the functionality to fill in and verify the validity of the numbers in the sudoku board.
-    The "PossibleDigits" function creates a 2D array of pointers that holds the possible values for each slot on the board.
-    The "CheckPossibleValuesForSlot" function, which receives a board and an X, Y position on the board, and
-    returns an array of possible values for that particular slot.
-    The "on stage" function looks for a position on the board that has only one valid value and updates the position with that value.
+    The candidates of a board are kept in a Candidates_t block: a 9-bit occupancy mask for every row, column and 3x3 square,
+    a 9-bit candidate mask for every slot, an index of the empty slots by number of candidates, the number of full slots and a conflict counter.
+    The "PossibleDigits" function builds that block once from a board with the whole board kernel of Kernel.c, and the "CheckPossibleValuesForSlot" function
+    returns the candidate mask of one particular slot.
+    The "on stage" function fills, through "PropagateSingles", every position that has only one valid value or that is the only place
+    left for a digit in its row, column or square, following a worklist of the units that changed.
     In case no such position is found, the function returns the coordinates of the position with the smallest possible values on the board in the output parameters, X and Y.
-    The "UpdatingPossibleDigits" function updates the valid digits for the row, column, and 3x3 square containing the most recently entered number.
-    The "CheckingLegalityFboard" function verifies whether the value entered in the board is legal according to the sudoku rules.
-    The "IsBoardFull" function checks if the board is completely full and returns 1 if true or 0 if false.
-    Finally, the "EnterNumberFromUser" function gives the user the ability to enter a number for a specific cell on the board.
+    The "UpdatingPossibleDigits" function updates the masks of the row, column, and 3x3 square containing the most recently entered number
+    by clearing one bit in every peer slot, so no memory is allocated while the game is played.
+    The "CheckingLegalityFboard" and "IsBoardFull" functions only read the counters kept up to date by "UpdatingPossibleDigits".
+    The "PlaceNumber" function writes the number the player chose for a slot and checks the board; the engine does no input or output,
+    the number comes from whatever drives the game (see Game.h).
+    Finally, the "SolveBoard", "CountSolutions" and "NextSolution" functions solve a board completely by backtracking on copies of
+    the candidate block, propagating singles after every guess and branching on the slot with the fewest candidates,
+    and can stop after a given number of solutions.
 ***************************************************************************************/
 
 #include <stdlib.h>
@@ -20,258 +26,545 @@
 #include "Errors.h"
 #include "Solver.h"
 #include "Board.h"
-#include "Ui.h"
+#include "Bits.h"
+#include "Kernel.h"
+#include "Platform.h"
+#include "Metrics.h"
 
 
-struct Array
+const unsigned char g_unitCells[SUDOKU_UNITS][SUDOKU_SIZE] =
 {
-    short* arr;
-    unsigned short size;
+    /* rows */
+    {  0,  1,  2,  3,  4,  5,  6,  7,  8 },
+    {  9, 10, 11, 12, 13, 14, 15, 16, 17 },
+    { 18, 19, 20, 21, 22, 23, 24, 25, 26 },
+    { 27, 28, 29, 30, 31, 32, 33, 34, 35 },
+    { 36, 37, 38, 39, 40, 41, 42, 43, 44 },
+    { 45, 46, 47, 48, 49, 50, 51, 52, 53 },
+    { 54, 55, 56, 57, 58, 59, 60, 61, 62 },
+    { 63, 64, 65, 66, 67, 68, 69, 70, 71 },
+    { 72, 73, 74, 75, 76, 77, 78, 79, 80 },
+    /* columns */
+    {  0,  9, 18, 27, 36, 45, 54, 63, 72 },
+    {  1, 10, 19, 28, 37, 46, 55, 64, 73 },
+    {  2, 11, 20, 29, 38, 47, 56, 65, 74 },
+    {  3, 12, 21, 30, 39, 48, 57, 66, 75 },
+    {  4, 13, 22, 31, 40, 49, 58, 67, 76 },
+    {  5, 14, 23, 32, 41, 50, 59, 68, 77 },
+    {  6, 15, 24, 33, 42, 51, 60, 69, 78 },
+    {  7, 16, 25, 34, 43, 52, 61, 70, 79 },
+    {  8, 17, 26, 35, 44, 53, 62, 71, 80 },
+    /* 3x3 squares */
+    {  0,  1,  2,  9, 10, 11, 18, 19, 20 },
+    {  3,  4,  5, 12, 13, 14, 21, 22, 23 },
+    {  6,  7,  8, 15, 16, 17, 24, 25, 26 },
+    { 27, 28, 29, 36, 37, 38, 45, 46, 47 },
+    { 30, 31, 32, 39, 40, 41, 48, 49, 50 },
+    { 33, 34, 35, 42, 43, 44, 51, 52, 53 },
+    { 54, 55, 56, 63, 64, 65, 72, 73, 74 },
+    { 57, 58, 59, 66, 67, 68, 75, 76, 77 },
+    { 60, 61, 62, 69, 70, 71, 78, 79, 80 }
 };
 
-struct PossibleValue {
-    int value;
-    bool isPossible;
+const unsigned int g_cellUnits[SUDOKU_CELLS] =
+{
+    0x0040201, 0x0040401, 0x0040801, 0x0081001, 0x0082001, 0x0084001, 0x0108001, 0x0110001, 0x0120001,
+    0x0040202, 0x0040402, 0x0040802, 0x0081002, 0x0082002, 0x0084002, 0x0108002, 0x0110002, 0x0120002,
+    0x0040204, 0x0040404, 0x0040804, 0x0081004, 0x0082004, 0x0084004, 0x0108004, 0x0110004, 0x0120004,
+    0x0200208, 0x0200408, 0x0200808, 0x0401008, 0x0402008, 0x0404008, 0x0808008, 0x0810008, 0x0820008,
+    0x0200210, 0x0200410, 0x0200810, 0x0401010, 0x0402010, 0x0404010, 0x0808010, 0x0810010, 0x0820010,
+    0x0200220, 0x0200420, 0x0200820, 0x0401020, 0x0402020, 0x0404020, 0x0808020, 0x0810020, 0x0820020,
+    0x1000240, 0x1000440, 0x1000840, 0x2001040, 0x2002040, 0x2004040, 0x4008040, 0x4010040, 0x4020040,
+    0x1000280, 0x1000480, 0x1000880, 0x2001080, 0x2002080, 0x2004080, 0x4008080, 0x4010080, 0x4020080,
+    0x1000300, 0x1000500, 0x1000900, 0x2001100, 0x2002100, 0x2004100, 0x4008100, 0x4010100, 0x4020100
 };
 
 
-Array_t*** PossibleDigits(short sudokuBoard[][SUDOKU_SIZE])
+/**
+ * @brief Adds an empty slot to the candidate count index.
+ */
+static inline void AddSlotToIndex(Candidates_t* possibilities, int cell, int count)
+{
+    possibilities->slotsByCount[count][cell >> 5] |= 1u << (cell & 31);
+    possibilities->countsInUse |= 1u << count;
+}
+
+/**
+ * @brief Removes a slot from the candidate count index, 'count' being the number of candidates it was indexed with.
+ */
+static inline void RemoveSlotFromIndex(Candidates_t* possibilities, int cell, int count)
 {
-    Array_t*** arrayPossibleValue = NULL;
-    int* arr = NULL, numPossibleValues = 0;
+    unsigned int* slots = possibilities->slotsByCount[count];
 
-    arrayPossibleValue = (Array_t***)malloc(SUDOKU_SIZE * sizeof(Array_t**));
-    if (!arrayPossibleValue)
+    slots[cell >> 5] &= ~(1u << (cell & 31));
+    if (!(slots[0] | slots[1] | slots[2]))
+    {
+        possibilities->countsInUse &= ~(1u << count);
+    }
+}
+
+Candidates_t* PossibleDigits(signed char sudokuBoard[][SUDOKU_SIZE])
+{
+    Candidates_t* possibilities = NULL;
+
+    possibilities = (Candidates_t*)AllocateAligned(CACHE_LINE_SIZE, sizeof(Candidates_t));
+    if (!possibilities)
     {
         return NULL;
     }
 
-    for (size_t x = 0; x < SUDOKU_SIZE; x++)
+    InitPossibleDigits(possibilities, sudokuBoard);
+
+    return possibilities;
+}
+
+void InitPossibleDigits(Candidates_t* possibilities, signed char sudokuBoard[][SUDOKU_SIZE])
+{
+    const signed char* cells = &sudokuBoard[0][0];
+    METRIC_START(start);
+
+    ComputeBoardMasks(sudokuBoard, possibilities);
+    possibilities->dirty = (1u << SUDOKU_UNITS) - 1;
+
+    possibilities->countsInUse = 0;
+    for (int count = 0; count <= SUDOKU_SIZE; count++)
     {
-        arrayPossibleValue[x] = (Array_t**)malloc(SUDOKU_SIZE * sizeof(Array_t*));
-        if (!arrayPossibleValue[x])
+        possibilities->slotsByCount[count][0] = possibilities->slotsByCount[count][1] = possibilities->slotsByCount[count][2] = 0;
+    }
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        if (cells[i] == -1)
         {
-            free(arrayPossibleValue);
-            return NULL;
+            AddSlotToIndex(possibilities, i, CountBits(possibilities->cell[i]));
         }
+    }
+    METRIC_STOP(METRIC_CANDIDATE_REBUILD_NS, start);
+}
 
-        for (size_t y = 0; y < SUDOKU_SIZE; y++)
+unsigned short CheckPossibleValuesForSlot(signed char sudokuBoard[][SUDOKU_SIZE], int x, int y)
+{
+    unsigned short used = 0;
+    int newX = 0, newY = 0;
+
+    if (sudokuBoard[x][y] != -1)
+    {
+        return 0;
+    }
+
+    newX = (x / 3) * 3;
+    newY = (y / 3) * 3;
+
+    for (size_t i = 0; i < SUDOKU_SIZE; i++)
+    {
+        if (sudokuBoard[x][i] != -1)
         {
-            arrayPossibleValue[x][y] = CheckPossibleValuesForSlot(sudokuBoard, x, y);
-            if (!arrayPossibleValue[x][y])
-            {
-                return NULL;
-            }
+            used |= DIGIT_TO_BIT(sudokuBoard[x][i]);
+        }
+        if (sudokuBoard[i][y] != -1)
+        {
+            used |= DIGIT_TO_BIT(sudokuBoard[i][y]);
+        }
+        if (sudokuBoard[newX + i / 3][newY + i % 3] != -1)
+        {
+            used |= DIGIT_TO_BIT(sudokuBoard[newX + i / 3][newY + i % 3]);
         }
     }
 
-    return arrayPossibleValue;
+    return ~used & ALL_DIGITS_MASK;
 }
 
-Array_t* CheckPossibleValuesForSlot(short sudokuBoard[][SUDOKU_SIZE], int x, int y)
+void DestroyPossibleDigits(Candidates_t* possibilities)
 {
-    PossibleValue_t possibleValues[9] = { {1,1 }, { 2,1 }, { 3,1 }, { 4,1 }, { 5,1 }, { 6,1 }, { 7, 1 }, { 8,1 }, { 9,1 } };
-    Array_t* arrayPossibleValue = NULL;
-    int newX = 0, newY = 0;
+    FreeAligned(possibilities);
+}
 
-    arrayPossibleValue = (Array_t*)malloc(sizeof(Array_t));
-    if (!arrayPossibleValue)
+Errors OneStage(signed char board[][SUDOKU_SIZE], Candidates_t* possibilities, int* x, int* y)
+{
+    Errors eErr;
+    int cell = 0;
+    METRIC_START(start);
+
+    // Fill every slot that has a single legal value
+    eErr = PropagateSingles(board, possibilities, NULL);
+    METRIC_STOP(METRIC_PROPAGATION_NS, start);
+    if (eErr != ERR_OK)
     {
-        return NULL;
+        return eErr;
     }
 
-    arrayPossibleValue->size = 0;
-    if (sudokuBoard[x][y] != -1)
+    // Store the coordinates of the cell with the smallest number of possibilities
+    cell = MostConstrainedSlot(possibilities);
+    *x = cell / SUDOKU_SIZE, * y = cell % SUDOKU_SIZE;
+
+    return ERR_NOT_FINISH;
+}
+
+void RemoveCandidate(Candidates_t* possibilities, int x, int y, short digit)
+{
+    int cell = CELL_OF(x, y), count = 0;
+
+    if (!(possibilities->cell[cell] & DIGIT_TO_BIT(digit)))
     {
-        arrayPossibleValue->arr = NULL;
+        return;
     }
-    else
+
+    count = CountBits(possibilities->cell[cell]);
+    RemoveSlotFromIndex(possibilities, cell, count);
+    AddSlotToIndex(possibilities, cell, count - 1);
+    possibilities->cell[cell] &= ~DIGIT_TO_BIT(digit);
+    possibilities->dirty |= g_cellUnits[cell];
+}
+
+int FindSlotWithCandidates(const Candidates_t* possibilities, int count)
+{
+    const unsigned int* slots = possibilities->slotsByCount[count];
+
+    if (!(possibilities->countsInUse & (1u << count)))
     {
-        newX = (x / 3) * 3;
-        newY = (y / 3) * 3;
+        return -1;
+    }
+    if (slots[0])
+    {
+        return LowestBitIndex(slots[0]);
+    }
+    if (slots[1])
+    {
+        return 32 + LowestBitIndex(slots[1]);
+    }
+    return 64 + LowestBitIndex(slots[2]);
+}
 
-        for (size_t i = 0; i < SUDOKU_SIZE; i++)
+int MostConstrainedSlot(const Candidates_t* possibilities)
+{
+    if (!possibilities->countsInUse)
+    {
+        return -1;
+    }
+
+    return FindSlotWithCandidates(possibilities, LowestBitIndex(possibilities->countsInUse));
+}
+
+/**
+ * @brief Returns the digits already placed in a unit (an index into g_unitCells).
+ */
+static inline unsigned short PlacedInUnit(const Candidates_t* possibilities, int unit)
+{
+    if (unit < SUDOKU_SIZE)
+    {
+        return possibilities->row[unit];
+    }
+    if (unit < 2 * SUDOKU_SIZE)
+    {
+        return possibilities->col[unit - SUDOKU_SIZE];
+    }
+    return possibilities->box[unit - 2 * SUDOKU_SIZE];
+}
+
+/**
+ * @brief Writes a digit that is a candidate of an empty slot and records it in the candidate block.
+ */
+static void PlaceSingle(signed char board[][SUDOKU_SIZE], Candidates_t* possibilities, int cell, short digit)
+{
+    board[cell / SUDOKU_SIZE][cell % SUDOKU_SIZE] = digit;
+    UpdatingPossibleDigits(board, possibilities, cell / SUDOKU_SIZE, cell % SUDOKU_SIZE);
+}
+
+Errors PropagateSingles(signed char board[][SUDOKU_SIZE], Candidates_t* possibilities, int* filledCount)
+{
+    const signed char* slots = &board[0][0];
+    const unsigned char* cells = NULL;
+    unsigned short once = 0, twice = 0, mask = 0, hidden = 0;
+    int unit = 0, cell = 0, filled = 0;
+    Errors eErr = ERR_OK;
+
+    METRIC_ADD(METRIC_PROPAGATIONS, 1);
+    if (CheckingLegalityFboard(possibilities) == ERR_ILLEGAL)
+    {
+        eErr = ERR_FINISH_FAILURE;
+    }
+
+    while (eErr == ERR_OK)
+    {
+        // A slot without candidates makes the board unsolvable
+        if (possibilities->countsInUse & 1u)
         {
-            if (sudokuBoard[x][i] != -1 )
-            {
-                possibleValues[(sudokuBoard[x][i] - 1)].isPossible = 0;
-            }
-            if (sudokuBoard[i][y] != -1 && i != x)
-            {
-                possibleValues[(sudokuBoard[i][y] - 1)].isPossible = 0;
-            }
-            if (i == 3 || i == 6)
-            {
-                ++newX, newY = (y / 3) * 3;
-            }
-            if (sudokuBoard[newX][newY] != -1  && (newX != x && newY != y))
-            {
-                possibleValues[(sudokuBoard[newX][newY] - 1)].isPossible = 0;
-            }
-            ++newY;
+            eErr = ERR_FINISH_FAILURE;
+            break;
         }
 
-        for (size_t i = 0; i < 9; i++)
+        // Naked singles come straight from the candidate count index
+        if ((cell = FindSlotWithCandidates(possibilities, 1)) != -1)
         {
-            if (possibleValues[i].isPossible)
-            {
-                ++arrayPossibleValue->size;
-            }
+            PlaceSingle(board, possibilities, cell, LowestDigit(possibilities->cell[cell]));
+            ++filled;
+            continue;
+        }
+
+        if (!possibilities->dirty)
+        {
+            break;
         }
-        arrayPossibleValue->arr = (short*)malloc(arrayPossibleValue->size * sizeof(short));
-        if (!arrayPossibleValue->arr)
+        unit = LowestBitIndex(possibilities->dirty);
+        possibilities->dirty &= possibilities->dirty - 1;
+        cells = g_unitCells[unit];
+        METRIC_ADD(METRIC_UNITS_SCANNED, 1);
+
+        // Full slots have no candidates, so they drop out of the counts on their own
+        once = twice = 0;
+        for (int i = 0; i < SUDOKU_SIZE; i++)
         {
-            return NULL;
+            mask = possibilities->cell[cells[i]];
+            twice |= once & mask;
+            once |= mask;
         }
-        for (size_t i = 0,j = 0; i < 9; i++)
+
+        // A digit missing from the unit that no slot can take any more
+        if ((once | PlacedInUnit(possibilities, unit)) != ALL_DIGITS_MASK)
+        {
+            eErr = ERR_FINISH_FAILURE;
+            break;
+        }
+
+        // Hidden singles: a digit that fits exactly one slot of the unit
+        hidden = once & ~twice;
+        while (hidden)
         {
-            if (possibleValues[i].isPossible)
+            mask = hidden & (unsigned short)-hidden;
+            hidden &= hidden - 1;
+            for (int i = 0; i < SUDOKU_SIZE; i++)
             {
-                arrayPossibleValue->arr[j] = possibleValues[i].value;
-                ++j;
+                if (slots[cells[i]] == -1 && (possibilities->cell[cells[i]] & mask))
+                {
+                    PlaceSingle(board, possibilities, cells[i], LowestDigit(mask));
+                    ++filled;
+                    break;
+                }
             }
         }
     }
 
-    return arrayPossibleValue;
+    METRIC_ADD(METRIC_SINGLES_PLACED, filled);
+    if (filledCount)
+    {
+        *filledCount = filled;
+    }
+    if (eErr == ERR_OK && IsBoardFull(possibilities))
+    {
+        eErr = ERR_FINISH_SUCCESS;
+    }
+
+    return eErr;
 }
 
-void DestroyPossibleDigits(Array_t*** arrayPossibleDigits)
+void UpdatingPossibleDigits(signed char board[][SUDOKU_SIZE], Candidates_t* possibilities, int x, int y)
 {
-    for (size_t x = 0; x < SUDOKU_SIZE; x++)
+    const unsigned char* cells = NULL;
+    unsigned short bit = DIGIT_TO_BIT(board[x][y]), clear = ~bit;
+    unsigned int dirty = g_cellUnits[CELL_OF(x, y)];
+    int box = BOX_OF(x, y);
+    int units[3] = { x, SUDOKU_SIZE + y, 2 * SUDOKU_SIZE + box };
+    int count = 0;
+
+    METRIC_ADD(METRIC_CANDIDATE_UPDATES, 1);
+    if ((possibilities->row[x] | possibilities->col[y] | possibilities->box[box]) & bit)
     {
-        for (size_t y = 0; y < SUDOKU_SIZE; y++)
+        ++possibilities->conflicts;
+    }
+    possibilities->row[x] |= bit;
+    possibilities->col[y] |= bit;
+    possibilities->box[box] |= bit;
+    RemoveSlotFromIndex(possibilities, CELL_OF(x, y), CountBits(possibilities->cell[CELL_OF(x, y)]));
+    possibilities->cell[CELL_OF(x, y)] = 0;
+    ++possibilities->filled;
+
+    // Remove the digit from every slot of the row, column and 3x3 square,
+    // the units of a slot that loses a candidate have to be looked at again by PropagateSingles
+    for (int unit = 0; unit < 3; unit++)
+    {
+        cells = g_unitCells[units[unit]];
+        for (size_t i = 0; i < SUDOKU_SIZE; i++)
         {
-            free(arrayPossibleDigits[x][y]->arr);
-            free(arrayPossibleDigits[x][y]);
+            if (possibilities->cell[cells[i]] & bit)
+            {
+                count = CountBits(possibilities->cell[cells[i]]);
+                RemoveSlotFromIndex(possibilities, cells[i], count);
+                AddSlotToIndex(possibilities, cells[i], count - 1);
+                possibilities->cell[cells[i]] &= clear;
+                dirty |= g_cellUnits[cells[i]];
+                METRIC_ADD(METRIC_CANDIDATES_REMOVED, 1);
+            }
         }
-        free(arrayPossibleDigits[x]);
     }
-    free(arrayPossibleDigits);
+    possibilities->dirty |= dirty;
 }
 
-Errors OneStage(short board[][SUDOKU_SIZE], Array_t*** possibilities, int* x, int* y)
+Errors CheckingLegalityFboard(const Candidates_t* possibilities)
 {
-    int min = 9;
-    for (size_t i = 0; i < SUDOKU_SIZE; i++)
-    {
-        for (size_t j = 0; j < SUDOKU_SIZE; j++)
-        {
-            // If a cell with a single possibility is found, update the cell in the board with the single possible value
-            if (possibilities[i][j]->size == 1)
-            {
-                // Update the cell in the board with the single possible value
-                board[i][j] = possibilities[i][j]->arr[0];
-                free(possibilities[i][j]->arr);
-                possibilities[i][j]->arr = NULL;
-                possibilities[i][j]->size = 0;
+    return possibilities->conflicts ? ERR_ILLEGAL : ERR_OK;
+}
 
-                // Update the possibilities for other cells in the board
-                UpdatingPossibleDigits(board, possibilities, i, j);
+int IsBoardFull(const Candidates_t* possibilities)
+{
+    return possibilities->filled == SUDOKU_CELLS;
+}
 
-                // Check the legality of the updated board
-                if (CheckingLegalityFboard(board,i,j) == ERR_ILLEGAL)
-                {
-                    // If the updated board is illegal, return ERR_FINISH_FAILURE
-                    return ERR_FINISH_FAILURE;
-                }
-                // If the updated board is full, return ERR_FINISH_SUCCESS
-                if (IsBoardFull(board))
-                {
-                    return ERR_FINISH_SUCCESS;
-                }
-            }
+Errors PlaceNumber(signed char board[][SUDOKU_SIZE], Candidates_t* possibilities, int x, int y, short digit)
+{
+    if (possibilities->cell[CELL_OF(x, y)] == 0)
+    {
+        return ERR_FINISH_FAILURE;
+    }
+    if (digit < 1 || digit > SUDOKU_SIZE)
+    {
+        return ERR_WRONG_INDEX;
+    }
 
-            // If no cell with a single possibility is found, search for the cell with the smallest number of possibilities
-            else
-            {
-                if (board[i][j] == -1 && possibilities[i][j]->size < min)
-                {
-                    // Store the coordinates of the cell with the smallest number of possibilities
-                    min = possibilities[i][j]->size;
-                    *x = i, * y = j;
-                }
-            }
-        }
+    board[x][y] = (signed char)digit;
+    UpdatingPossibleDigits(board, possibilities, x, y);
+
+    if (CheckingLegalityFboard(possibilities) == ERR_ILLEGAL)
+    {
+        return ERR_FINISH_FAILURE;
+    }
+    if (IsBoardFull(possibilities))
+    {
+        return ERR_FINISH_SUCCESS;
     }
-    
 
-    return ERR_NOT_FINISH;
+    return ERR_OK;
 }
 
-void UpdatingPossibleDigits(short board[][SUDOKU_SIZE], Array_t*** possibilities, int x, int y)
+/**
+ * @brief Picks the empty slot of a frame with the fewest candidates from the candidate count index
+ *  and stores it as the branching slot of the frame.
+ */
+static void SelectBranchSlot(SearchFrame_t* frame)
 {
-    int newX, newY;
-    newX = (x / 3) * 3;
-    newY = (y / 3) * 3;
+    frame->cell = (unsigned char)MostConstrainedSlot(&frame->possibilities);
+    frame->remaining = frame->possibilities.cell[frame->cell];
+}
 
-    // Search the board array for cells that have not been filled in yet
-    for (size_t i = 0; i < SUDOKU_SIZE; i++)
+void InitSolutionIterator(SolutionIterator_t* iterator, signed char board[][SUDOKU_SIZE])
+{
+    SearchFrame_t* root = &iterator->frames[0];
+
+    for (size_t x = 0; x < SUDOKU_SIZE; x++)
     {
-        if (board[x][i] == -1)
-        {
-            free(possibilities[x][i]);
-            possibilities[x][i] = CheckPossibleValuesForSlot(board, x, i);
-        }
-        if (board[i][y] == -1 && i != x)
-        {
-            free(possibilities[i][y]);
-            possibilities[i][y] = CheckPossibleValuesForSlot(board, i, y);
-        }
-        if (i == 3 || i == 6)
-        {
-            ++newX, newY = (y / 3) * 3;
-        }
-        if (board[newX][newY] == -1 && (newX != x && newY != y))
+        for (size_t y = 0; y < SUDOKU_SIZE; y++)
         {
-            free(possibilities[newX][newY]);
-            possibilities[newX][newY] = CheckPossibleValuesForSlot(board, newX, newY);
+            root->board[x][y] = board[x][y];
         }
-        ++newY;
     }
+    InitPossibleDigits(&root->possibilities, root->board);
+    root->remaining = 0;
+    root->cell = 0;
+    iterator->depth = 0;
+    iterator->started = 0;
+    iterator->guesses = 0;
+}
+
+SolutionIterator_t* CreateSolutionIterator(signed char board[][SUDOKU_SIZE])
+{
+    SolutionIterator_t* iterator = NULL;
+
+    iterator = (SolutionIterator_t*)AllocateAligned(CACHE_LINE_SIZE, sizeof(SolutionIterator_t));
+    if (!iterator)
+    {
+        return NULL;
+    }
+
+    InitSolutionIterator(iterator, board);
+
+    return iterator;
 }
 
-Errors CheckingLegalityFboard(short board[][SUDOKU_SIZE], int x, int y)
+void ExcludeSolutionDigit(SolutionIterator_t* iterator, int x, int y, short digit)
 {
-   int newX = 0, newY = 0;
-   newX = (x / 3) * 3;
-   newY = (y / 3) * 3;
+    RemoveCandidate(&iterator->frames[0].possibilities, x, y, digit);
+}
+
+void DestroySolutionIterator(SolutionIterator_t* iterator)
+{
+    FreeAligned(iterator);
+}
 
-   for (size_t i = 0; i < SUDOKU_SIZE; i++)
-   {
-        if (i != y && board[x][i] == board[x][y])
+int NextSolution(SolutionIterator_t* iterator, signed char solution[][SUDOKU_SIZE])
+{
+    SearchFrame_t* frame = NULL, * child = NULL;
+    Errors eErr;
+    short digit = 0;
+    int x = 0, y = 0;
+
+    if (!iterator->started)
+    {
+        iterator->started = 1;
+        frame = &iterator->frames[0];
+        eErr = PropagateSingles(frame->board, &frame->possibilities, NULL);
+        if (eErr == ERR_FINISH_FAILURE)
         {
-          return ERR_ILLEGAL; 
+            iterator->depth = -1;
+            return 0;
         }
-        if (i != x && board[i][y] == board[x][y])
+        if (eErr == ERR_FINISH_SUCCESS)
         {
-            return ERR_ILLEGAL;
+            child = frame;
         }
-        if (i == 3 || i == 6)
+        else
         {
-            ++newX, newY = (y / 3) * 3;
+            SelectBranchSlot(frame);
         }
-        if (board[newX][newY] == board[x][y] && (newX != x && newY != y))
+    }
+
+    while (!child && iterator->depth >= 0)
+    {
+        frame = &iterator->frames[iterator->depth];
+        if (!frame->remaining)
         {
-            return ERR_ILLEGAL;
+            // Every digit of the branching slot was tried, go back one level
+            --iterator->depth;
+            continue;
         }
-       ++newY;
-   }
-
 
+        digit = LowestDigit(frame->remaining);
+        frame->remaining &= frame->remaining - 1;
+        ++iterator->guesses;
+
+        // Try the digit on a copy of the frame so backtracking only has to drop the copy
+        child = &iterator->frames[iterator->depth + 1];
+        *child = *frame;
+        x = frame->cell / SUDOKU_SIZE;
+        y = frame->cell % SUDOKU_SIZE;
+        child->board[x][y] = digit;
+        UpdatingPossibleDigits(child->board, &child->possibilities, x, y);
+        eErr = PropagateSingles(child->board, &child->possibilities, NULL);
+        if (eErr == ERR_FINISH_SUCCESS)
+        {
+            ++iterator->depth;
+            break;
+        }
+        if (eErr == ERR_OK)
+        {
+            ++iterator->depth;
+            SelectBranchSlot(child);
+        }
+        // Otherwise the digit leads to a contradiction and the copy is simply dropped
+        child = NULL;
+    }
 
-   return ERR_OK;
-}
+    if (!child)
+    {
+        return 0;
+    }
 
-int IsBoardFull(short board[][SUDOKU_SIZE])
-{
-    for (size_t i = 0; i < SUDOKU_SIZE; i++)
+    // The board is full, nothing is left to try in this frame
+    child->remaining = 0;
+    if (solution)
     {
-        for (size_t j = 0; j < SUDOKU_SIZE; j++)
+        for (size_t i = 0; i < SUDOKU_SIZE; i++)
         {
-            if (board[i][j] == -1)
+            for (size_t j = 0; j < SUDOKU_SIZE; j++)
             {
-                return 0;
+                solution[i][j] = child->board[i][j];
             }
         }
     }
@@ -279,29 +572,44 @@ int IsBoardFull(short board[][SUDOKU_SIZE])
     return 1;
 }
 
-Errors EnterNumberFromUser(short board[][SUDOKU_SIZE], Array_t*** possibilities, char* name, int x, int y)
+size_t CountSolutions(signed char board[][SUDOKU_SIZE], size_t limit)
 {
-    if (possibilities[x][y]->size == 0)
+    SolutionIterator_t* iterator = NULL;
+    size_t count = 0;
+
+    iterator = CreateSolutionIterator(board);
+    if (!iterator)
     {
-        return ERR_FINISH_FAILURE;
+        return 0;
+    }
+
+    while (count < limit && NextSolution(iterator, NULL))
+    {
+        ++count;
     }
 
-    PrintGetNumberFromUser(board, possibilities[x][y]->arr, possibilities[x][y]->size,name, x, y);
+    DestroySolutionIterator(iterator);
 
-    free(possibilities[x][y]->arr);
-    possibilities[x][y]->arr = NULL;
-    possibilities[x][y]->size = 0;
+    return count;
+}
 
-    UpdatingPossibleDigits(board, possibilities, x, y);
+Errors SolveBoard(signed char board[][SUDOKU_SIZE])
+{
+    SolutionIterator_t* iterator = NULL;
+    Errors eErr = ERR_FINISH_FAILURE;
 
-    if (CheckingLegalityFboard(board, x, y) == ERR_ILLEGAL)
+    iterator = CreateSolutionIterator(board);
+    if (!iterator)
     {
-        return ERR_FINISH_FAILURE;
+        return ERR_ALLOCATION_FAILED;
     }
-    if (IsBoardFull(board))
+
+    if (NextSolution(iterator, board))
     {
-        return ERR_FINISH_SUCCESS;
+        eErr = ERR_OK;
     }
 
-    return ERR_OK;
+    DestroySolutionIterator(iterator);
+
+    return eErr;
 }
\ No newline at end of file
@@ -2,55 +2,105 @@
     Author: Mordechai Ben Shimon
     Creation date :  21/01/23
     Description :  This file deals with the functionality to fill in and verify the validity of the numbers in the sudoku board.
-    The "PossibleDigits" function creates a 2D array of pointers that holds the possible values for each slot on the board.
-    The "CheckPossibleValuesForSlot" function, which receives a board and an X, Y position on the board, and
-    returns an array of possible values for that particular slot.
-    The "on stage" function looks for a position on the board that has only one valid value and updates the position with that value.
+    The candidates of a board are kept in a Candidates_t block: a 9-bit occupancy mask for every row, column and 3x3 square,
+    a 9-bit candidate mask for every slot, an index of the empty slots by number of candidates, the number of full slots and a conflict counter.
+    The "PossibleDigits" function builds that block once from a board with the whole board kernel of Kernel.c, and the "CheckPossibleValuesForSlot" function
+    returns the candidate mask of one particular slot.
+    The "on stage" function fills, through "PropagateSingles", every position that has only one valid value or that is the only place
+    left for a digit in its row, column or square, following a worklist of the units that changed.
     In case no such position is found, the function returns the coordinates of the position with the smallest possible values on the board in the output parameters, X and Y.
-    The "UpdatingPossibleDigits" function updates the valid digits for the row, column, and 3x3 square containing the most recently entered number.
-    The "CheckingLegalityFboard" function verifies whether the value entered in the board is legal according to the sudoku rules.
-    The "IsBoardFull" function checks if the board is completely full and returns 1 if true or 0 if false.
-    Finally, the "EnterNumberFromUser" function gives the user the ability to enter a number for a specific cell on the board.
+    The "UpdatingPossibleDigits" function updates the masks of the row, column, and 3x3 square containing the most recently entered number
+    by clearing one bit in every peer slot, so no memory is allocated while the game is played.
+    The "CheckingLegalityFboard" and "IsBoardFull" functions only read the counters kept up to date by "UpdatingPossibleDigits".
+    The "PlaceNumber" function writes the number the player chose for a slot and checks the board; the engine does no input or output,
+    the number comes from whatever drives the game (see Game.h).
+    Finally, the "SolveBoard", "CountSolutions" and "NextSolution" functions solve a board completely by backtracking on copies of
+    the candidate block, propagating singles after every guess and branching on the slot with the fewest candidates,
+    and can stop after a given number of solutions.
 ***************************************************************************************/
 
 #ifndef __SOLVER_H__
 #define __SOLVER_H__
 
 #define SUDOKU_SIZE 9
+#define SUDOKU_CELLS (SUDOKU_SIZE * SUDOKU_SIZE)
+#define SUDOKU_UNITS (3 * SUDOKU_SIZE)
 
-typedef struct Array Array_t;
+#define BOX_OF(x, y) (((x) / 3) * 3 + (y) / 3)
+#define CELL_OF(x, y) ((x) * SUDOKU_SIZE + (y))
 
-typedef struct PossibleValue PossibleValue_t;
+typedef struct Candidates
+{
+    unsigned short cell[SUDOKU_CELLS];  /* candidate mask of every slot, 0 once the slot is full */
+    unsigned short row[SUDOKU_SIZE];    /* digits already placed in each row */
+    unsigned short col[SUDOKU_SIZE];    /* digits already placed in each column */
+    unsigned short box[SUDOKU_SIZE];    /* digits already placed in each 3x3 square */
+    unsigned int slotsByCount[SUDOKU_SIZE + 1][3];  /* empty slots indexed by their number of candidates, as 81 bit sets */
+    unsigned short countsInUse;         /* bit k set when slotsByCount[k] is not empty */
+    unsigned int dirty;                 /* units (bit u for g_unitCells[u]) whose slots changed since the last propagation */
+    unsigned char filled;               /* number of full slots */
+    unsigned char conflicts;            /* number of placements that broke the sudoku rules */
+} Candidates_t;
+
+typedef struct SearchFrame
+{
+    signed char board[SUDOKU_SIZE][SUDOKU_SIZE];
+    Candidates_t possibilities;
+    unsigned short remaining;           /* digits not tried yet in the branching slot */
+    unsigned char cell;                 /* slot the frame branches on */
+} SearchFrame_t;
+
+typedef struct SolutionIterator
+{
+    SearchFrame_t frames[SUDOKU_CELLS + 1];
+    int depth;                          /* index of the deepest live frame, -1 once every solution was returned */
+    int started;
+    size_t guesses;                     /* digits tried in branching slots so far, a measure of how hard the board is */
+} SolutionIterator_t;
+
+/* The 27 units of the board (9 rows, 9 columns, 9 squares) as lists of slot indexes. */
+extern const unsigned char g_unitCells[SUDOKU_UNITS][SUDOKU_SIZE];
+
+/* The 3 units of every slot as a bit set over g_unitCells. */
+extern const unsigned int g_cellUnits[SUDOKU_CELLS];
 
 
 /**
- * @brief The function receives a Sudoku board represented by a matrix of cells. The function will generate a 2D array of pointers 
- *  to the Array type in the size of a board Sudoku where each cell (Array) contains all the possible digits for the cell.
+ * @brief The function receives a Sudoku board represented by a matrix of cells and builds the candidate block of the board
+ *  in one allocation, aligned on a cache line.
  *
- * @param sudokuBoard:  a 2D array of short integers representing the sudoku board.
+ * @param sudokuBoard:  a 2D array of signed chars representing the sudoku board.
+ *
+ * @return a pointer to the candidate block or NULL if the allocation fails.
+ */
+Candidates_t* PossibleDigits(signed char sudokuBoard[][SUDOKU_SIZE]);
+
+/**
+ * @brief Fills an existing candidate block from a board.
  *
- * @returna 2D array of pointers to the Array type in the size of a board Sudoku where each cell (Array) contains all the possible digits for the cell.
+ * @param possibilities: the candidate block to fill.
+ * @param sudokuBoard:  a 2D array of signed chars representing the sudoku board.
  */
-Array_t*** PossibleDigits(short sudokuBoard[][SUDOKU_SIZE]);
+void InitPossibleDigits(Candidates_t* possibilities, signed char sudokuBoard[][SUDOKU_SIZE]);
 
 /**
  *@brief Determines the possible values that can be placed in a given slot of a sudoku board.
  *
- * @param sudokuBoard:  a 2D array of short integers representing the sudoku board
+ * @param sudokuBoard:  a 2D array of signed chars representing the sudoku board
  * @param x:            the x-coordinate of the slot
  * @param y:            the y-coordinate of the slot
- * @return              an Array_t struct containing the possible values for the slot or NULL if an error occurs
+ * @return              the candidate mask of the slot (bit d - 1 set when d is possible), 0 if the slot is full
  */
-Array_t* CheckPossibleValuesForSlot(short sudokuBoard[][SUDOKU_SIZE], int x, int y);
+unsigned short CheckPossibleValuesForSlot(signed char sudokuBoard[][SUDOKU_SIZE], int x, int y);
 
-void DestroyPossibleDigits(Array_t*** arrayPossibleDigits);
+void DestroyPossibleDigits(Candidates_t* possibilities);
 
 /**
- * @brief This function looks for slots that can be filled by only one digit legally and if found update the cell 
- *  in the board with the only possible value and update the options for other cells in the board.
+ * @brief This function fills the slots that can be filled by only one digit legally (see PropagateSingles) 
+ *  and then looks for the empty slot with the smallest number of possibilities.
  *
  * @param board: Two-dimensional array storing the sudoku board.
- * @param possibilities: 2D array of pointers to the Array type storing the possibilities for each cell in the board.
+ * @param possibilities: the candidate block of the board.
  * @param x: Pointer to an integer storing the x-coordinate of the cell with the smallest number of possibilities.
  * @param y: Pointer to an integer storing the y-coordinate of the cell with the smallest number of possibilities.
  *
@@ -60,44 +110,148 @@ void DestroyPossibleDigits(Array_t*** arrayPossibleDigits);
     ERR_NOT_FINISH if the board is not solved yet. 
     If the board is not solved yet, store the coordinates of the cell with the smallest number of possibilities in 'x' and 'y'.
  */
-Errors OneStage(short board[][SUDOKU_SIZE], Array_t*** possibilities, int* x, int* y);
+Errors OneStage(signed char board[][SUDOKU_SIZE], Candidates_t* possibilities, int* x, int* y);
+
+/**
+ * @brief Records the digit just written to board[x][y] in the candidate block: marks it in the row, column and square masks,
+ *  removes it from the candidates of every peer slot and updates the full slots and conflict counters.
+ *
+ * @param board: Two-dimensional array storing the sudoku board.
+ * @param possibilities: the candidate block of the board.
+ * @param x: the x-coordinate of the slot that was filled.
+ * @param y: the y-coordinate of the slot that was filled.
+ */
+void UpdatingPossibleDigits(signed char board[][SUDOKU_SIZE], Candidates_t* possibilities, int x, int y);
+
+/**
+ * @brief Fills every naked single (a slot with one candidate) and hidden single (a digit with one possible slot in a unit)
+ *  until none is left. Only the units marked dirty since the last call are examined, and every placement marks the units
+ *  of the slots that lost a candidate, so the work follows the changes instead of rescanning the board.
+ *
+ * @param board: Two-dimensional array storing the sudoku board.
+ * @param possibilities: the candidate block of the board.
+ * @param filledCount: receives the number of slots filled by the call, may be NULL.
+ *
+ * @return ERR_FINISH_SUCCESS if the board is full, ERR_FINISH_FAILURE as soon as the board is illegal,
+ *  a slot has no candidates left or a unit has no slot left for one of its missing digits, ERR_OK otherwise.
+ */
+Errors PropagateSingles(signed char board[][SUDOKU_SIZE], Candidates_t* possibilities, int* filledCount);
+
+/**
+ * @brief Removes one digit from the candidates of an empty slot, keeping the candidate count index up to date.
+ *
+ * @param possibilities: the candidate block of the board.
+ * @param x: the x-coordinate of the slot.
+ * @param y: the y-coordinate of the slot.
+ * @param digit: the digit to remove, nothing happens if it is not a candidate of the slot.
+ */
+void RemoveCandidate(Candidates_t* possibilities, int x, int y, short digit);
 
-void UpdatingPossibleDigits(short board[][SUDOKU_SIZE], Array_t*** possibilities, int x, int y);
+/**
+ * @brief Returns an empty slot that has exactly 'count' candidates, in O(1) from the candidate count index.
+ *
+ * @param possibilities: the candidate block of the board.
+ * @param count: the number of candidates (0..9).
+ *
+ * @return the index of the slot (x * SUDOKU_SIZE + y), or -1 if there is no such slot.
+ */
+int FindSlotWithCandidates(const Candidates_t* possibilities, int count);
+
+/**
+ * @brief Returns the empty slot with the fewest candidates (a slot without candidates first), in O(1).
+ *
+ * @param possibilities: the candidate block of the board.
+ *
+ * @return the index of the slot (x * SUDOKU_SIZE + y), or -1 if the board is full.
+ */
+int MostConstrainedSlot(const Candidates_t* possibilities);
 
 /**
- *@brief This function checks if a given value at a given position on a Sudoku board is legal
+ *@brief This function checks if every value placed on the board so far respects the sudoku rules.
  *
- * @param board:  a 2D array of short integers representing the sudoku board
- * @param  x:     the x-coordinate of the position
- * @param  y:     the y-coordinate of the position
+ * @param possibilities: the candidate block of the board.
 
- * @return returns: ERR_OK if the value is legal, ERR_ILLEGAL if it is not
+ * @return returns: ERR_OK if the board is legal, ERR_ILLEGAL if it is not
  */
-Errors CheckingLegalityFboard(short board[][SUDOKU_SIZE], int x, int y);
+Errors CheckingLegalityFboard(const Candidates_t* possibilities);
 
 /**
  *@brief This function checks if a Sudoku board is full or not.
  *
- * @param sudokuBoard:  a 2D array of short integers representing the sudoku board
+ * @param possibilities: the candidate block of the board.
 
  * @return 1 if the board is full, 0 if it is not
  */
-int IsBoardFull(short board[][SUDOKU_SIZE]);
+int IsBoardFull(const Candidates_t* possibilities);
 
 /**
- * @brief This function gets a number from the user and enters it onto a Sudoku board and checks whether the values are valid.
+ * @brief Writes a digit the player chose to an empty slot and checks the board, without any input or output.
  *
- * @param sudokuBoard:  a 2D array of short integers representing the sudoku board
-   @param possibilities: 2D array of pointers to the Array type storing the possibilities for each cell in the board.
- * @param x: Pointer to an integer storing the x-coordinate of the cell with the smallest number of possibilities.
- * @param y: Pointer to an integer storing the y-coordinate of the cell with the smallest number of possibilities.
- * 
- * @return ERR_FINISH_SUCCESS if the Sudoku board is solved, 
- *         ERR_FINISH_FAILURE if the solution is illegal,or 
- *         ERR_OK if the entered values are valid. 
+ * @param board: the sudoku board.
+ * @param possibilities: the candidate block of the board.
+ * @param x: the x-coordinate of the slot, as OneStage returned it.
+ * @param y: the y-coordinate of the slot.
+ * @param digit: the digit the player chose, it does not have to be one of the candidates of the slot.
+ *
+ * @return ERR_FINISH_SUCCESS if the board is solved, ERR_FINISH_FAILURE if it is illegal,
+ *         ERR_WRONG_INDEX if the digit is not between 1 and 9 (the board is not changed) or ERR_OK.
+ */
+Errors PlaceNumber(signed char board[][SUDOKU_SIZE], Candidates_t* possibilities, int x, int y, short digit);
+
+
+/**
+ * @brief Prepares an iterator over all the solutions of a board. The iterator keeps its own copy of the board.
+ *
+ * @param iterator: the iterator to prepare.
+ * @param board: a 2D array of signed chars representing the sudoku board.
+ */
+void InitSolutionIterator(SolutionIterator_t* iterator, signed char board[][SUDOKU_SIZE]);
+
+SolutionIterator_t* CreateSolutionIterator(signed char board[][SUDOKU_SIZE]);
+
+/**
+ * @brief Restricts the search of an iterator to the solutions where slot (x, y) does not hold 'digit'.
+ *  Must be called before the first NextSolution. Removing a clue keeps a puzzle unique exactly when
+ *  the puzzle without the clue has no solution that puts another digit in its slot.
+ *
+ * @param iterator: the iterator prepared by InitSolutionIterator or CreateSolutionIterator.
+ * @param x: the x-coordinate of an empty slot.
+ * @param y: the y-coordinate of the slot.
+ * @param digit: the digit to exclude.
  */
-Errors EnterNumberFromUser(short board[][SUDOKU_SIZE], Array_t*** possibilities, char* name, int x, int y);
+void ExcludeSolutionDigit(SolutionIterator_t* iterator, int x, int y, short digit);
 
+void DestroySolutionIterator(SolutionIterator_t* iterator);
+
+/**
+ * @brief Continues the search of an iterator until the next solution of the board.
+ *
+ * @param iterator: the iterator returned by CreateSolutionIterator or prepared by InitSolutionIterator.
+ * @param solution: receives the solved board, may be NULL when only counting.
+ *
+ * @return 1 if another solution was found, 0 if there are no more solutions.
+ */
+int NextSolution(SolutionIterator_t* iterator, signed char solution[][SUDOKU_SIZE]);
+
+/**
+ * @brief Counts the solutions of a board, stopping as soon as 'limit' solutions were found.
+ *  CountSolutions(board, 2) == 1 checks that a board has a unique solution.
+ *
+ * @param board: a 2D array of signed chars representing the sudoku board.
+ * @param limit: the maximal number of solutions to look for.
+ *
+ * @return the number of solutions found, at most 'limit'.
+ */
+size_t CountSolutions(signed char board[][SUDOKU_SIZE], size_t limit);
+
+/**
+ * @brief Solves a board in place.
+ *
+ * @param board: a 2D array of signed chars representing the sudoku board, filled with the first solution found.
+ *
+ * @return ERR_OK if the board was solved, ERR_FINISH_FAILURE if it has no solution.
+ */
+Errors SolveBoard(signed char board[][SUDOKU_SIZE]);
 
 
-#endif /*__SOLVER_H__ */
\ No newline at end of file
+#endif /*__SOLVER_H__ */
@@ -0,0 +1,33 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  The checks "make test" runs. Every suite is a function that records its checks with CHECK,
+    a failed check prints its file, line and condition to stderr and the run goes on with the next check.
+    The runner prints the number of checks and failures and exits with 1 if any check failed.
+***************************************************************************************/
+
+#ifndef __CHECK_H__
+#define __CHECK_H__
+
+#define CHECK(condition) RecordCheck((condition) != 0, #condition, __FILE__, __LINE__)
+
+/**
+ * @brief Counts a check and prints it if it failed.
+ *
+ * @param passed: 1 if the condition of the check held.
+ * @param condition: the text of the condition.
+ * @param file: the file of the check.
+ * @param line: the line of the check.
+ *
+ * @return 'passed', so a suite can skip the checks that depend on a failed one.
+ */
+int RecordCheck(int passed, const char* condition, const char* file, int line);
+
+/* The suites, in the order the runner calls them */
+void TestSolver(void);
+void TestBoard(void);
+void TestPlayers(void);
+void TestLeaderboard(void);
+void TestCheckpoint(void);
+
+#endif /*__CHECK_H__*/
@@ -0,0 +1,92 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  Checks the puzzle generator: every puzzle it returns has a single solution and the clue count the
+    options asked for, the same random stream gives the same puzzle, and a puzzle cut short by the budget is still unique.
+***************************************************************************************/
+
+#include <string.h>
+
+#include "Errors.h"
+#include "Board.h"
+#include "Check.h"
+
+#define TEST_GENERATOR_SEEDS 8
+
+/**
+ * @brief Returns the number of filled slots of a board.
+ */
+static int CountClues(signed char board[][SUDOKU_SIZE])
+{
+    int clues = 0;
+
+    for (int x = 0; x < SUDOKU_SIZE; x++)
+    {
+        for (int y = 0; y < SUDOKU_SIZE; y++)
+        {
+            clues += board[x][y] != -1;
+        }
+    }
+
+    return clues;
+}
+
+static void TestTargetClueCount(void)
+{
+    GeneratorOptions_t options = { 24, 28, 0, (size_t)-1, 0 };
+    signed char board[SUDOKU_SIZE][SUDOKU_SIZE];
+    Random_t random;
+    int clues = 0;
+
+    for (unsigned long long seed = 1; seed <= TEST_GENERATOR_SEEDS; seed++)
+    {
+        SeedRandom(&random, seed, 0);
+        CHECK(GenerateUniquePuzzle(board, &options, &random) == ERR_OK);
+        clues = CountClues(board);
+        CHECK(clues >= options.minClues && clues <= options.maxClues);
+        CHECK(CountSolutions(board, 2) == 1);
+    }
+
+    // A single clue count is met exactly
+    options.minClues = options.maxClues = 30;
+    for (unsigned long long seed = 1; seed <= TEST_GENERATOR_SEEDS; seed++)
+    {
+        SeedRandom(&random, seed, 1);
+        CHECK(GenerateUniquePuzzle(board, &options, &random) == ERR_OK);
+        CHECK(CountClues(board) == 30);
+        CHECK(CountSolutions(board, 2) == 1);
+    }
+}
+
+static void TestSameStreamSamePuzzle(void)
+{
+    signed char first[SUDOKU_SIZE][SUDOKU_SIZE], second[SUDOKU_SIZE][SUDOKU_SIZE];
+    Random_t random;
+
+    SeedRandom(&random, 42, 3);
+    CHECK(CreateSudokuBoard(first, &random) == ERR_OK);
+    SeedRandom(&random, 42, 3);
+    CHECK(CreateSudokuBoard(second, &random) == ERR_OK);
+    CHECK(memcmp(first, second, sizeof(first)) == 0);
+    CHECK(CountSolutions(first, 2) == 1);
+}
+
+static void TestBudgetRunsOut(void)
+{
+    // No generator reaches 17 clues in a millisecond, it returns the closest unique puzzle it found instead
+    GeneratorOptions_t options = { 17, 17, 0, (size_t)-1, 1000000ull };
+    signed char board[SUDOKU_SIZE][SUDOKU_SIZE];
+    Random_t random;
+
+    SeedRandom(&random, 7, 0);
+    CHECK(GenerateUniquePuzzle(board, &options, &random) == ERR_NOT_FINISH);
+    CHECK(CountClues(board) > 17);
+    CHECK(CountSolutions(board, 2) == 1);
+}
+
+void TestBoard(void)
+{
+    TestTargetClueCount();
+    TestSameStreamSamePuzzle();
+    TestBudgetRunsOut();
+}
@@ -0,0 +1,254 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  Checks that a tournament restored from a checkpoint taken in the middle of the game ends with the
+    winners, losers, rounds and moves of the same tournament played without a break, and that a checkpoint which
+    was damaged, cut short or sealed again over records that cannot be taken back is refused.
+***************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#include "Errors.h"
+#include "Players.h"
+#include "Checkpoint.h"
+#include "Check.h"
+
+#define TEST_CHECKPOINT_PATH "Tests/TestCheckpoint.bin"
+#define TEST_TAMPERED_PATH "Tests/TestCheckpointTampered.bin"
+#define TEST_TOURNAMENT_PLAYERS 3000
+#define TEST_TOURNAMENT_BOARDS 16
+#define TEST_TOURNAMENT_SEED 25
+#define TEST_CHECKPOINT_ROUNDS 2
+#define FNV_OFFSET_BASIS 0xCBF29CE484222325ull
+#define FNV_PRIME 0x100000001B3ull
+
+/* A checkpoint read into memory */
+typedef struct CheckpointCopy
+{
+    char* data;
+    size_t size;
+} CheckpointCopy_t;
+
+static int ReadCheckpoint(const char* path, CheckpointCopy_t* copy)
+{
+    FILE* file = fopen(path, "rb");
+    long size = 0;
+
+    copy->data = NULL;
+    copy->size = 0;
+    if (!file)
+    {
+        return 0;
+    }
+    if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) > 0 && fseek(file, 0, SEEK_SET) == 0 &&
+        (copy->data = (char*)Allocate((size_t)size)) != NULL && fread(copy->data, 1, (size_t)size, file) == (size_t)size)
+    {
+        copy->size = (size_t)size;
+    }
+    fclose(file);
+
+    return copy->size != 0;
+}
+
+/**
+ * @brief Writes the first 'size' bytes of a checkpoint to 'path'.
+ */
+static int WriteCheckpoint(const char* path, const char* data, size_t size)
+{
+    FILE* file = fopen(path, "wb");
+    int written = 0;
+
+    if (file)
+    {
+        written = fwrite(data, 1, size, file) == size;
+        written = fclose(file) == 0 && written;
+    }
+
+    return written;
+}
+
+/**
+ * @brief Seals a checkpoint again with the checksum OpenCheckpoint expects, as Checkpoint.c computes it.
+ */
+static void SealCheckpoint(char* data, size_t size)
+{
+    CheckpointHeader_t* header = (CheckpointHeader_t*)data;
+    unsigned long long hash = FNV_OFFSET_BASIS, word = 0;
+    size_t i = 0;
+
+    header->checksum = 0;
+    for (; i + sizeof(word) <= size; i += sizeof(word))
+    {
+        memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * FNV_PRIME;
+    }
+    for (; i < size; i++)
+    {
+        hash = (hash ^ (unsigned char)data[i]) * FNV_PRIME;
+    }
+    header->checksum = hash;
+}
+
+/**
+ * @brief Plays a whole tournament, taking checkpoints every 'everyRounds' rounds unless it is 0.
+ */
+static Errors PlayWholeTournament(unsigned int everyRounds, TournamentStats_t* stats)
+{
+    ActivePlayerslistManeger_t* tournament = NULL;
+    Errors eErr;
+
+    memset(stats, 0, sizeof(*stats));
+    eErr = CreateTournament(&tournament, TEST_TOURNAMENT_PLAYERS, BOT_RANDOM, TEST_TOURNAMENT_BOARDS, TEST_TOURNAMENT_SEED);
+    if (eErr == ERR_OK && everyRounds)
+    {
+        eErr = SetTournamentCheckpoints(tournament, TEST_CHECKPOINT_PATH, everyRounds);
+    }
+    if (eErr == ERR_OK)
+    {
+        eErr = PlayTournament(tournament, stats);
+    }
+    DestroyTournament(tournament);
+
+    return eErr;
+}
+
+/**
+ * @brief Restores a tournament from a checkpoint file and plays it to the end.
+ */
+static Errors ResumeTournament(const char* path, TournamentStats_t* stats)
+{
+    ActivePlayerslistManeger_t* tournament = NULL;
+    Errors eErr;
+
+    memset(stats, 0, sizeof(*stats));
+    eErr = RestoreTournament(&tournament, path);
+    if (eErr == ERR_OK)
+    {
+        eErr = PlayTournament(tournament, stats);
+    }
+    DestroyTournament(tournament);
+
+    return eErr;
+}
+
+/**
+ * @brief Writes a copy of the checkpoint, damaged by 'offset' bytes into its records, and checks it is refused.
+ *  With 'reseal' set the copy gets a valid checksum, so the records themselves must be found wrong.
+ */
+static void CheckTamperedRefused(const CheckpointCopy_t* checkpoint, char* scratch, size_t offset, unsigned char value, int reseal)
+{
+    TournamentStats_t stats;
+
+    memcpy(scratch, checkpoint->data, checkpoint->size);
+    scratch[offset] = (char)value;
+    if (reseal)
+    {
+        SealCheckpoint(scratch, checkpoint->size);
+    }
+    if (CHECK(WriteCheckpoint(TEST_TAMPERED_PATH, scratch, checkpoint->size)))
+    {
+        CHECK(ResumeTournament(TEST_TAMPERED_PATH, &stats) != ERR_OK);
+    }
+}
+
+static void TestResumeMatchesWholeRun(void)
+{
+    TournamentStats_t whole, checkpointed, resumed;
+    CheckpointCopy_t checkpoint;
+    const CheckpointHeader_t* header = NULL;
+
+    CHECK(PlayWholeTournament(0, &whole) == ERR_OK);
+    CHECK(whole.wins > 0 && whole.wins < whole.players);
+
+    // Taking checkpoints does not change the game
+    CHECK(PlayWholeTournament(TEST_CHECKPOINT_ROUNDS, &checkpointed) == ERR_OK);
+    CHECK(checkpointed.checkpoints > 0 && checkpointed.checkpointsFailed == 0);
+    CHECK(checkpointed.wins == whole.wins && checkpointed.rounds == whole.rounds && checkpointed.moves == whole.moves);
+
+    // The last checkpoint was taken between two rounds, with winners and players still playing
+    if (!CHECK(ReadCheckpoint(TEST_CHECKPOINT_PATH, &checkpoint)))
+    {
+        return;
+    }
+    header = (const CheckpointHeader_t*)checkpoint.data;
+    CHECK(header->round > 0 && header->round < whole.rounds && header->round % TEST_CHECKPOINT_ROUNDS == 0);
+    CHECK(header->winners > 0 && header->live > 1);
+
+    CHECK(ResumeTournament(TEST_CHECKPOINT_PATH, &resumed) == ERR_OK);
+    CHECK(resumed.players == whole.players);
+    CHECK(resumed.wins == whole.wins);
+    CHECK(resumed.players - resumed.wins == whole.players - whole.wins);
+    CHECK(resumed.restoredRound == header->round);
+    CHECK(resumed.restoredRound + resumed.rounds == whole.rounds);
+    CHECK(header->moves + resumed.moves == whole.moves);
+    // A restored tournament does not write its checkpoint again before it plays on
+    CHECK(resumed.checkpoints == 0);
+
+    free(checkpoint.data);
+}
+
+static void TestDamagedCheckpointRefused(void)
+{
+    TournamentStats_t stats;
+    CheckpointCopy_t checkpoint;
+    const CheckpointHeader_t* header = NULL;
+    char* scratch = NULL;
+    size_t first = 0, record = 0;
+
+    if (!CHECK(PlayWholeTournament(TEST_CHECKPOINT_ROUNDS, &stats) == ERR_OK) ||
+        !CHECK(ReadCheckpoint(TEST_CHECKPOINT_PATH, &checkpoint)))
+    {
+        return;
+    }
+    scratch = (char*)Allocate(checkpoint.size);
+    header = (const CheckpointHeader_t*)checkpoint.data;
+    if (CHECK(scratch != NULL && header->live > 1))
+    {
+        first = sizeof(CheckpointHeader_t) + (size_t)header->winners * sizeof(CheckpointWinner_t);
+        record = sizeof(CheckpointPlayer_t);
+
+        // Sealing the copy as it is must keep it valid, or the resealed checks below would prove nothing
+        memcpy(scratch, checkpoint.data, checkpoint.size);
+        SealCheckpoint(scratch, checkpoint.size);
+        CHECK(memcmp(scratch, checkpoint.data, checkpoint.size) == 0);
+
+        // A byte changed anywhere no longer matches the checksum
+        CheckTamperedRefused(&checkpoint, scratch, offsetof(CheckpointHeader_t, round), 1, 0);
+        CheckTamperedRefused(&checkpoint, scratch, first + offsetof(CheckpointPlayer_t, board), 0x11, 0);
+        CheckTamperedRefused(&checkpoint, scratch, checkpoint.size - 1, (unsigned char)~checkpoint.data[checkpoint.size - 1], 0);
+
+        // A checkpoint cut short, even by a single record or byte, is refused
+        CHECK(WriteCheckpoint(TEST_TAMPERED_PATH, checkpoint.data, checkpoint.size - record));
+        CHECK(ResumeTournament(TEST_TAMPERED_PATH, &stats) != ERR_OK);
+        CHECK(WriteCheckpoint(TEST_TAMPERED_PATH, checkpoint.data, checkpoint.size - 1));
+        CHECK(ResumeTournament(TEST_TAMPERED_PATH, &stats) != ERR_OK);
+        CHECK(WriteCheckpoint(TEST_TAMPERED_PATH, checkpoint.data, sizeof(CheckpointHeader_t) - 1));
+        CHECK(ResumeTournament(TEST_TAMPERED_PATH, &stats) != ERR_OK);
+
+        // Sealed again, a digit that does not exist and a player restored twice are still refused
+        CheckTamperedRefused(&checkpoint, scratch, first + offsetof(CheckpointPlayer_t, board), 0xA1, 1);
+        memcpy(scratch, checkpoint.data, checkpoint.size);
+        memcpy(scratch + first + record + offsetof(CheckpointPlayer_t, index), checkpoint.data + first + offsetof(CheckpointPlayer_t, index), sizeof(unsigned int));
+        SealCheckpoint(scratch, checkpoint.size);
+        CHECK(WriteCheckpoint(TEST_TAMPERED_PATH, scratch, checkpoint.size));
+        CHECK(ResumeTournament(TEST_TAMPERED_PATH, &stats) != ERR_OK);
+
+        // A missing file is refused too
+        remove(TEST_TAMPERED_PATH);
+        CHECK(ResumeTournament(TEST_TAMPERED_PATH, &stats) != ERR_OK);
+    }
+
+    free(scratch);
+    free(checkpoint.data);
+}
+
+void TestCheckpoint(void)
+{
+    TestResumeMatchesWholeRun();
+    TestDamagedCheckpointRefused();
+    remove(TEST_CHECKPOINT_PATH);
+    remove(TEST_TAMPERED_PATH);
+}
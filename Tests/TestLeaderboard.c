@@ -0,0 +1,183 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  Checks the leaderboard while winners are added with many equal scores: the treap keeps its order,
+    heap and subtree size invariants, every rank query agrees with a plain sort of the scores, the pages are the
+    runs of ranks they start at and the finishing order is the order the winners came in.
+***************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "Errors.h"
+#include "Leaderboard.h"
+#include "Platform.h"
+#include "Check.h"
+
+#define TEST_LEADERBOARD_CAPACITY 1500
+#define TEST_LEADERBOARD_CHECK_EVERY 97
+#define TEST_PAGE_SIZE 10
+
+/**
+ * @brief The reference order: the lower round, then the fewer moves, then the earlier finish.
+ */
+static int CompareReference(const void* left, const void* right)
+{
+    const LeaderboardEntry_t* a = *(LeaderboardEntry_t* const*)left, * b = *(LeaderboardEntry_t* const*)right;
+
+    if (a->score.round != b->score.round)
+    {
+        return a->score.round < b->score.round ? -1 : 1;
+    }
+    if (a->score.moves != b->score.moves)
+    {
+        return a->score.moves < b->score.moves ? -1 : 1;
+    }
+
+    return a->order < b->order ? -1 : a->order > b->order;
+}
+
+/**
+ * @brief Checks the treap below an entry and returns the number of entries in it.
+ */
+static size_t CheckSubtree(const LeaderboardEntry_t* entry)
+{
+    size_t left = 0, right = 0;
+
+    if (!entry)
+    {
+        return 0;
+    }
+    if (entry->left)
+    {
+        CHECK(entry->left->parent == entry);
+        CHECK(entry->left->priority <= entry->priority);
+        CHECK(CompareReference(&entry->left, &entry) < 0);
+    }
+    if (entry->right)
+    {
+        CHECK(entry->right->parent == entry);
+        CHECK(entry->right->priority <= entry->priority);
+        CHECK(CompareReference(&entry->right, &entry) > 0);
+    }
+    left = CheckSubtree(entry->left);
+    right = CheckSubtree(entry->right);
+    CHECK(entry->size == left + right + 1);
+
+    return left + right + 1;
+}
+
+/**
+ * @brief Checks every query of the leaderboard against the winners sorted by the reference order.
+ */
+static void CheckLeaderboard(const Leaderboard_t* leaderboard, LeaderboardEntry_t** added, LeaderboardEntry_t** sorted)
+{
+    LeaderboardEntry_t* page[TEST_PAGE_SIZE];
+    LeaderboardEntry_t* entry = NULL;
+    size_t count = leaderboard->count, copied = 0, expected = 0;
+
+    CHECK(leaderboard->root == NULL || leaderboard->root->parent == NULL);
+    CHECK(CheckSubtree(leaderboard->root) == count);
+
+    // The finishing order is the order the winners were added in
+    entry = leaderboard->first;
+    for (size_t i = 0; i < count; i++, entry = entry->next)
+    {
+        if (!CHECK(entry == added[i] && entry->order == i + 1))
+        {
+            return;
+        }
+    }
+    CHECK(entry == NULL && leaderboard->last == (count ? added[count - 1] : NULL));
+
+    memcpy(sorted, added, count * sizeof(LeaderboardEntry_t*));
+    qsort(sorted, count, sizeof(LeaderboardEntry_t*), CompareReference);
+    for (size_t rank = 1; rank <= count; rank++)
+    {
+        CHECK(GetLeaderboardEntryAt(leaderboard, rank) == sorted[rank - 1]);
+        CHECK(GetLeaderboardRank(sorted[rank - 1]) == rank);
+        CHECK(GetNextByRank(sorted[rank - 1]) == (rank < count ? sorted[rank] : NULL));
+    }
+    CHECK(GetLeaderboardEntryAt(leaderboard, 0) == NULL);
+    CHECK(GetLeaderboardEntryAt(leaderboard, count + 1) == NULL);
+
+    // A page is the run of ranks it starts at, cut short at the end of the leaderboard
+    for (size_t first = 1; first <= count + 1; first += 1 + first / 3)
+    {
+        expected = count - first + 1 < TEST_PAGE_SIZE ? count - first + 1 : TEST_PAGE_SIZE;
+        copied = GetLeaderboardPage(leaderboard, first, TEST_PAGE_SIZE, page);
+        if (CHECK(copied == expected))
+        {
+            CHECK(memcmp(page, sorted + first - 1, copied * sizeof(LeaderboardEntry_t*)) == 0);
+        }
+    }
+    CHECK(GetLeaderboardPage(leaderboard, count + 2, TEST_PAGE_SIZE, page) == 0);
+}
+
+static void TestRanks(void)
+{
+    Leaderboard_t leaderboard;
+    Arena_t arena;
+    LeaderboardEntry_t** added = NULL, ** sorted = NULL;
+    LeaderboardScore_t score;
+    Random_t random;
+    size_t count = 0;
+
+    added = (LeaderboardEntry_t**)Allocate(TEST_LEADERBOARD_CAPACITY * sizeof(LeaderboardEntry_t*));
+    sorted = (LeaderboardEntry_t**)Allocate(TEST_LEADERBOARD_CAPACITY * sizeof(LeaderboardEntry_t*));
+    if (!CHECK(added && sorted && CreateArena(&arena, LeaderboardArenaSize(TEST_LEADERBOARD_CAPACITY)) == ERR_OK))
+    {
+        free(added);
+        free(sorted);
+        return;
+    }
+
+    if (CHECK(CreateLeaderboard(&leaderboard, &arena, TEST_LEADERBOARD_CAPACITY) == ERR_OK))
+    {
+        CheckLeaderboard(&leaderboard, added, sorted);
+
+        // Few distinct scores, so most winners tie with earlier ones and are ranked by their finish
+        SeedRandom(&random, 16, 0);
+        for (count = 0; count < TEST_LEADERBOARD_CAPACITY; count++)
+        {
+            score.round = 1 + RandomBelow(&random, 6);
+            score.moves = RandomBelow(&random, 8);
+            added[count] = AddToLeaderboard(&leaderboard, NULL, &score);
+            if (!CHECK(added[count] != NULL))
+            {
+                break;
+            }
+            if (count < 20 || count % TEST_LEADERBOARD_CHECK_EVERY == 0)
+            {
+                CheckLeaderboard(&leaderboard, added, sorted);
+            }
+        }
+        CheckLeaderboard(&leaderboard, added, sorted);
+
+        // A full leaderboard takes no more winners and stays as it was
+        CHECK(AddToLeaderboard(&leaderboard, NULL, &score) == NULL);
+        CHECK(leaderboard.count == count);
+    }
+
+    DestroyArena(&arena);
+    free(sorted);
+    free(added);
+}
+
+static void TestArenaTooSmall(void)
+{
+    Leaderboard_t leaderboard;
+    Arena_t arena;
+
+    if (CHECK(CreateArena(&arena, LeaderboardArenaSize(10)) == ERR_OK))
+    {
+        CHECK(CreateLeaderboard(&leaderboard, &arena, 1000) == ERR_ALLOCATION_FAILED);
+        DestroyArena(&arena);
+    }
+}
+
+void TestLeaderboard(void)
+{
+    TestRanks();
+    TestArenaTooSmall();
+}
@@ -0,0 +1,37 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  Runs every suite of checks and reports how many failed.
+***************************************************************************************/
+
+#include <stdio.h>
+
+#include "Check.h"
+
+static unsigned int g_checks = 0;
+static unsigned int g_failures = 0;
+
+int RecordCheck(int passed, const char* condition, const char* file, int line)
+{
+    ++g_checks;
+    if (!passed)
+    {
+        ++g_failures;
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, condition);
+    }
+
+    return passed;
+}
+
+int main(void)
+{
+    TestSolver();
+    TestBoard();
+    TestPlayers();
+    TestLeaderboard();
+    TestCheckpoint();
+
+    fprintf(stderr, "%u checks, %u failed\n", g_checks, g_failures);
+
+    return g_failures ? 1 : 0;
+}
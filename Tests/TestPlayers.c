@@ -0,0 +1,129 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  Checks the ranking of the players against a plain reference sort. The player record is private
+    to Players.c, so this file includes it to build players with chosen names and filled counts; the test build
+    links this file in place of Players.o.
+***************************************************************************************/
+
+#include "Players.c"
+#include "Check.h"
+
+#define TEST_RANK_PLAYERS 3000
+#define TEST_RANK_SEEDS 4
+#define TEST_NAME_SIZE 64
+
+/* The players of a check and the reference order they must be ranked in */
+typedef struct RankCheck
+{
+    Player_t* players;
+    char (*names)[TEST_NAME_SIZE];
+    Player_t** ranked;
+    Player_t** expected;
+} RankCheck_t;
+
+/**
+ * @brief The reference order: fewer filled slots first, then the name by strcmp, then the order the players came in.
+ */
+static int CompareReference(const void* left, const void* right)
+{
+    const Player_t* a = *(Player_t* const*)left, * b = *(Player_t* const*)right;
+    int names = 0;
+
+    if (a->game.possibilities.filled != b->game.possibilities.filled)
+    {
+        return a->game.possibilities.filled < b->game.possibilities.filled ? -1 : 1;
+    }
+    names = strcmp(a->name, b->name);
+    if (names)
+    {
+        return names;
+    }
+
+    // The players are laid out in the order they came in
+    return a < b ? -1 : a > b;
+}
+
+/**
+ * @brief Ranks the first 'size' players with RankPlayers and with the reference sort and checks they agree.
+ */
+static void CheckRanking(RankCheck_t* check, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        check->ranked[i] = check->expected[i] = &check->players[i];
+    }
+    qsort(check->expected, size, sizeof(Player_t*), CompareReference);
+
+    CHECK(RankPlayers(check->ranked, size) == ERR_OK);
+    CHECK(memcmp(check->ranked, check->expected, size * sizeof(Player_t*)) == 0);
+}
+
+/**
+ * @brief Writes a name that shares a long prefix with many others, is often equal to another name or a prefix
+ *  of it, and may hold bytes above 0x7F, which must order after every ASCII byte like they do in strcmp.
+ */
+static void DrawName(char* name, Random_t* random)
+{
+    static const char* prefixes[] = { "", "a", "bot", "tournament-player-", "tournament-player-from-the-same-club-" };
+    static const char suffix[] = { 'a', 'b', 'z', (char)0xC3 };
+    size_t length = 0;
+
+    strcpy(name, prefixes[RandomBelow(random, sizeof(prefixes) / sizeof(prefixes[0]))]);
+    length = strlen(name);
+    for (unsigned int i = RandomBelow(random, 4); i > 0; i--)
+    {
+        name[length++] = suffix[RandomBelow(random, sizeof(suffix))];
+    }
+    name[length] = '\0';
+}
+
+/**
+ * @brief Draws the players of a check, 'buckets' is the number of distinct filled counts among them.
+ */
+static void DrawPlayers(RankCheck_t* check, size_t size, unsigned int buckets, Random_t* random)
+{
+    memset(check->players, 0, size * sizeof(Player_t));
+    for (size_t i = 0; i < size; i++)
+    {
+        DrawName(check->names[i], random);
+        check->players[i].name = check->names[i];
+        check->players[i].game.possibilities.filled = (unsigned char)(RandomBelow(random, buckets) * SUDOKU_CELLS / (buckets - 1 ? buckets - 1 : 1));
+    }
+}
+
+void TestPlayers(void)
+{
+    RankCheck_t check;
+    Random_t random;
+
+    check.players = (Player_t*)AllocateAligned(CACHE_LINE_SIZE, TEST_RANK_PLAYERS * sizeof(Player_t));
+    check.names = Allocate(TEST_RANK_PLAYERS * sizeof(check.names[0]));
+    check.ranked = (Player_t**)Allocate(TEST_RANK_PLAYERS * sizeof(Player_t*));
+    check.expected = (Player_t**)Allocate(TEST_RANK_PLAYERS * sizeof(Player_t*));
+    if (CHECK(check.players && check.names && check.ranked && check.expected))
+    {
+        SeedRandom(&random, 1, 0);
+        for (size_t size = 0; size <= RANK_INSERTION_LIMIT + 2; size++)
+        {
+            DrawPlayers(&check, size, 2, &random);
+            CheckRanking(&check, size);
+        }
+        for (unsigned long long seed = 1; seed <= TEST_RANK_SEEDS; seed++)
+        {
+            // Few filled counts give large buckets of equal names, every count gives small ones
+            SeedRandom(&random, seed, 1);
+            DrawPlayers(&check, TEST_RANK_PLAYERS, 1, &random);
+            CheckRanking(&check, TEST_RANK_PLAYERS);
+            DrawPlayers(&check, TEST_RANK_PLAYERS, 4, &random);
+            CheckRanking(&check, TEST_RANK_PLAYERS);
+            DrawPlayers(&check, TEST_RANK_PLAYERS, SUDOKU_CELLS + 1, &random);
+            CheckRanking(&check, TEST_RANK_PLAYERS);
+        }
+    }
+
+    free(check.expected);
+    free(check.ranked);
+    free(check.names);
+    FreeAligned(check.players);
+}
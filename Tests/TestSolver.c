@@ -0,0 +1,198 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  Checks the solver on known puzzles with no solution, one solution and more than one: the
+    solutions NextSolution enumerates, the counts CountSolutions returns and the searches ExcludeSolutionDigit restricts.
+***************************************************************************************/
+
+#include <string.h>
+
+#include "Errors.h"
+#include "Solver.h"
+#include "Check.h"
+
+/* A puzzle with a single solution, '0' for an empty slot */
+static const char* g_uniquePuzzle =
+    "530070000600195000098000060800060003400803001700020006060000280000419005000080079";
+
+static const char* g_uniqueSolution =
+    "534678912672195348198342567859761423426853791713924856961537284287419635345286179";
+
+/**
+ * @brief Reads a board from 81 digits, '0' for an empty slot.
+ */
+static void ReadBoard(signed char board[][SUDOKU_SIZE], const char* digits)
+{
+    for (int i = 0; i < SUDOKU_CELLS; i++)
+    {
+        board[i / SUDOKU_SIZE][i % SUDOKU_SIZE] = digits[i] == '0' ? -1 : (signed char)(digits[i] - '0');
+    }
+}
+
+/**
+ * @brief Returns 1 if 'solution' is a full legal grid that keeps every clue of 'puzzle'.
+ */
+static int IsSolutionOf(signed char solution[][SUDOKU_SIZE], signed char puzzle[][SUDOKU_SIZE])
+{
+    unsigned short rows[SUDOKU_SIZE] = { 0 }, columns[SUDOKU_SIZE] = { 0 }, boxes[SUDOKU_SIZE] = { 0 };
+    unsigned short bit = 0;
+
+    for (int x = 0; x < SUDOKU_SIZE; x++)
+    {
+        for (int y = 0; y < SUDOKU_SIZE; y++)
+        {
+            if (solution[x][y] < 1 || solution[x][y] > SUDOKU_SIZE || (puzzle[x][y] != -1 && puzzle[x][y] != solution[x][y]))
+            {
+                return 0;
+            }
+            bit = (unsigned short)(1 << (solution[x][y] - 1));
+            if ((rows[x] & bit) || (columns[y] & bit) || (boxes[BOX_OF(x, y)] & bit))
+            {
+                return 0;
+            }
+            rows[x] |= bit;
+            columns[y] |= bit;
+            boxes[BOX_OF(x, y)] |= bit;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Enumerates the solutions of a board with NextSolution, checking each one is a distinct solution of it.
+ *
+ * @return the number of solutions, stopping at 'limit'.
+ */
+static size_t EnumerateSolutions(signed char board[][SUDOKU_SIZE], size_t limit)
+{
+    signed char solutions[4][SUDOKU_SIZE][SUDOKU_SIZE];
+    SolutionIterator_t* iterator = CreateSolutionIterator(board);
+    size_t count = 0;
+
+    if (!CHECK(iterator != NULL))
+    {
+        return 0;
+    }
+    while (count < limit && NextSolution(iterator, solutions[count % 4]))
+    {
+        CHECK(IsSolutionOf(solutions[count % 4], board));
+        for (size_t other = count < 4 ? 0 : count - 3; other < count; other++)
+        {
+            CHECK(memcmp(solutions[count % 4], solutions[other % 4], sizeof(solutions[0])) != 0);
+        }
+        ++count;
+    }
+    DestroySolutionIterator(iterator);
+
+    return count;
+}
+
+static void TestNoSolution(void)
+{
+    signed char board[SUDOKU_SIZE][SUDOKU_SIZE];
+
+    // No placed digit breaks a rule, but the last slot of the first row is left without a digit
+    ReadBoard(board, "123456780000000009000000000000000000000000000000000000000000000000000000000000000");
+    CHECK(EnumerateSolutions(board, 2) == 0);
+    CHECK(CountSolutions(board, 2) == 0);
+    CHECK(SolveBoard(board) == ERR_FINISH_FAILURE);
+
+    // A clue of the unique puzzle changed so the puzzle is still legal but no longer solvable
+    ReadBoard(board, g_uniquePuzzle);
+    board[0][2] = 1;
+    CHECK(EnumerateSolutions(board, 2) == 0);
+    CHECK(CountSolutions(board, 2) == 0);
+}
+
+static void TestUniqueSolution(void)
+{
+    signed char board[SUDOKU_SIZE][SUDOKU_SIZE], expected[SUDOKU_SIZE][SUDOKU_SIZE], solved[SUDOKU_SIZE][SUDOKU_SIZE];
+    SolutionIterator_t* iterator = NULL;
+
+    ReadBoard(board, g_uniquePuzzle);
+    ReadBoard(expected, g_uniqueSolution);
+    CHECK(EnumerateSolutions(board, 4) == 1);
+    CHECK(CountSolutions(board, 2) == 1);
+    CHECK(CountSolutions(board, 100) == 1);
+
+    memcpy(solved, board, sizeof(solved));
+    CHECK(SolveBoard(solved) == ERR_OK);
+    CHECK(memcmp(solved, expected, sizeof(solved)) == 0);
+
+    // A full grid is its own single solution
+    CHECK(CountSolutions(expected, 2) == 1);
+
+    // Excluding the digit of the solution from an empty slot leaves nothing to find
+    iterator = CreateSolutionIterator(board);
+    if (CHECK(iterator != NULL))
+    {
+        ExcludeSolutionDigit(iterator, 0, 2, expected[0][2]);
+        CHECK(NextSolution(iterator, NULL) == 0);
+        DestroySolutionIterator(iterator);
+    }
+}
+
+static void TestManySolutions(void)
+{
+    signed char board[SUDOKU_SIZE][SUDOKU_SIZE];
+
+    // An empty board has more solutions than any limit
+    memset(board, -1, sizeof(board));
+    CHECK(EnumerateSolutions(board, 3) == 3);
+    CHECK(CountSolutions(board, 2) == 2);
+    CHECK(CountSolutions(board, 50) == 50);
+
+    // Rows 0 and 3 hold 6 7 and 7 6 in columns 3 and 4 of the same box column, so the four slots can swap
+    ReadBoard(board, g_uniqueSolution);
+    board[0][3] = board[0][4] = board[3][3] = board[3][4] = -1;
+    CHECK(EnumerateSolutions(board, 4) == 2);
+    CHECK(CountSolutions(board, 2) == 2);
+    CHECK(CountSolutions(board, 100) == 2);
+}
+
+/**
+ * @brief Removing a clue keeps the puzzle unique exactly when excluding the clue's digit from its slot leaves no solution.
+ */
+static void TestExcludeSolutionDigit(void)
+{
+    signed char board[SUDOKU_SIZE][SUDOKU_SIZE], solution[SUDOKU_SIZE][SUDOKU_SIZE];
+    SolutionIterator_t* iterator = NULL;
+    signed char clue = 0;
+    int found = 0;
+
+    ReadBoard(board, g_uniquePuzzle);
+    for (int x = 0; x < SUDOKU_SIZE; x++)
+    {
+        for (int y = 0; y < SUDOKU_SIZE; y++)
+        {
+            if (board[x][y] == -1)
+            {
+                continue;
+            }
+            clue = board[x][y];
+            board[x][y] = -1;
+            iterator = CreateSolutionIterator(board);
+            if (CHECK(iterator != NULL))
+            {
+                ExcludeSolutionDigit(iterator, x, y, clue);
+                found = NextSolution(iterator, solution);
+                CHECK(found == (CountSolutions(board, 2) == 2));
+                if (found)
+                {
+                    CHECK(IsSolutionOf(solution, board) && solution[x][y] != clue);
+                }
+                DestroySolutionIterator(iterator);
+            }
+            board[x][y] = clue;
+        }
+    }
+}
+
+void TestSolver(void)
+{
+    TestNoSolution();
+    TestUniqueSolution();
+    TestManySolutions();
+    TestExcludeSolutionDigit();
+}
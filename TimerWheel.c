@@ -0,0 +1,233 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  A hierarchical timer wheel. A slot is a singly linked list whose nodes also point back at the
+    pointer that points at them, so any timer is unlinked without walking its slot. A timer is placed on the lowest
+    level whose span covers its distance from the clock; on every tick the first level slot of the tick expires,
+    and each time a level wraps around the next slot of the level above is spread over the levels below it.
+***************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "Errors.h"
+#include "TimerWheel.h"
+#include "Bits.h"
+
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+/* The furthest a timer can be placed from the clock, a later one is placed here and placed again when it comes down */
+#define TIMER_WHEEL_SPAN ((1ull << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1)
+
+void InitTimerWheel(TimerWheel_t* wheel, unsigned long long now)
+{
+    memset(wheel, 0, sizeof(TimerWheel_t));
+    wheel->now = now;
+}
+
+void InitTimer(Timer_t* timer, void* data)
+{
+    timer->next = NULL;
+    timer->link = NULL;
+    timer->deadline = 0;
+    timer->data = data;
+    timer->slot = 0;
+}
+
+int IsTimerScheduled(const Timer_t* timer)
+{
+    return timer->link != NULL;
+}
+
+/**
+ * @brief Links a timer into the slot its deadline falls in, as seen from the clock of the wheel.
+ */
+static void PlaceTimer(TimerWheel_t* wheel, Timer_t* timer)
+{
+    unsigned long long deadline = timer->deadline, distance = 0;
+    int level = 0, slot = 0;
+    Timer_t** head = NULL;
+
+    if (deadline < wheel->now)
+    {
+        deadline = wheel->now;
+    }
+    distance = deadline - wheel->now;
+    if (distance > TIMER_WHEEL_SPAN)
+    {
+        distance = TIMER_WHEEL_SPAN;
+        deadline = wheel->now + distance;
+    }
+    while (level < TIMER_WHEEL_LEVELS - 1 && distance >= 1ull << (TIMER_WHEEL_BITS * (level + 1)))
+    {
+        ++level;
+    }
+    slot = (int)((deadline >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK);
+
+    head = &wheel->slots[level][slot];
+    timer->next = *head;
+    if (timer->next)
+    {
+        timer->next->link = &timer->next;
+    }
+    *head = timer;
+    timer->link = head;
+    timer->slot = (unsigned short)(level * TIMER_WHEEL_SLOTS + slot);
+    if (level == 0)
+    {
+        wheel->occupied[slot / 32] |= 1u << (slot % 32);
+    }
+}
+
+/**
+ * @brief Unlinks a scheduled timer from its slot.
+ */
+static void UnlinkTimer(TimerWheel_t* wheel, Timer_t* timer)
+{
+    *timer->link = timer->next;
+    if (timer->next)
+    {
+        timer->next->link = timer->link;
+    }
+    if (timer->slot < TIMER_WHEEL_SLOTS && !wheel->slots[0][timer->slot])
+    {
+        wheel->occupied[timer->slot / 32] &= ~(1u << (timer->slot % 32));
+    }
+    timer->next = NULL;
+    timer->link = NULL;
+}
+
+void ScheduleTimer(TimerWheel_t* wheel, Timer_t* timer, unsigned long long deadline)
+{
+    if (timer->link)
+    {
+        UnlinkTimer(wheel, timer);
+    }
+    else
+    {
+        ++wheel->count;
+    }
+    timer->deadline = deadline;
+    PlaceTimer(wheel, timer);
+}
+
+void CancelTimer(TimerWheel_t* wheel, Timer_t* timer)
+{
+    if (timer->link)
+    {
+        UnlinkTimer(wheel, timer);
+        --wheel->count;
+    }
+}
+
+/**
+ * @brief Spreads the timers of a slot above the first level over the levels below it.
+ */
+static void CascadeSlot(TimerWheel_t* wheel, int level, int slot)
+{
+    Timer_t* timer = wheel->slots[level][slot], * next = NULL;
+
+    wheel->slots[level][slot] = NULL;
+    for (; timer; timer = next)
+    {
+        next = timer->next;
+        PlaceTimer(wheel, timer);
+    }
+}
+
+/**
+ * @brief Returns the first slot of the first level from 'slot' on that holds a timer, TIMER_WHEEL_SLOTS if none does.
+ */
+static int NextOccupiedSlot(const TimerWheel_t* wheel, int slot)
+{
+    unsigned int bits = 0;
+
+    for (int word = slot / 32; word < TIMER_WHEEL_SLOTS / 32; word++)
+    {
+        bits = wheel->occupied[word];
+        if (word == slot / 32)
+        {
+            bits &= ~0u << (slot % 32);
+        }
+        if (bits)
+        {
+            return word * 32 + LowestBitIndex(bits);
+        }
+    }
+
+    return TIMER_WHEEL_SLOTS;
+}
+
+size_t AdvanceTimerWheel(TimerWheel_t* wheel, unsigned long long now, TimerFunction_t expire, void* context)
+{
+    Timer_t* timer = NULL, * pending = NULL;
+    unsigned long long skip = 0;
+    size_t expired = 0;
+    int slot = 0, level = 0;
+
+    while (wheel->now <= now)
+    {
+        if (!wheel->count)
+        {
+            wheel->now = now + 1;
+            break;
+        }
+        slot = (int)(wheel->now & TIMER_WHEEL_MASK);
+        if (slot == 0)
+        {
+            // Every level that wrapped around brings its next slot down
+            for (level = 1; level < TIMER_WHEEL_LEVELS; level++)
+            {
+                slot = (int)((wheel->now >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK);
+                CascadeSlot(wheel, level, slot);
+                if (slot != 0)
+                {
+                    break;
+                }
+            }
+            slot = 0;
+        }
+        else
+        {
+            // Empty ticks are passed over up to the next timer of the first level or its wrap
+            skip = (unsigned long long)(NextOccupiedSlot(wheel, slot) - slot);
+            if (skip)
+            {
+                wheel->now += skip < now - wheel->now + 1 ? skip : now - wheel->now + 1;
+                continue;
+            }
+        }
+
+        // The slot is taken off the wheel first: 'expire' may schedule a timer into it for the next round of the level
+        ++wheel->now;
+        pending = wheel->slots[0][slot];
+        wheel->slots[0][slot] = NULL;
+        wheel->occupied[slot / 32] &= ~(1u << (slot % 32));
+        if (pending)
+        {
+            pending->link = &pending;
+        }
+        while ((timer = pending) != NULL)
+        {
+            UnlinkTimer(wheel, timer);
+            --wheel->count;
+            ++expired;
+            expire(timer, context);
+        }
+    }
+
+    return expired;
+}
+
+int NextTimerDelay(const TimerWheel_t* wheel)
+{
+    int slot = (int)(wheel->now & TIMER_WHEEL_MASK);
+
+    if (!wheel->count)
+    {
+        return -1;
+    }
+
+    // The clock of the wheel is the tick after the last one advanced to. Past the last timer of the first level,
+    // only its wrap can bring a timer closer
+    return NextOccupiedSlot(wheel, slot) - slot + 1;
+}
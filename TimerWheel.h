@@ -0,0 +1,98 @@
+/**************************************************************************************
+    Author: Mordechai Ben Shimon
+    Creation date :  18/10/26
+    Description :  A hierarchical timer wheel, the way one thread keeps the deadlines of every player it serves.
+    Time is counted in ticks (the game uses milliseconds). The wheel has TIMER_WHEEL_LEVELS levels of
+    TIMER_WHEEL_SLOTS slots, a slot of level n spans TIMER_WHEEL_SLOTS^n ticks, so the first level holds the next
+    256 ticks one tick per slot and the four levels reach 2^32 ticks ahead. A timer is a node the owner embeds in
+    its own struct, so scheduling allocates nothing, and scheduling or cancelling a timer costs the same however
+    many timers are waiting. When the first level wraps around, the slot of the next level that comes due is
+    spread over the first level again.
+***************************************************************************************/
+
+#ifndef __TIMER_WHEEL_H__
+#define __TIMER_WHEEL_H__
+
+#include <stddef.h>
+
+#define TIMER_WHEEL_BITS 8
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS 4
+
+typedef struct Timer
+{
+    struct Timer* next;
+    struct Timer** link;                /* the pointer that points at this timer, NULL while it is not scheduled */
+    unsigned long long deadline;        /* the tick the timer expires on */
+    void* data;                         /* handed back with the timer when it expires */
+    unsigned short slot;                /* level * TIMER_WHEEL_SLOTS + the slot the timer waits in */
+} Timer_t;
+
+typedef struct TimerWheel
+{
+    Timer_t* slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    unsigned int occupied[TIMER_WHEEL_SLOTS / 32];  /* the slots of the first level that hold a timer */
+    unsigned long long now;             /* the next tick to expire */
+    size_t count;                       /* the scheduled timers */
+} TimerWheel_t;
+
+/**
+ * @brief Called with every timer that expires, the timer is no longer scheduled and may be scheduled again.
+ */
+typedef void (*TimerFunction_t)(Timer_t* timer, void* context);
+
+
+/**
+ * @brief Empties a wheel whose clock reads 'now'.
+ */
+void InitTimerWheel(TimerWheel_t* wheel, unsigned long long now);
+
+/**
+ * @brief Prepares a timer that is not scheduled.
+ *
+ * @param timer: the timer.
+ * @param data: what the timer is handed back with.
+ */
+void InitTimer(Timer_t* timer, void* data);
+
+/**
+ * @brief Schedules a timer, or moves it if it is already scheduled.
+ *
+ * @param wheel: the wheel.
+ * @param timer: the timer.
+ * @param deadline: the tick it expires on, a tick that passed expires on the next advance.
+ */
+void ScheduleTimer(TimerWheel_t* wheel, Timer_t* timer, unsigned long long deadline);
+
+/**
+ * @brief Cancels a timer, a timer that is not scheduled is left as it is.
+ */
+void CancelTimer(TimerWheel_t* wheel, Timer_t* timer);
+
+/**
+ * @brief Returns whether a timer is waiting to expire.
+ */
+int IsTimerScheduled(const Timer_t* timer);
+
+/**
+ * @brief Moves the clock of a wheel to 'now' and expires every timer whose deadline is not later.
+ *
+ * @param wheel: the wheel.
+ * @param now: the current tick.
+ * @param expire: called with every timer that expires, it may schedule and cancel timers.
+ * @param context: handed to 'expire'.
+ *
+ * @return the number of timers that expired.
+ */
+size_t AdvanceTimerWheel(TimerWheel_t* wheel, unsigned long long now, TimerFunction_t expire, void* context);
+
+/**
+ * @brief Returns how many ticks after the tick the wheel was last advanced to the next timer may expire, so an event
+ *  loop can wait that long. It is exact for the timers of the first level and never late for the others, which
+ *  are only waited for up to the next wrap of the first level (at most TIMER_WHEEL_SLOTS ticks).
+ *
+ * @return the ticks, or -1 when no timer is scheduled.
+ */
+int NextTimerDelay(const TimerWheel_t* wheel);
+
+#endif /*__TIMER_WHEEL_H__*/
@@ -9,33 +9,180 @@
 #define _CRT_SECURE_NO_WARNINGS
 #include <stdlib.h>
 #include <stdio.h>
-#include <time.h>
+#include <string.h>
+#include <stdarg.h>
 
 #include "Errors.h"
 #include "Ui.h"
 #include "Players.h"
 #include "Solver.h"
+#include "Platform.h"
 
 
-struct Player
+#define FRAME_SIZE 4096
+#define CLEAR_SCREEN "\033[H\033[2J"
+/* The rows and columns of the terminal (from 1) where a board drawn from the top of the screen puts its parts */
+#define FRAME_TITLE_ROW 2
+#define FRAME_BOARD_ROW 6
+#define FRAME_BOARD_COLUMN 4
+#define FRAME_PROMPT_ROW 18
+/* A longer name would wrap the title and move every row below it */
+#define FRAME_NAME_LENGTH 48
+
+typedef struct Frame
 {
-    char name[100];
-    short board[9][9];
-    Array_t*** possibilities;
-};
+    char text[FRAME_SIZE];                          /* the output gathered for the next write */
+    size_t length;
+    signed char shown[SUDOKU_SIZE][SUDOKU_SIZE];    /* the board the terminal shows, when 'valid' */
+    int valid;                                      /* the screen holds a board frame drawn from its top */
+} Frame_t;
+
+static Frame_t g_frame;
 
-struct WinningPlayers
+static void AppendText(const char* text, size_t length)
 {
-    Player_t* winner;
-    WinningPlayers_t* next;
-};
+    if (length > FRAME_SIZE - g_frame.length)
+    {
+        length = FRAME_SIZE - g_frame.length;
+    }
+    memcpy(g_frame.text + g_frame.length, text, length);
+    g_frame.length += length;
+}
 
+static void AppendFormat(const char* format, ...)
+{
+    va_list args;
+    int length = 0;
+
+    if (g_frame.length == FRAME_SIZE)
+    {
+        return;
+    }
+    va_start(args, format);
+    length = vsnprintf(g_frame.text + g_frame.length, FRAME_SIZE - g_frame.length, format, args);
+    va_end(args);
+    if (length > 0)
+    {
+        g_frame.length += (size_t)length < FRAME_SIZE - g_frame.length ? (size_t)length : FRAME_SIZE - 1 - g_frame.length;
+    }
+}
+
+/**
+ * @brief Appends one slot as the board shows it: a yellow digit, or blanks for an empty slot.
+ */
+static void AppendCell(signed char value)
+{
+    char digit[] = "\033[1;93m 0\033[0m";
+
+    if (value == -1)
+    {
+        AppendText("  ", 2);
+        return;
+    }
+    digit[sizeof("\033[1;93m 0") - 2] = (char)('0' + value);
+    AppendText(digit, sizeof(digit) - 1);
+}
+
+/**
+ * @brief Writes everything appended so far with a single write and empties the frame.
+ */
+static void FlushFrame(void)
+{
+    fflush(stdout);
+    WriteOutput(g_frame.text, g_frame.length);
+    g_frame.length = 0;
+}
+
+static void AppendBoard(signed char board[][SUDOKU_SIZE], char* name)
+{
+    AppendFormat("\n\033[1;34mSudoku board of: %.*s\033[0m\n\n", FRAME_NAME_LENGTH, name);
+    AppendText("  |", 3);
+    for (size_t i = 0; i < SUDOKU_SIZE; i++)
+    {
+        AppendFormat(" %c%s", (int)('A' + i), (i == 2 || i == 5) ? " |" : "");
+    }
+    AppendText("\n", 1);
+
+    for (size_t x = 0; x < SUDOKU_SIZE; x++)
+    {
+        if (x % 3 == 0)
+        {
+            AppendText("--------------------------\n", 27);
+        }
+        AppendFormat(" %d|", (int)x + 1);
+        for (size_t y = 0; y < SUDOKU_SIZE; y++)
+        {
+            AppendCell(board[x][y]);
+            if (y == 2 || y == 5)
+            {
+                AppendText(" |", 2);
+            }
+        }
+        AppendText("\n", 1);
+    }
+    AppendText("--------------------------\n", 27);
+}
+
+/**
+ * @brief Appends what turns the board on the screen into this one. The first time, and after anything else
+ *  took the screen, that is the whole board from the top of a cleared screen; after that it is the title and
+ *  only the slots that changed, each reached with a cursor address.
+ */
+static void AppendBoardFrame(signed char board[][SUDOKU_SIZE], char* name)
+{
+    if (!g_frame.valid)
+    {
+        AppendText(CLEAR_SCREEN, sizeof(CLEAR_SCREEN) - 1);
+        AppendBoard(board, name);
+        memcpy(g_frame.shown, board, sizeof(g_frame.shown));
+        g_frame.valid = 1;
+        return;
+    }
+
+    // The players take turns, so the title changes on almost every prompt
+    AppendFormat("\033[%d;1H\033[2K\033[1;34mSudoku board of: %.*s\033[0m", FRAME_TITLE_ROW, FRAME_NAME_LENGTH, name);
+    for (int x = 0; x < SUDOKU_SIZE; x++)
+    {
+        for (int y = 0; y < SUDOKU_SIZE; y++)
+        {
+            if (board[x][y] != g_frame.shown[x][y])
+            {
+                AppendFormat("\033[%d;%dH", FRAME_BOARD_ROW + x + x / 3, FRAME_BOARD_COLUMN + 2 * y + 2 * (y / 3));
+                AppendCell(board[x][y]);
+                g_frame.shown[x][y] = board[x][y];
+            }
+        }
+    }
+}
+
+static void AppendEnterValueToBoard(int x, int y)
+{
+    AppendFormat("Please enter value to %c%d, ", 'A' + y, x + 1);
+}
+
+static void AppendPossibleValue(unsigned short possibleValues)
+{
+    AppendText("the value possible is: ", 23);
+    for (short digit = 1; digit <= SUDOKU_SIZE; digit++)
+    {
+        if (possibleValues & (1u << (digit - 1)))
+        {
+            AppendFormat("%hd ", digit);
+        }
+    }
+    AppendText("\n", 1);
+}
 
 void PrintWelcome()
 {
     printf("\n\033[1;36m                                          Welcome to the Sudoku game\033[0m\n");
 }
 
+void PrintGameSeed(unsigned long long seed)
+{
+    printf("\nGame seed: %llu (run with --seed %llu to play the same boards again)\n", seed, seed);
+}
+
 int PrintGetNumOfPlayers()
 {
     int numPlayers;
@@ -67,84 +214,64 @@ void PrintGetPlayersNames(char* name)
     scanf("%s", name);
 }
 
-void PrintGetNumberFromUser(short board[][SUDOKU_SIZE], short* arr, unsigned short size, char* name,  int x, int y)
+short PrintGetNumberFromUser(signed char board[][SUDOKU_SIZE], unsigned short possibleValues, char* name,  int x, int y)
 {
-    PrintBoard(board, name, 1);
-    PrintEnterValueToBoard(x, y);
-    PrintPossibleValue(arr, size);
-    GetNumberToBoard(board, x, y);
+    AppendBoardFrame(board, name);
+    AppendFormat("\033[%d;1H\033[J", FRAME_PROMPT_ROW);
+    AppendEnterValueToBoard(x, y);
+    AppendPossibleValue(possibleValues);
+    FlushFrame();
+    return GetNumberFromUser();
 }
 
-void PrintBoard(short board[][SUDOKU_SIZE], char* name, int isClean)
+void PrintBoard(signed char board[][SUDOKU_SIZE], char* name, int isClean)
 {
-    isClean? system("cls"):"";
-
-    printf("\n\033[1;34mSudoku board of: %s\033[0m\n\n", name);
-    printf("  |");
-    for (size_t i = 0; i < SUDOKU_SIZE; i++)
+    if (isClean)
     {
-
-        printf(" %c%s", 'A'+i, (i==2 || i == 5)?" |":"");
+        AppendBoardFrame(board, name);
     }
-    printf("\n");
-
-    for (size_t x = 0; x < SUDOKU_SIZE; x++)
+    else
     {
-        if (x % 3 == 0)
-        {
-            printf("--------------------------\n");
-        }
-        printf(" %d|", x+1);
-        for (size_t y = 0; y < SUDOKU_SIZE; y++)
-        {
-            if (board[x][y] == -1)
-            {
-                printf("  ");
-            }
-            else
-            {
-                printf("\033[1;93m %hd\033[0m", board[x][y]);
-            }
-            if (y == 2 || y == 5)
-            {
-                printf(" |");
-            }
-        }
-        printf("\n");
-
+        g_frame.valid = 0;
+        AppendBoard(board, name);
     }
-    printf("--------------------------\n");
-
+    FlushFrame();
 }
 
 void PrintEnterValueToBoard(int x, int y)
 {
-    printf("Please enter value to %c%d, ", 'A'+y, x+1);
+    AppendEnterValueToBoard(x, y);
+    FlushFrame();
 }
 
-void PrintPossibleValue(short* arr, unsigned short size)
+void PrintPossibleValue(unsigned short possibleValues)
 {
-    printf("the value possible is: ");
-    for (size_t i = 0; i < size; i++)
-    {
-        printf("%hd ", arr[i]);
-    }
-    printf("\n");
+    AppendPossibleValue(possibleValues);
+    FlushFrame();
 }
 
-void GetNumberToBoard(short board[][SUDOKU_SIZE], int x, int y)
+short GetNumberFromUser()
 {
     short temp = 0;
+    int read = 0;
     while (1)
     {
-        scanf("%hd", &temp);
-        if (temp > 0 && temp < 10)
+        read = scanf("%hd", &temp);
+        if (read == EOF)
+        {
+            return 0;
+        }
+        if (read == 1 && temp > 0 && temp < 10)
         {
-            board[x][y] = temp;
-            break;
+            return temp;
         }
         else
         {
+            // Skip a word that is not a number, it would be read again forever
+            if (read == 0 && scanf("%*s") == EOF)
+            {
+                return 0;
+            }
             PrinrtInvalidNumber();
         }
     }
@@ -152,42 +279,138 @@ void GetNumberToBoard(short board[][SUDOKU_SIZE], int x, int y)
 
 void PrinrtInvalidNumber()
 {
+    // Enough of these scroll the board up, so the next prompt draws it whole again
+    g_frame.valid = 0;
     printf("\033[1;31mInvalid number!! The number should be between 1 and 9. Try again\033[0m\n");
 }
 
-void PrintPlayerLoses(short board[][SUDOKU_SIZE], char* name)
+void PrintPlayerLoses(signed char board[][SUDOKU_SIZE], char* name)
 {
-    system("cls");
-    printf("\n\033[1;31m%s, you lost\033[0m\n", name);
-    PrintBoard(board, name, 0);
-    clock_t start = clock(); // record the start time
-    while (clock() - start < 3 * CLOCKS_PER_SEC) {
-        // busy loop
-    }
+    g_frame.valid = 0;
+    AppendText(CLEAR_SCREEN, sizeof(CLEAR_SCREEN) - 1);
+    AppendFormat("\n\033[1;31m%s, you lost\033[0m\n", name);
+    AppendBoard(board, name);
+    FlushFrame();
+}
 
+void PrintWinnersTitle()
+{
+    g_frame.valid = 0;
+    AppendText(CLEAR_SCREEN, sizeof(CLEAR_SCREEN) - 1);
+    AppendFormat("\n\n ******************************\n");
+    AppendFormat(" ********* WINNERS ***********\n");
+    AppendFormat(" ******************************\n");
+    FlushFrame();
 }
 
-void PrintSudokuWinnersAndBoards(WinningPlayers_t* winners)
+void PrintWinner(size_t place, signed char board[][SUDOKU_SIZE], char* name, unsigned int round, unsigned int moves)
 {
-    WinningPlayers_t* curr;
-    int i = 1;
+    AppendFormat("\n %zu. %s (round %u, %u moves)\n", place, name, round, moves);
+    AppendFormat(" ---------------------------\n");
+    AppendBoard(board, name);
+    FlushFrame();
+}
 
-    system("cls");
-    if (!winners)
-    {
-        return;
-    }
-    printf("\n\n ******************************\n");
-    printf(" ********* WINNERS ***********\n");
-    printf(" ******************************\n");
+void PrintBatchSummary(size_t puzzles, size_t unsolved, size_t malformed, unsigned long long elapsedNs, int numWorkers, size_t steals)
+{
+    double seconds = elapsedNs / 1e9;
 
-    curr = winners;
-    while (curr)
+    fprintf(stderr, "\nSolved %zu of %zu puzzles (%zu without solution) in %.3f seconds, %.0f puzzles/sec\n",
+        puzzles - unsolved, puzzles, unsolved, seconds, seconds > 0 ? puzzles / seconds : 0.0);
+    if (malformed)
     {
-        printf("\n %d. %s\n", i, curr->winner->name);
-        printf(" ---------------------------\n");
-        PrintBoard(curr->winner->board, curr->winner->name, 0);
-        curr = curr->next;
-        i++;
+        fprintf(stderr, "%zu malformed puzzles were skipped, slots were missing\n", malformed);
     }
-}
\ No newline at end of file
+    fprintf(stderr, "%d worker threads, %zu blocks stolen\n", numWorkers, steals);
+}
+
+void PrintBatchScaling(int numWorkers, double puzzlesPerSecond, double speedup, size_t steals)
+{
+    fprintf(stderr, "%3d workers: %12.0f puzzles/sec, speedup %6.2fx, efficiency %5.1f%%, %zu blocks stolen\n",
+        numWorkers, puzzlesPerSecond, speedup, numWorkers ? 100.0 * speedup / numWorkers : 0.0, steals);
+}
+
+void PrintPuzzlePoolSummary(size_t hits, size_t misses, size_t refills, unsigned long long averageRefillNs, unsigned long long maxRefillNs)
+{
+    fprintf(stderr, "\nPuzzle pool: %zu of %zu boards ready (%.0f%% hit rate), %zu refills, average %.1f ms, longest %.1f ms\n",
+        hits, hits + misses, hits + misses ? 100.0 * hits / (hits + misses) : 0.0, refills, averageRefillNs / 1e6, maxRefillNs / 1e6);
+}
+
+void PrintServerListening(const char* address, unsigned long long seed)
+{
+    fprintf(stderr, "Listening on %s, seed %llu\n", address, seed);
+}
+
+void PrintServerSummary(size_t games, size_t wins, unsigned long long moves, size_t peakSessions, size_t rejected,
+    size_t timeouts, unsigned long long averageThinkNs, unsigned long long elapsedNs)
+{
+    double seconds = elapsedNs / 1e9;
+
+    fprintf(stderr, "\nPlayed %zu games (%zu won) and %llu moves in %.3f seconds, %.0f moves/sec\n",
+        games, wins, moves, seconds, seconds > 0 ? moves / seconds : 0.0);
+    fprintf(stderr, "%zu sessions at most at the same time, %zu connections rejected\n", peakSessions, rejected);
+    fprintf(stderr, "Average think time %.1f us, %zu turns ran out of time\n", averageThinkNs / 1e3, timeouts);
+}
+
+void PrintThinkTimeSummary(size_t players, const char* fastest, unsigned long long fastestNs, unsigned long long p50Ns,
+    unsigned long long p90Ns, unsigned long long p99Ns, const char* slowest, unsigned long long slowestNs)
+{
+    fprintf(stderr, "Think time per player over %zu players: fastest %s %.1f us, median %.1f us, p90 %.1f us, p99 %.1f us, slowest %s %.1f us\n",
+        players, fastest[0] ? fastest : "-", fastestNs / 1e3, p50Ns / 1e3, p90Ns / 1e3, p99Ns / 1e3, slowest[0] ? slowest : "-", slowestNs / 1e3);
+}
+
+void PrintLoadSummary(size_t games, size_t wins, size_t failures, unsigned long long moves, size_t clients, unsigned long long averageTurnNs, unsigned long long elapsedNs)
+{
+    double seconds = elapsedNs / 1e9;
+
+    fprintf(stderr, "\n%zu clients played %zu games (%zu won, %zu failed) and %llu moves in %.3f seconds\n",
+        clients, games, wins, failures, moves, seconds);
+    fprintf(stderr, "%.0f games/sec, %.0f moves/sec, average turn %.1f us\n",
+        seconds > 0 ? games / seconds : 0.0, seconds > 0 ? moves / seconds : 0.0, averageTurnNs / 1e3);
+}
+
+void PrintTournamentSummary(size_t players, size_t wins, unsigned int rounds, unsigned long long moves, unsigned long long setupNs, unsigned long long playNs,
+    size_t peakMemory, unsigned long long playAllocations)
+{
+    double seconds = playNs / 1e9;
+
+    fprintf(stderr, "\n%zu bots played %u rounds and %llu moves: %zu won, %zu lost\n",
+        players, rounds, moves, wins, players - wins);
+    fprintf(stderr, "Created in %.3f seconds, ranked and played in %.3f seconds, %.1f rounds/sec, %.0f moves/sec, peak memory %.1f MB\n",
+        setupNs / 1e9, seconds, seconds > 0 ? rounds / seconds : 0.0, seconds > 0 ? moves / seconds : 0.0, peakMemory / (1024.0 * 1024.0));
+    fprintf(stderr, "%llu allocations while the rounds were played\n", playAllocations);
+}
+
+void PrintStandingsTitle(unsigned int round, size_t winners, size_t live, const char* lastWinner, size_t lastRank)
+{
+    fprintf(stderr, "After round %u: %zu won, %zu playing, the last winner %s ranks %zu\n", round, winners, live, lastWinner, lastRank);
+}
+
+void PrintStanding(size_t rank, const char* name, unsigned int round, unsigned int moves)
+{
+    fprintf(stderr, "  %zu. %s (round %u, %u moves)\n", rank, name, round, moves);
+}
+
+void PrintTournamentResumed(unsigned int round)
+{
+    fprintf(stderr, "Resumed after round %u of the checkpoint, the rounds and moves above are those played since\n", round);
+}
+
+void PrintCheckpointSummary(size_t written, size_t dropped, size_t failed, size_t size, unsigned long long copyNs, unsigned long long writeNs)
+{
+    fprintf(stderr, "%zu checkpoints written (%zu dropped, %zu failed), the last one %.1f KB\n",
+        written, dropped, failed, size / 1024.0);
+    fprintf(stderr, "The game waited %.3f ms copying its state, the background thread wrote for %.3f ms\n",
+        copyNs / 1e6, writeNs / 1e6);
+}
+
+void PrintBenchHeader(const char* kernel, unsigned long long seed)
+{
+    fprintf(stderr, "Benchmarks with the %s board kernel, seed %llu\n", kernel, seed);
+    fprintf(stderr, "%-28s %-14s %12s %12s %12s %12s %10s\n", "benchmark", "corpus", "ns/op", "batch p50", "batch p90", "batch p99", "allocs/op");
+}
+
+void PrintBenchResult(const char* name, const char* corpus, double nsPerOp, double p50, double p90, double p99, double allocationsPerOp)
+{
+    fprintf(stderr, "%-28s %-14s %12.1f %12.1f %12.1f %12.1f %10.3f\n", name, corpus, nsPerOp, p50, p90, p99, allocationsPerOp);
+}
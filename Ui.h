@@ -9,8 +9,9 @@
 #ifndef __UI_H__
 #define __UI_H__
 
-#define SUDOKU_SIZE 9
-typedef struct WinningPlayers WinningPlayers_t;
+#include <stddef.h>
+
+#include "Solver.h"
 
 
 
@@ -21,23 +22,161 @@ void PrintWelcome();
 
 int PrintGetNumOfPlayers();
 
+void PrintGameSeed(unsigned long long seed);
+
 void PrintGetPlayersNames(char* name);
 
-void PrintGetNumberFromUser(short board[][SUDOKU_SIZE], short* arr, unsigned short size, char* name, int x, int y);
+/**
+ * @brief Shows a player their board and the options of a slot and reads the digit they choose.
+ *
+ * @return the digit, or 0 if the input ended.
+ */
+short PrintGetNumberFromUser(signed char board[][SUDOKU_SIZE], unsigned short possibleValues, char* name, int x, int y);
 
-void PrintBoard(short board[][SUDOKU_SIZE], char* name, int isClean);
+void PrintBoard(signed char board[][SUDOKU_SIZE], char* name, int isClean);
 
 void PrintEnterValueToBoard(int x, int y);
 
-void PrintPossibleValue(short* arr, unsigned short size);
+void PrintPossibleValue(unsigned short possibleValues);
 
-void GetNumberToBoard(short board[][SUDOKU_SIZE], int x, int y); 
+short GetNumberFromUser();
 
 void PrinrtInvalidNumber();
 
-void PrintPlayerLoses(short board[][SUDOKU_SIZE], char* name);
-
-void PrintSudokuWinnersAndBoards(WinningPlayers_t* winners);
+/**
+ * @brief Shows a player the board they lost on. It returns at once, the caller keeps the screen up as long as it wants.
+ */
+void PrintPlayerLoses(signed char board[][SUDOKU_SIZE], char* name);
+
+void PrintWinnersTitle();
+
+void PrintWinner(size_t place, signed char board[][SUDOKU_SIZE], char* name, unsigned int round, unsigned int moves);
+
+/**
+ * @brief Reports the result of a batch run on the standard error, so it never mixes with solutions written to the standard output.
+ *
+ * @param puzzles: the number of puzzles read.
+ * @param unsolved: the number of puzzles that have no solution.
+ * @param malformed: the puzzles skipped because slots were missing.
+ * @param elapsedNs: the duration of the run in nanoseconds.
+ * @param numWorkers: the number of solver threads.
+ * @param steals: the number of blocks a worker took from another worker's deque.
+ */
+void PrintBatchSummary(size_t puzzles, size_t unsolved, size_t malformed, unsigned long long elapsedNs, int numWorkers, size_t steals);
+
+void PrintBatchScaling(int numWorkers, double puzzlesPerSecond, double speedup, size_t steals);
+
+/**
+ * @brief Prints how well the puzzle pool kept up with the players to the standard error stream.
+ *
+ * @param hits: the players whose board was ready in the pool.
+ * @param misses: the players whose board had to be generated while they waited.
+ * @param refills: the number of completed refills of the pool.
+ * @param averageRefillNs: the average time of a refill.
+ * @param maxRefillNs: the longest refill.
+ */
+void PrintPuzzlePoolSummary(size_t hits, size_t misses, size_t refills, unsigned long long averageRefillNs, unsigned long long maxRefillNs);
+
+void PrintServerListening(const char* address, unsigned long long seed);
+
+/**
+ * @brief Reports the games a server played to the standard error stream.
+ *
+ * @param games: the games that ended.
+ * @param wins: the games the player won.
+ * @param moves: the moves the players made.
+ * @param peakSessions: the most sessions that were open at the same time.
+ * @param rejected: the connections turned away because every session was in use.
+ * @param timeouts: the turns whose move time ran out.
+ * @param averageThinkNs: the average time from a TURN to its move.
+ * @param elapsedNs: how long the server ran.
+ */
+void PrintServerSummary(size_t games, size_t wins, unsigned long long moves, size_t peakSessions, size_t rejected,
+    size_t timeouts, unsigned long long averageThinkNs, unsigned long long elapsedNs);
+
+/**
+ * @brief Reports how the average think time of a move differs from one client of a server to the other.
+ *
+ * @param players: the clients that made a move.
+ * @param fastest: the name of the client with the lowest average think time.
+ * @param fastestNs: its average think time.
+ * @param p50Ns: the median of the average think times of the clients.
+ * @param p90Ns: their 90th percentile.
+ * @param p99Ns: their 99th percentile.
+ * @param slowest: the name of the client with the highest average think time.
+ * @param slowestNs: its average think time.
+ */
+void PrintThinkTimeSummary(size_t players, const char* fastest, unsigned long long fastestNs, unsigned long long p50Ns,
+    unsigned long long p90Ns, unsigned long long p99Ns, const char* slowest, unsigned long long slowestNs);
+
+/**
+ * @brief Reports a load client run to the standard error stream.
+ *
+ * @param games: the games that ended, failed connections included.
+ * @param wins: the games the bots won.
+ * @param failures: the connections that ended without a result.
+ * @param moves: the moves the bots made.
+ * @param clients: the number of concurrent connections.
+ * @param averageTurnNs: the average time from a message to the server's answer.
+ * @param elapsedNs: how long the run took.
+ */
+void PrintLoadSummary(size_t games, size_t wins, size_t failures, unsigned long long moves, size_t clients, unsigned long long averageTurnNs, unsigned long long elapsedNs);
+
+/**
+ * @brief Starts the standings of a tournament after a round.
+ *
+ * @param round: the round just played.
+ * @param winners: the players who won so far.
+ * @param live: the players still playing.
+ * @param lastWinner: the name of the player who won last.
+ * @param lastRank: the rank that player has on the leaderboard.
+ */
+void PrintStandingsTitle(unsigned int round, size_t winners, size_t live, const char* lastWinner, size_t lastRank);
+
+/**
+ * @brief Reports one line of the top of the standings.
+ */
+void PrintStanding(size_t rank, const char* name, unsigned int round, unsigned int moves);
+
+/**
+ * @brief Tells that the rounds and moves of a tournament summary are those played after the checkpoint it was restored from.
+ */
+void PrintTournamentResumed(unsigned int round);
+
+/**
+ * @brief Reports a tournament of bots to the standard error stream.
+ *
+ * @param players: the number of bots.
+ * @param wins: the bots that solved their board.
+ * @param rounds: the rounds the game took.
+ * @param moves: the moves the bots chose.
+ * @param setupNs: how long creating the players took.
+ * @param playNs: how long ranking the players and playing the rounds took.
+ * @param peakMemory: the most memory the process held, in bytes.
+ * @param playAllocations: the allocations the process made while the rounds were played.
+ */
+void PrintTournamentSummary(size_t players, size_t wins, unsigned int rounds, unsigned long long moves, unsigned long long setupNs, unsigned long long playNs,
+    size_t peakMemory, unsigned long long playAllocations);
+
+/**
+ * @brief Reports the checkpoints of a tournament to the standard error stream.
+ *
+ * @param written: the checkpoints written.
+ * @param dropped: the checkpoints replaced by a newer one before they were written.
+ * @param failed: the checkpoints that could not be written.
+ * @param size: the bytes of the last checkpoint.
+ * @param copyNs: how long the game spent copying its state, the only part of the checkpoints it waited for.
+ * @param writeNs: how long the background thread spent writing.
+ */
+void PrintCheckpointSummary(size_t written, size_t dropped, size_t failed, size_t size, unsigned long long copyNs, unsigned long long writeNs);
+
+void PrintBenchHeader(const char* kernel, unsigned long long seed);
+
+/**
+ * @brief Reports one benchmark to the standard error stream, the times are in nanoseconds per call.
+ *  The percentiles are those of the mean time per call of the timed batches.
+ */
+void PrintBenchResult(const char* name, const char* corpus, double nsPerOp, double p50, double p90, double p99, double allocationsPerOp);
 
 
 